@@ -0,0 +1,224 @@
+// Runs the simulation headless over a range of world sizes and prints the results as JSON.
+//
+//   ad_bench [--ticks N] [--threads N] [--seed N] [--scenario NAME]... [--assets PATH]
+//
+// Without `--scenario`, every scenario is run. `--assets` also times loading the startup models
+// from PATH, with and without the mesh cache.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "ad/jobs/job_system.h"
+#include "scenario.h"
+#include "startup_assets.h"
+
+namespace ad {
+
+namespace {
+
+struct Options {
+  U32 ticks = 100;
+  U32 threads = 0;
+  U64 seed = Random::kDefaultSeed;
+  nu::DynamicArray<const char*> scenarios;
+  const char* assets_path = nullptr;
+};
+
+struct Result {
+  Scenario scenario;
+  MemSize entity_count;
+  U32 ticks;
+  F64 seconds;
+  F64 critical_path_ms;
+  nu::DynamicArray<F64> placement_ns;
+};
+
+// Runs of the startup asset loads to average over.
+constexpr U32 kAssetRepeats = 20;
+
+// Ticks at the rate `WorldLayer` runs the simulation at.
+constexpr F32 kTickDelta = 1000.0f / 60.0f;
+
+F64 percentile(nu::DynamicArray<F64>* values, F64 fraction) {
+  if (values->isEmpty()) {
+    return 0.0;
+  }
+
+  std::sort(values->begin(), values->end());
+  auto index = static_cast<MemSize>(fraction * static_cast<F64>(values->size() - 1));
+  return (*values)[index];
+}
+
+Result run(const Scenario& scenario, const Options& options, JobSystem* job_system) {
+  Prefabs prefabs{nullptr};
+  setup_headless_prefabs(&prefabs);
+
+  World world;
+  world.set_seed(options.seed);
+  world.set_job_system(job_system);
+
+  Result result{scenario, 0, options.ticks, 0.0, 0.0, {}};
+  populate_scenario(&world, &prefabs, scenario, &result.placement_ns);
+  result.entity_count = world.entities().size();
+
+  F64 critical_path_ms = 0.0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (U32 tick = 0; tick < options.ticks; ++tick) {
+    world.tick(kTickDelta);
+    critical_path_ms += world.systems().critical_path_ms();
+  }
+  std::chrono::duration<F64> elapsed = std::chrono::steady_clock::now() - start;
+
+  result.seconds = elapsed.count();
+  result.critical_path_ms = critical_path_ms / static_cast<F64>(options.ticks);
+
+  return result;
+}
+
+void print_startup_assets(const StartupAssetTimes& times) {
+  std::printf("  \"startup_assets\": {\n");
+  std::printf("    \"models\": %u,\n", times.models);
+  std::printf("    \"vertices\": %u,\n", times.vertices);
+  std::printf("    \"indices\": %u,\n", times.indices);
+  std::printf("    \"parse_ms\": %.4f,\n", times.parse_ms);
+  std::printf("    \"convert_ms\": %.4f,\n", times.convert_ms);
+  std::printf("    \"mapped_ms\": %.4f,\n", times.mapped_ms);
+  std::printf("    \"miss_ratio_before\": %.3f,\n", times.miss_ratio_before);
+  std::printf("    \"miss_ratio_after\": %.3f\n", times.miss_ratio_after);
+  std::printf("  },\n");
+}
+
+void print_result(Result* result, bool last) {
+  auto ticks = static_cast<F64>(result->ticks);
+  auto ticks_per_second = ticks / result->seconds;
+  auto ns_per_entity =
+      result->seconds * 1e9 / ticks / static_cast<F64>(std::max<MemSize>(result->entity_count, 1));
+
+  F64 placement_mean = 0.0;
+  for (auto ns : result->placement_ns) {
+    placement_mean += ns;
+  }
+  if (!result->placement_ns.isEmpty()) {
+    placement_mean /= static_cast<F64>(result->placement_ns.size());
+  }
+
+  const auto& scenario = result->scenario;
+  std::printf("    {\n");
+  std::printf("      \"name\": \"%s\",\n", scenario.name);
+  std::printf("      \"entities\": %zu,\n", static_cast<size_t>(result->entity_count));
+  std::printf("      \"asteroids\": %u,\n", scenario.asteroids);
+  std::printf("      \"miners\": %u,\n", scenario.miners);
+  std::printf("      \"hubs\": %u,\n", scenario.hubs);
+  std::printf("      \"fighters\": %u,\n", scenario.fighters);
+  std::printf("      \"ticks\": %u,\n", result->ticks);
+  std::printf("      \"ticks_per_second\": %.3f,\n", ticks_per_second);
+  std::printf("      \"ns_per_entity\": %.3f,\n", ns_per_entity);
+  std::printf("      \"critical_path_ms\": %.6f,\n", result->critical_path_ms);
+  std::printf("      \"placement_ns\": {\n");
+  std::printf("        \"count\": %zu,\n", static_cast<size_t>(result->placement_ns.size()));
+  std::printf("        \"mean\": %.1f,\n", placement_mean);
+  std::printf("        \"p50\": %.1f,\n", percentile(&result->placement_ns, 0.5));
+  std::printf("        \"p99\": %.1f,\n", percentile(&result->placement_ns, 0.99));
+  std::printf("        \"max\": %.1f\n", percentile(&result->placement_ns, 1.0));
+  std::printf("      }\n");
+  std::printf("    }%s\n", last ? "" : ",");
+}
+
+bool parse_options(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    auto has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--ticks") == 0 && has_value) {
+      options->ticks = static_cast<U32>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+      options->threads = static_cast<U32>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+      options->seed = std::strtoull(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--scenario") == 0 && has_value) {
+      options->scenarios.emplaceBack(argv[++i]);
+    } else if (std::strcmp(argv[i], "--assets") == 0 && has_value) {
+      options->assets_path = argv[++i];
+    } else {
+      std::fprintf(stderr,
+                   "usage: %s [--ticks N] [--threads N] [--seed N] [--scenario NAME]... "
+                   "[--assets PATH]\n",
+                   argv[0]);
+      return false;
+    }
+  }
+
+  return options->ticks > 0;
+}
+
+bool is_selected(const Options& options, const Scenario& scenario) {
+  if (options.scenarios.isEmpty()) {
+    return true;
+  }
+
+  for (auto name : options.scenarios) {
+    if (std::strcmp(name, scenario.name) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
+
+}  // namespace ad
+
+int main(int argc, char** argv) {
+  using namespace ad;
+
+  Options options;
+  if (!parse_options(argc, argv, &options)) {
+    return 1;
+  }
+
+  const Scenario scenarios[] = {
+      Scenario::with_entity_count("1k", 1'000),
+      Scenario::with_entity_count("10k", 10'000),
+      Scenario::with_entity_count("100k", 100'000),
+      Scenario::with_entity_count("1m", 1'000'000),
+  };
+
+  // `--threads 1` runs everything on the calling thread.
+  auto thread_count =
+      options.threads > 0 ? options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+  JobSystem job_system{thread_count - 1};
+
+  StartupAssetTimes asset_times;
+  if (options.assets_path &&
+      !measure_startup_assets(options.assets_path, kAssetRepeats, &asset_times)) {
+    std::fprintf(stderr, "could not load the startup models from %s\n", options.assets_path);
+    return 1;
+  }
+
+  nu::DynamicArray<Result> results;
+  for (const auto& scenario : scenarios) {
+    if (is_selected(options, scenario)) {
+      results.emplaceBack(run(scenario, options, &job_system));
+    }
+  }
+
+  std::printf("{\n");
+  std::printf("  \"seed\": %llu,\n", static_cast<unsigned long long>(options.seed));
+  std::printf("  \"threads\": %u,\n", job_system.thread_count());
+  std::printf("  \"tick_delta\": %.6f,\n", kTickDelta);
+  if (options.assets_path) {
+    print_startup_assets(asset_times);
+  }
+  std::printf("  \"scenarios\": [\n");
+  for (MemSize i = 0; i < results.size(); ++i) {
+    print_result(&results[i], i + 1 == results.size());
+  }
+  std::printf("  ]\n");
+  std::printf("}\n");
+
+  return 0;
+}
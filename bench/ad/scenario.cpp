@@ -0,0 +1,108 @@
+#include "scenario.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace ad {
+
+namespace {
+
+// Average area per entity, in world units squared.
+constexpr F32 kAreaPerEntity = 25.0f;
+
+}  // namespace
+
+Scenario Scenario::with_entity_count(const char* name, U32 entity_count) {
+  auto asteroids = entity_count * 6 / 10;
+  auto miners = entity_count / 20;
+  auto hubs = entity_count / 20;
+  auto fighters = entity_count - asteroids - miners - hubs;
+
+  return {name, asteroids, miners, hubs, fighters};
+}
+
+void setup_headless_prefabs(Prefabs* prefabs) {
+  prefabs->set(EntityType::CommandCenter, [](le::ResourceManager*, Entity* storage) {
+    storage->flags = ENTITY_FLAG_LINKABLE;
+    storage->electricity.electricity_delta = 100;
+    storage->building.selection_radius = 2.5f;
+    return true;
+  });
+
+  prefabs->set(EntityType::Miner, [](le::ResourceManager*, Entity* storage) {
+    storage->flags = ENTITY_FLAG_NEEDS_LINK;
+    storage->electricity.electricity_delta = -5;
+    storage->building.selection_radius = 1.5f;
+    storage->mining.cycle_duration = 100.0f;
+    storage->mining.mineral_amount_per_cycle = 10;
+    return true;
+  });
+
+  prefabs->set(EntityType::Turret, [](le::ResourceManager*, Entity* storage) {
+    storage->flags = ENTITY_FLAG_NEEDS_LINK;
+    storage->electricity.electricity_delta = -5;
+    storage->building.selection_radius = 1.5f;
+    return true;
+  });
+
+  prefabs->set(EntityType::Hub, [](le::ResourceManager*, Entity* storage) {
+    storage->flags = ENTITY_FLAG_NEEDS_LINK | ENTITY_FLAG_LINKABLE;
+    storage->electricity.electricity_delta = -1;
+    storage->building.selection_radius = 1.5f;
+    return true;
+  });
+
+  prefabs->set(EntityType::Asteroid, [](le::ResourceManager*, Entity* storage) {
+    storage->flags = ENTITY_FLAG_MINABLE;
+    storage->building.selection_radius = 1.7f;
+    return true;
+  });
+
+  prefabs->set(EntityType::EnemyFighter, [](le::ResourceManager*, Entity* storage) {
+    storage->movement.speed = 50.0f;
+    return true;
+  });
+}
+
+void populate_scenario(World* world, Prefabs* prefabs, const Scenario& scenario,
+                       nu::DynamicArray<F64>* placement_ns) {
+  world->clear();
+
+  auto half_extent =
+      std::sqrt(static_cast<F32>(scenario.entity_count()) * kAreaPerEntity) * 0.5f;
+  auto random = world->random().stream(Random::kPopulateStream);
+  auto random_position = [&]() {
+    return fl::Vec2{(random.next_float() * 2.0f - 1.0f) * half_extent,
+                    (random.next_float() * 2.0f - 1.0f) * half_extent};
+  };
+
+  auto add = [&](EntityType type, U32 count) {
+    auto* prefab = prefabs->get(type);
+    for (U32 i = 0; i < count; ++i) {
+      world->add_entity_from_prefab(prefab, random_position());
+    }
+  };
+
+  // Buildings are placed like the player would: one at a time, each looking for something to
+  // link to and mine from. That is the latency worth measuring.
+  auto place = [&](EntityType type, U32 count) {
+    auto* prefab = prefabs->get(type);
+    for (U32 i = 0; i < count; ++i) {
+      auto position = random_position();
+
+      auto start = std::chrono::steady_clock::now();
+      world->add_entity_from_prefab(prefab, position);
+      std::chrono::duration<F64, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+      placement_ns->emplaceBack(elapsed.count());
+    }
+  };
+
+  world->add_entity_from_prefab(prefabs->get(EntityType::CommandCenter), fl::Vec2::zero);
+  add(EntityType::Asteroid, scenario.asteroids);
+  add(EntityType::EnemyFighter, scenario.fighters);
+  place(EntityType::Hub, scenario.hubs);
+  place(EntityType::Miner, scenario.miners);
+}
+
+}  // namespace ad
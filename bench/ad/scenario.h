@@ -0,0 +1,35 @@
+#pragma once
+
+#include <nucleus/containers/dynamic_array.h>
+
+#include "ad/world/prefabs.h"
+#include "ad/world/world.h"
+
+namespace ad {
+
+// How many of each entity a benchmark world is populated with.
+struct Scenario {
+  const char* name;
+  U32 asteroids;
+  U32 miners;
+  U32 hubs;
+  U32 fighters;
+
+  NU_NO_DISCARD U32 entity_count() const {
+    return 1 + asteroids + miners + hubs + fighters;
+  }
+
+  // A world with roughly `entity_count` entities, mostly asteroids and fighters, like a late game.
+  static Scenario with_entity_count(const char* name, U32 entity_count);
+};
+
+// Sets up every prefab without models, so the world can run without a `ResourceManager` or a GPU.
+void setup_headless_prefabs(Prefabs* prefabs);
+
+// Spreads the scenario's entities over an area that grows with the entity count, so density, and
+// with it the cost of spatial queries, stays the same across sizes. The time each building took to
+// place is written into `placement_ns`.
+void populate_scenario(World* world, Prefabs* prefabs, const Scenario& scenario,
+                       nu::DynamicArray<F64>* placement_ns);
+
+}  // namespace ad
@@ -0,0 +1,98 @@
+#include "startup_assets.h"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "ad/assets/mesh_cache.h"
+
+namespace ad {
+
+namespace {
+
+// What `WorldLayer` and `World` load before the first frame.
+constexpr const char* kStartupModels[] = {
+    "command_center.obj", "miner.obj", "turret.obj", "hub.obj", "asteroid.obj", "enemy.obj",
+    "link.obj", "miner_laser.obj", "cursor.obj", "selection_ring_16.obj", "selection_ring_32.obj",
+    "selection_ring_64.obj"};
+
+bool read_file(const std::filesystem::path& path, std::string* content) {
+  std::ifstream in{path, std::ios::binary};
+  if (!in) {
+    return false;
+  }
+  content->assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+  return true;
+}
+
+template <typename Func>
+F64 time_ms(Func&& func) {
+  auto start = std::chrono::steady_clock::now();
+  func();
+  std::chrono::duration<F64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+}  // namespace
+
+bool measure_startup_assets(const std::filesystem::path& assets_path, U32 repeats,
+                            StartupAssetTimes* times) {
+  auto cache_path = std::filesystem::temp_directory_path() / "ad_bench_mesh_cache";
+  bool ok = true;
+
+  *times = {};
+  times->models = static_cast<U32>(std::size(kStartupModels));
+
+  for (auto name : kStartupModels) {
+    std::string source;
+    MeshData mesh;
+    if (!read_file(assets_path / name, &source) || !parse_obj(source, &mesh)) {
+      return false;
+    }
+    auto vertex_count = static_cast<U32>(mesh.vertices.size());
+    times->vertices += vertex_count;
+    times->indices += static_cast<U32>(mesh.indices.size());
+    times->miss_ratio_before +=
+        average_cache_miss_ratio(mesh.indices.data(), mesh.indices.size(), vertex_count);
+    optimize_vertex_cache(&mesh);
+    times->miss_ratio_after +=
+        average_cache_miss_ratio(mesh.indices.data(), mesh.indices.size(), vertex_count);
+  }
+  times->miss_ratio_before /= static_cast<F64>(times->models);
+  times->miss_ratio_after /= static_cast<F64>(times->models);
+
+  for (U32 repeat = 0; repeat < repeats; ++repeat) {
+    times->parse_ms += time_ms([&] {
+      for (auto name : kStartupModels) {
+        std::string source;
+        MeshData mesh;
+        ok &= read_file(assets_path / name, &source) && parse_obj(source, &mesh);
+      }
+    });
+
+    std::filesystem::remove_all(cache_path);
+    MeshCache cache{assets_path, cache_path};
+    times->convert_ms += time_ms([&] {
+      for (auto name : kStartupModels) {
+        MappedMesh mesh;
+        ok &= cache.load(name, &mesh);
+      }
+    });
+
+    times->mapped_ms += time_ms([&] {
+      for (auto name : kStartupModels) {
+        MappedMesh mesh;
+        ok &= cache.load(name, &mesh);
+      }
+    });
+  }
+  std::filesystem::remove_all(cache_path);
+
+  times->parse_ms /= repeats;
+  times->convert_ms /= repeats;
+  times->mapped_ms /= repeats;
+  return ok;
+}
+
+}  // namespace ad
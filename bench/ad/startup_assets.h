@@ -0,0 +1,30 @@
+#pragma once
+
+#include <nucleus/types.h>
+
+#include <filesystem>
+
+namespace ad {
+
+// How long the models loaded at startup take to get ready, averaged over a number of runs.
+struct StartupAssetTimes {
+  U32 models = 0;
+  U32 vertices = 0;
+  U32 indices = 0;
+  // Reading and parsing the OBJ text, as every launch did before the mesh cache.
+  F64 parse_ms = 0.0;
+  // First launch with the mesh cache: parsing, optimizing and writing the binary copies.
+  F64 convert_ms = 0.0;
+  // Every launch after that: hashing the sources and mapping the binary copies.
+  F64 mapped_ms = 0.0;
+  // Average post-transform cache misses per triangle, before and after optimizing.
+  F64 miss_ratio_before = 0.0;
+  F64 miss_ratio_after = 0.0;
+};
+
+// Loads the startup models from `assets_path` each way `repeats` times. The binary copies go to a
+// temporary directory that is removed afterwards. Returns false if a model fails to load.
+bool measure_startup_assets(const std::filesystem::path& assets_path, U32 repeats,
+                            StartupAssetTimes* times);
+
+}  // namespace ad
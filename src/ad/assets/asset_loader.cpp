@@ -0,0 +1,91 @@
+#include "ad/assets/asset_loader.h"
+
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+#include "ad/jobs/job_system.h"
+
+namespace ad {
+
+AssetLoader::AssetLoader(MeshCache* mesh_cache, UploadFunc&& upload)
+  : mesh_cache_{mesh_cache}, upload_{std::move(upload)} {}
+
+ModelHandle AssetLoader::request(std::string_view name, bool keep_mesh) {
+  // A handful of models are loaded, so a linear search is fine.
+  for (U32 index = 0; index < requests_.size(); ++index) {
+    if (requests_[index].name == name) {
+      requests_[index].keep_mesh |= keep_mesh;
+      return ModelHandle{index};
+    }
+  }
+
+  auto& request = requests_.emplace_back();
+  request.name = name;
+  request.keep_mesh = keep_mesh;
+  return ModelHandle{static_cast<U32>(requests_.size() - 1)};
+}
+
+bool AssetLoader::decode_pending(JobSystem* job_system) {
+  auto start = std::chrono::steady_clock::now();
+
+  // Every model is a job of its own; they differ a lot in size and there are few of them.
+  auto first = decoded_count_;
+  std::atomic<bool> all_decoded = true;
+  parallel_for(job_system, requests_.size() - first, 1, [&](MemSize begin, MemSize end, U32) {
+    for (auto i = first + begin; i < first + end; ++i) {
+      auto& request = requests_[i];
+      if (!mesh_cache_->load(request.name, &request.mesh)) {
+        request.failed = true;
+        all_decoded.store(false, std::memory_order_relaxed);
+      }
+    }
+  });
+  decoded_count_ = requests_.size();
+
+  std::chrono::duration<F64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  decode_ms_ = elapsed.count();
+
+  return all_decoded.load(std::memory_order_relaxed);
+}
+
+bool AssetLoader::upload_pending() {
+  auto start = std::chrono::steady_clock::now();
+
+  bool all_uploaded = true;
+  for (; uploaded_count_ < decoded_count_; ++uploaded_count_) {
+    auto& request = requests_[uploaded_count_];
+    if (!request.failed) {
+      request.model = upload_(request.name, request.mesh);
+      request.failed = !request.model;
+    }
+    all_uploaded &= !request.failed;
+
+    // The renderer has its own copy now.
+    if (!request.keep_mesh) {
+      request.mesh.close();
+    }
+  }
+
+  std::chrono::duration<F64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  upload_ms_ = elapsed.count();
+
+  return all_uploaded;
+}
+
+le::RenderModel* AssetLoader::model(ModelHandle handle) const {
+  if (!handle.is_valid() || handle.index >= requests_.size()) {
+    return nullptr;
+  }
+  return requests_[handle.index].model;
+}
+
+const MappedMesh* AssetLoader::mesh(ModelHandle handle) const {
+  if (!handle.is_valid() || handle.index >= requests_.size()) {
+    return nullptr;
+  }
+  const auto& request = requests_[handle.index];
+  return request.keep_mesh && request.mesh.is_open() ? &request.mesh : nullptr;
+}
+
+}  // namespace ad
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <nucleus/function.h>
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ad/assets/mesh_cache.h"
+
+namespace le {
+class RenderModel;
+}
+
+namespace ad {
+
+class JobSystem;
+
+// A model requested from an `AssetLoader` or added to a `ModelResidency`, valid for as long as
+// the object that handed it out.
+struct ModelHandle {
+  U32 index = std::numeric_limits<U32>::max();
+
+  NU_NO_DISCARD bool is_valid() const {
+    return index != std::numeric_limits<U32>::max();
+  }
+};
+
+// Loads models in two steps: every requested mesh is read and decoded at once, spread over a job
+// system, and only then are they uploaded one by one on the thread that owns the renderer.
+class AssetLoader {
+  NU_DELETE_COPY_AND_MOVE(AssetLoader);
+
+public:
+  // Turns a decoded mesh into a model the renderer can draw. Only called from `upload_pending`.
+  using UploadFunc = nu::Function<le::RenderModel*(std::string_view name, const MappedMesh& mesh)>;
+
+  AssetLoader(MeshCache* mesh_cache, UploadFunc&& upload);
+
+  // Queues `name` for loading. Requesting a name again returns the handle it already has. With
+  // `keep_mesh`, the decoded mesh stays mapped after the upload, for callers that build geometry of
+  // their own from it.
+  ModelHandle request(std::string_view name, bool keep_mesh = false);
+
+  // Decodes every model requested since the last call, spread over `job_system` (which may be
+  // null). Returns false if any of them could not be decoded.
+  bool decode_pending(JobSystem* job_system);
+
+  // Uploads every decoded model on the calling thread. Returns false if any upload failed.
+  bool upload_pending();
+
+  // Null until the model is uploaded, or if it failed to load.
+  NU_NO_DISCARD le::RenderModel* model(ModelHandle handle) const;
+
+  // The decoded mesh of a model requested with `keep_mesh`, null for any other.
+  NU_NO_DISCARD const MappedMesh* mesh(ModelHandle handle) const;
+
+  // Time spent in the last call to each step.
+  NU_NO_DISCARD F64 decode_ms() const {
+    return decode_ms_;
+  }
+
+  NU_NO_DISCARD F64 upload_ms() const {
+    return upload_ms_;
+  }
+
+private:
+  struct Request {
+    std::string name;
+    MappedMesh mesh;
+    le::RenderModel* model = nullptr;
+    bool keep_mesh = false;
+    bool failed = false;
+  };
+
+  MeshCache* mesh_cache_;
+  UploadFunc upload_;
+
+  // Requests keep a move-only mapping, so they live in a `std::vector`.
+  std::vector<Request> requests_;
+  MemSize decoded_count_ = 0;
+  MemSize uploaded_count_ = 0;
+
+  F64 decode_ms_ = 0.0;
+  F64 upload_ms_ = 0.0;
+};
+
+}  // namespace ad
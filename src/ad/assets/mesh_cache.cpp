@@ -0,0 +1,715 @@
+#include "ad/assets/mesh_cache.h"
+
+#include <nucleus/containers/hash_map.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
+
+#if OS(WIN)
+#include <nucleus/win/includes.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ad {
+
+namespace {
+
+// "ADMS" when read as bytes.
+constexpr U32 kCacheMagic = 0x534d4441;
+// Bump when the layout of the file or of `MeshVertex` changes.
+constexpr U32 kCacheVersion = 2;
+
+// Followed by the materials, the vertices and the indices.
+struct CacheHeader {
+  U32 magic;
+  U32 version;
+  MeshSource source;
+  U32 vertex_count;
+  U32 index_count;
+  U32 material_count;
+  char material_library[kMaxMaterialNameLength + 1];
+};
+
+// Vertex attributes are packed into one 63 bit key for deduplication.
+constexpr U32 kAttributeBits = 21;
+constexpr I32 kMaxAttributes = (1 << kAttributeBits) - 1;
+
+struct VertexKey {
+  U64 packed;
+
+  bool operator==(const VertexKey& other) const {
+    return packed == other.packed;
+  }
+};
+
+}  // namespace
+
+}  // namespace ad
+
+template <>
+struct nu::Hash<ad::VertexKey> {
+  static HashedValue hashed(const ad::VertexKey& key) {
+    return hash_dword(static_cast<U32>(key.packed)) ^
+           hash_dword(static_cast<U32>(key.packed >> 32));
+  }
+};
+
+namespace ad {
+
+namespace {
+
+// -- OBJ parsing ---------------------------------------------------------------------------------
+
+void skip_spaces(std::string_view* text) {
+  auto end = text->find_first_not_of(" \t");
+  text->remove_prefix(end == std::string_view::npos ? text->size() : end);
+}
+
+bool parse_float(std::string_view* text, F32* value) {
+  skip_spaces(text);
+  auto result = std::from_chars(text->data(), text->data() + text->size(), *value);
+  if (result.ec != std::errc{}) {
+    return false;
+  }
+  text->remove_prefix(static_cast<MemSize>(result.ptr - text->data()));
+  return true;
+}
+
+// Copies the rest of the line, without trailing spaces, into `name`. False if it does not fit.
+bool parse_name(std::string_view text, char (&name)[kMaxMaterialNameLength + 1]) {
+  skip_spaces(&text);
+  auto end = text.find_last_not_of(" \t");
+  text = text.substr(0, end == std::string_view::npos ? 0 : end + 1);
+  if (text.size() > kMaxMaterialNameLength) {
+    return false;
+  }
+  std::fill(std::begin(name), std::end(name), '\0');
+  std::copy(text.begin(), text.end(), name);
+  return true;
+}
+
+// Turns a 1-based, or negative and relative to the end, OBJ index into a 0-based one.
+bool parse_index(std::string_view* text, MemSize count, I32* index) {
+  I32 value = 0;
+  auto result = std::from_chars(text->data(), text->data() + text->size(), value);
+  if (result.ec != std::errc{} || value == 0) {
+    return false;
+  }
+  text->remove_prefix(static_cast<MemSize>(result.ptr - text->data()));
+
+  auto resolved = value > 0 ? value - 1 : static_cast<I32>(count) + value;
+  if (resolved < 0 || static_cast<MemSize>(resolved) >= count) {
+    return false;
+  }
+  *index = resolved;
+  return true;
+}
+
+// -- Vertex cache optimization ------------------------------------------------------------------
+
+// Size of the modelled cache. Real caches vary, but the order is not very sensitive to it.
+constexpr U32 kModelledCacheSize = 32;
+
+// How much a vertex is worth to the triangles that use it, for its position in the cache and the
+// number of triangles that still need it. Vertices of the last triangle get a fixed score so that
+// strips don't always turn the same way, and vertices with few triangles left get a boost so they
+// are finished off instead of being left behind.
+F32 vertex_score(I32 cache_position, U32 remaining_triangles) {
+  if (remaining_triangles == 0) {
+    return -1.0f;
+  }
+
+  F32 score = 0.0f;
+  if (cache_position >= 0) {
+    if (cache_position < 3) {
+      score = 0.75f;
+    } else {
+      auto decay = 1.0f - static_cast<F32>(cache_position - 3) /
+                              static_cast<F32>(kModelledCacheSize - 3);
+      score = std::pow(decay, 1.5f);
+    }
+  }
+
+  return score + 2.0f / std::sqrt(static_cast<F32>(remaining_triangles));
+}
+
+// Appends the triangles in `indices` to `output` in the order that reuses the most cached
+// vertices.
+void order_triangles(const U32* indices, U32 triangle_count, U32 vertex_count,
+                     nu::DynamicArray<U32>* output) {
+  if (triangle_count == 0) {
+    return;
+  }
+  auto index_count = triangle_count * 3;
+
+  // The triangles that use each vertex, as ranges into `adjacency`. Emitted triangles are swapped
+  // to the back of their vertex's range, so the first `remaining[v]` are the ones still to go.
+  nu::DynamicArray<U32> remaining;
+  remaining.resize(vertex_count, 0);
+  for (U32 i = 0; i < index_count; ++i) {
+    ++remaining[indices[i]];
+  }
+
+  nu::DynamicArray<U32> adjacency_offsets;
+  adjacency_offsets.resize(vertex_count + 1, 0);
+  for (U32 v = 0; v < vertex_count; ++v) {
+    adjacency_offsets[v + 1] = adjacency_offsets[v] + remaining[v];
+  }
+
+  nu::DynamicArray<U32> adjacency;
+  adjacency.resize(index_count, 0);
+  {
+    nu::DynamicArray<U32> filled;
+    filled.resize(vertex_count, 0);
+    for (U32 t = 0; t < triangle_count; ++t) {
+      for (U32 corner = 0; corner < 3; ++corner) {
+        auto v = indices[t * 3 + corner];
+        adjacency[adjacency_offsets[v] + filled[v]++] = t;
+      }
+    }
+  }
+
+  nu::DynamicArray<I32> cache_position;
+  cache_position.resize(vertex_count, -1);
+  nu::DynamicArray<F32> vertex_scores;
+  vertex_scores.resize(vertex_count, 0.0f);
+  for (U32 v = 0; v < vertex_count; ++v) {
+    vertex_scores[v] = vertex_score(-1, remaining[v]);
+  }
+
+  nu::DynamicArray<F32> triangle_scores;
+  triangle_scores.resize(triangle_count, 0.0f);
+  nu::DynamicArray<U8> emitted;
+  emitted.resize(triangle_count, U8{0});
+  for (U32 t = 0; t < triangle_count; ++t) {
+    for (U32 corner = 0; corner < 3; ++corner) {
+      triangle_scores[t] += vertex_scores[indices[t * 3 + corner]];
+    }
+  }
+
+  // The modelled cache, with room for the three vertices pushed in by each new triangle.
+  U32 cache[kModelledCacheSize + 3];
+  U32 cache_size = 0;
+
+  auto best_triangle =
+      static_cast<U32>(std::max_element(triangle_scores.begin(), triangle_scores.end()) -
+                       triangle_scores.begin());
+  U32 next_unemitted = 0;
+
+  for (U32 emitted_count = 0; emitted_count < triangle_count; ++emitted_count) {
+    // When no cached vertex has triangles left, carry on from the first triangle not emitted yet.
+    if (best_triangle == triangle_count) {
+      while (emitted[next_unemitted]) {
+        ++next_unemitted;
+      }
+      best_triangle = next_unemitted;
+    }
+
+    auto triangle = best_triangle;
+    emitted[triangle] = 1;
+
+    U32 new_cache[kModelledCacheSize + 3];
+    U32 new_cache_size = 0;
+    for (U32 corner = 0; corner < 3; ++corner) {
+      auto v = indices[triangle * 3 + corner];
+      output->emplaceBack(v);
+      new_cache[new_cache_size++] = v;
+
+      // Take the triangle out of the vertex's remaining ones.
+      auto* begin = adjacency.data() + adjacency_offsets[v];
+      auto* last = begin + remaining[v] - 1;
+      std::swap(*std::find(begin, last + 1, triangle), *last);
+      --remaining[v];
+    }
+
+    for (U32 i = 0; i < cache_size; ++i) {
+      auto v = cache[i];
+      if (v != new_cache[0] && v != new_cache[1] && v != new_cache[2]) {
+        new_cache[new_cache_size++] = v;
+      }
+    }
+
+    // Vertices pushed out of the cache lose their cache score.
+    for (U32 i = kModelledCacheSize; i < new_cache_size; ++i) {
+      auto v = new_cache[i];
+      cache_position[v] = -1;
+      vertex_scores[v] = vertex_score(-1, remaining[v]);
+    }
+
+    cache_size = std::min(new_cache_size, kModelledCacheSize);
+    std::copy(new_cache, new_cache + cache_size, cache);
+
+    for (U32 i = 0; i < cache_size; ++i) {
+      auto v = cache[i];
+      cache_position[v] = static_cast<I32>(i);
+      vertex_scores[v] = vertex_score(cache_position[v], remaining[v]);
+    }
+
+    // Only the triangles of cached vertices changed score, so the next one comes from them.
+    best_triangle = triangle_count;
+    F32 best_score = -1.0f;
+    for (U32 i = 0; i < cache_size; ++i) {
+      auto v = cache[i];
+      for (U32 j = 0; j < remaining[v]; ++j) {
+        auto t = adjacency[adjacency_offsets[v] + j];
+        auto score = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] +
+                     vertex_scores[indices[t * 3 + 2]];
+        triangle_scores[t] = score;
+        if (score > best_score) {
+          best_score = score;
+          best_triangle = t;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+bool parse_obj(std::string_view source, MeshData* mesh) {
+  mesh->vertices.clear();
+  mesh->indices.clear();
+  mesh->material_library.clear();
+  mesh->materials.clear();
+
+  // Faces before the first `usemtl` go in a range without a name.
+  mesh->materials.emplaceBack();
+
+  nu::DynamicArray<fl::Vec3> positions;
+  nu::DynamicArray<fl::Vec2> tex_coords;
+  nu::DynamicArray<fl::Vec3> normals;
+  nu::HashMap<VertexKey, U32> vertex_for_key;
+  nu::DynamicArray<U32> polygon;
+
+  while (!source.empty()) {
+    auto line_end = source.find('\n');
+    auto line = source.substr(0, line_end);
+    source.remove_prefix(line_end == std::string_view::npos ? source.size() : line_end + 1);
+
+    skip_spaces(&line);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+
+    if (line.starts_with("mtllib ")) {
+      char library[kMaxMaterialNameLength + 1];
+      if (!parse_name(line.substr(7), library)) {
+        return false;
+      }
+      if (mesh->material_library.empty()) {
+        mesh->material_library = library;
+      }
+    } else if (line.starts_with("usemtl ")) {
+      auto* current = &mesh->materials[mesh->materials.size() - 1];
+      current->index_count = static_cast<U32>(mesh->indices.size()) - current->first_index;
+      if (current->index_count > 0) {
+        mesh->materials.emplaceBack();
+        current = &mesh->materials[mesh->materials.size() - 1];
+        current->first_index = static_cast<U32>(mesh->indices.size());
+      }
+      if (!parse_name(line.substr(7), current->name)) {
+        return false;
+      }
+    } else if (line.starts_with("v ")) {
+      line.remove_prefix(2);
+      fl::Vec3 position;
+      if (!parse_float(&line, &position.x) || !parse_float(&line, &position.y) ||
+          !parse_float(&line, &position.z)) {
+        return false;
+      }
+      positions.emplaceBack(position);
+    } else if (line.starts_with("vt ")) {
+      line.remove_prefix(3);
+      fl::Vec2 tex_coord;
+      if (!parse_float(&line, &tex_coord.x) || !parse_float(&line, &tex_coord.y)) {
+        return false;
+      }
+      tex_coords.emplaceBack(tex_coord);
+    } else if (line.starts_with("vn ")) {
+      line.remove_prefix(3);
+      fl::Vec3 normal;
+      if (!parse_float(&line, &normal.x) || !parse_float(&line, &normal.y) ||
+          !parse_float(&line, &normal.z)) {
+        return false;
+      }
+      normals.emplaceBack(normal);
+    } else if (line.starts_with("f ")) {
+      line.remove_prefix(2);
+      polygon.clear();
+
+      for (skip_spaces(&line); !line.empty(); skip_spaces(&line)) {
+        // "p", "p/t", "p//n" or "p/t/n".
+        I32 position = 0;
+        I32 tex_coord = -1;
+        I32 normal = -1;
+        if (!parse_index(&line, positions.size(), &position)) {
+          return false;
+        }
+        if (line.starts_with('/')) {
+          line.remove_prefix(1);
+          if (!line.starts_with('/') && !parse_index(&line, tex_coords.size(), &tex_coord)) {
+            return false;
+          }
+          if (line.starts_with('/')) {
+            line.remove_prefix(1);
+            if (!parse_index(&line, normals.size(), &normal)) {
+              return false;
+            }
+          }
+        }
+
+        if (position >= kMaxAttributes || tex_coord >= kMaxAttributes ||
+            normal >= kMaxAttributes) {
+          return false;
+        }
+
+        VertexKey key{static_cast<U64>(position) |
+                      static_cast<U64>(tex_coord + 1) << kAttributeBits |
+                      static_cast<U64>(normal + 1) << (2 * kAttributeBits)};
+        auto found = vertex_for_key.find(key);
+        if (found.was_found()) {
+          polygon.emplaceBack(found.value());
+          continue;
+        }
+
+        MeshVertex vertex;
+        vertex.position = positions[position];
+        vertex.tex_coord = tex_coord >= 0 ? tex_coords[tex_coord] : fl::Vec2{0.0f, 0.0f};
+        vertex.normal = normal >= 0 ? normals[normal] : fl::Vec3{0.0f, 0.0f, 0.0f};
+        auto index = static_cast<U32>(mesh->vertices.size());
+        mesh->vertices.emplaceBack(vertex);
+        vertex_for_key.insert(key, index);
+        polygon.emplaceBack(index);
+      }
+
+      if (polygon.size() < 3) {
+        return false;
+      }
+      for (MemSize i = 1; i + 1 < polygon.size(); ++i) {
+        mesh->indices.emplaceBack(polygon[0]);
+        mesh->indices.emplaceBack(polygon[i]);
+        mesh->indices.emplaceBack(polygon[i + 1]);
+      }
+    }
+  }
+
+  // A material picked after the last face has nothing to draw.
+  auto& last = mesh->materials[mesh->materials.size() - 1];
+  last.index_count = static_cast<U32>(mesh->indices.size()) - last.first_index;
+  if (last.index_count == 0 && mesh->materials.size() > 1) {
+    mesh->materials.resize(mesh->materials.size() - 1);
+  }
+
+  // A mesh that never picks a material has none.
+  if (mesh->materials.size() == 1 && mesh->materials[0].name[0] == '\0') {
+    mesh->materials.clear();
+  }
+
+  return true;
+}
+
+void optimize_vertex_cache(MeshData* mesh) {
+  auto vertex_count = static_cast<U32>(mesh->vertices.size());
+  nu::DynamicArray<U32> output;
+  output.reserve(mesh->indices.size());
+
+  // Triangles stay within their material, so every material is still one range of indices.
+  if (mesh->materials.size() == 0) {
+    order_triangles(mesh->indices.data(), static_cast<U32>(mesh->indices.size() / 3),
+                    vertex_count, &output);
+  } else {
+    for (const auto& material : mesh->materials) {
+      order_triangles(mesh->indices.data() + material.first_index, material.index_count / 3,
+                      vertex_count, &output);
+    }
+  }
+
+  // Number vertices in the order they are first used, so fetching them walks memory forwards.
+  constexpr U32 kUnassigned = std::numeric_limits<U32>::max();
+  nu::DynamicArray<U32> remap;
+  remap.resize(vertex_count, kUnassigned);
+  nu::DynamicArray<MeshVertex> vertices;
+  vertices.reserve(vertex_count);
+  for (auto& index : output) {
+    if (remap[index] == kUnassigned) {
+      remap[index] = static_cast<U32>(vertices.size());
+      vertices.emplaceBack(mesh->vertices[index]);
+    }
+    index = remap[index];
+  }
+
+  mesh->vertices = std::move(vertices);
+  mesh->indices = std::move(output);
+}
+
+F32 average_cache_miss_ratio(const U32* indices, MemSize index_count, U32 vertex_count,
+                             U32 cache_size) {
+  if (index_count < 3) {
+    return 0.0f;
+  }
+
+  // When each vertex entered the FIFO, counted in misses.
+  nu::DynamicArray<U64> entered;
+  entered.resize(vertex_count, 0);
+  U64 misses = 0;
+  for (MemSize i = 0; i < index_count; ++i) {
+    auto v = indices[i];
+    if (entered[v] == 0 || misses - entered[v] >= cache_size) {
+      ++misses;
+      entered[v] = misses;
+    }
+  }
+
+  return static_cast<F32>(misses) / static_cast<F32>(index_count / 3);
+}
+
+U64 hash_content(const void* data, MemSize size) {
+  auto* bytes = static_cast<const U8*>(data);
+  U64 hash = 14695981039346656037ull;
+  for (MemSize i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+MappedMesh::MappedMesh(MappedMesh&& other) noexcept {
+  *this = std::move(other);
+}
+
+MappedMesh& MappedMesh::operator=(MappedMesh&& other) noexcept {
+  if (this != &other) {
+    close();
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(source_, other.source_);
+    std::swap(material_library_, other.material_library_);
+    std::swap(materials_, other.materials_);
+    std::swap(vertices_, other.vertices_);
+    std::swap(indices_, other.indices_);
+    std::swap(material_count_, other.material_count_);
+    std::swap(vertex_count_, other.vertex_count_);
+    std::swap(index_count_, other.index_count_);
+  }
+  return *this;
+}
+
+MappedMesh::~MappedMesh() {
+  close();
+}
+
+bool MappedMesh::open(const std::filesystem::path& path) {
+  close();
+
+#if OS(WIN)
+  auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) ||
+      static_cast<MemSize>(file_size.QuadPart) < sizeof(CacheHeader)) {
+    CloseHandle(file);
+    return false;
+  }
+  auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping) {
+    return false;
+  }
+  data_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!data_) {
+    return false;
+  }
+  size_ = static_cast<MemSize>(file_size.QuadPart);
+#else
+  auto file = ::open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return false;
+  }
+  struct stat file_stat = {};
+  if (fstat(file, &file_stat) != 0 ||
+      static_cast<MemSize>(file_stat.st_size) < sizeof(CacheHeader)) {
+    ::close(file);
+    return false;
+  }
+  auto* data = mmap(nullptr, static_cast<MemSize>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file,
+                    0);
+  ::close(file);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  data_ = data;
+  size_ = static_cast<MemSize>(file_stat.st_size);
+#endif
+
+  const auto* header = static_cast<const CacheHeader*>(data_);
+  auto materials_size = static_cast<MemSize>(header->material_count) * sizeof(MeshMaterial);
+  auto vertices_size = static_cast<MemSize>(header->vertex_count) * sizeof(MeshVertex);
+  auto expected_size =
+      sizeof(CacheHeader) + materials_size + vertices_size + header->index_count * sizeof(U32);
+  if (header->magic != kCacheMagic || header->version != kCacheVersion || size_ != expected_size ||
+      header->material_library[kMaxMaterialNameLength] != '\0') {
+    close();
+    return false;
+  }
+
+  auto* bytes = static_cast<const U8*>(data_) + sizeof(CacheHeader);
+  materials_ = reinterpret_cast<const MeshMaterial*>(bytes);
+  vertices_ = reinterpret_cast<const MeshVertex*>(bytes + materials_size);
+  indices_ = reinterpret_cast<const U32*>(bytes + materials_size + vertices_size);
+  source_ = header->source;
+  material_library_ = header->material_library;
+  material_count_ = header->material_count;
+  vertex_count_ = header->vertex_count;
+  index_count_ = header->index_count;
+  return true;
+}
+
+void MappedMesh::close() {
+  if (data_) {
+#if OS(WIN)
+    UnmapViewOfFile(data_);
+#else
+    munmap(data_, size_);
+#endif
+  }
+
+  data_ = nullptr;
+  size_ = 0;
+  source_ = {};
+  material_library_ = {};
+  materials_ = nullptr;
+  vertices_ = nullptr;
+  indices_ = nullptr;
+  material_count_ = 0;
+  vertex_count_ = 0;
+  index_count_ = 0;
+}
+
+void MappedMesh::copy_to(MeshData* mesh) const {
+  mesh->vertices.clear();
+  mesh->indices.clear();
+  mesh->materials.clear();
+  mesh->vertices.reserve(vertex_count_);
+  mesh->indices.reserve(index_count_);
+  for (U32 i = 0; i < vertex_count_; ++i) {
+    mesh->vertices.emplaceBack(vertices_[i]);
+  }
+  for (U32 i = 0; i < index_count_; ++i) {
+    mesh->indices.emplaceBack(indices_[i]);
+  }
+  mesh->material_library = material_library_;
+  for (U32 i = 0; i < material_count_; ++i) {
+    mesh->materials.emplaceBack(materials_[i]);
+  }
+}
+
+bool write_mesh_cache(const std::filesystem::path& path, const MeshSource& source,
+                      const MeshData& mesh) {
+  if (mesh.material_library.size() > kMaxMaterialNameLength) {
+    return false;
+  }
+
+  CacheHeader header = {};
+  header.magic = kCacheMagic;
+  header.version = kCacheVersion;
+  header.source = source;
+  header.vertex_count = static_cast<U32>(mesh.vertices.size());
+  header.index_count = static_cast<U32>(mesh.indices.size());
+  header.material_count = static_cast<U32>(mesh.materials.size());
+  std::copy(mesh.material_library.begin(), mesh.material_library.end(), header.material_library);
+
+  // Written next to the final file and moved over it, so a cut off write never looks valid.
+  auto temp_path = path;
+  temp_path += ".tmp";
+  {
+    std::ofstream out{temp_path, std::ios::binary | std::ios::trunc};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(mesh.materials.data()),
+              static_cast<std::streamsize>(mesh.materials.size() * sizeof(MeshMaterial)));
+    out.write(reinterpret_cast<const char*>(mesh.vertices.data()),
+              static_cast<std::streamsize>(mesh.vertices.size() * sizeof(MeshVertex)));
+    out.write(reinterpret_cast<const char*>(mesh.indices.data()),
+              static_cast<std::streamsize>(mesh.indices.size() * sizeof(U32)));
+    if (!out) {
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temp_path, path, error);
+  return !error;
+}
+
+MeshCache::MeshCache(std::filesystem::path source_directory, std::filesystem::path cache_directory)
+  : source_directory_{std::move(source_directory)}, cache_directory_{std::move(cache_directory)} {}
+
+bool MeshCache::load(std::string_view name, MappedMesh* mesh) {
+  auto source_path = source_directory_ / name;
+  auto cache_path = cache_directory_ / name;
+  cache_path += ".mesh";
+
+  std::error_code error;
+  MeshSource source;
+  source.size = std::filesystem::file_size(source_path, error);
+  if (!error) {
+    auto write_time = std::filesystem::last_write_time(source_path, error);
+    source.write_time = static_cast<I64>(write_time.time_since_epoch().count());
+  }
+  if (error) {
+    LOG(Error) << "Could not open mesh source " << name;
+    return false;
+  }
+
+  bool is_cached = mesh->open(cache_path);
+  if (is_cached && mesh->source().size == source.size &&
+      mesh->source().write_time == source.write_time) {
+    return true;
+  }
+
+  std::ifstream in{source_path, std::ios::binary};
+  std::string content{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+  if (!in && !in.eof()) {
+    LOG(Error) << "Could not read mesh source " << name;
+    return false;
+  }
+  source.hash = hash_content(content.data(), content.size());
+
+  // Touched, but not changed.
+  if (is_cached && mesh->source().hash == source.hash) {
+    return true;
+  }
+
+  MeshData data;
+  if (!parse_obj(content, &data)) {
+    LOG(Error) << "Could not parse mesh source " << name;
+    mesh->close();
+    return false;
+  }
+  optimize_vertex_cache(&data);
+
+  // The old copy has to be unmapped before it can be replaced.
+  mesh->close();
+  std::filesystem::create_directories(cache_directory_, error);
+  if (!write_mesh_cache(cache_path, source, data)) {
+    LOG(Error) << "Could not write mesh cache for " << name;
+    return false;
+  }
+  conversions_.fetch_add(1, std::memory_order_relaxed);
+
+  return mesh->open(cache_path);
+}
+
+}  // namespace ad
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <floats/vec2.h>
+#include <floats/vec3.h>
+#include <nucleus/containers/dynamic_array.h>
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace ad {
+
+// Vertex layout of cached meshes, written to disk as is.
+struct MeshVertex {
+  fl::Vec3 position;
+  fl::Vec3 normal;
+  fl::Vec2 tex_coord;
+};
+
+static_assert(sizeof(MeshVertex) == 8 * sizeof(F32));
+
+// Longest material or material library name a cache file can hold.
+constexpr MemSize kMaxMaterialNameLength = 55;
+
+// The indices drawn with one material, written to disk as is. Only the material's name is kept;
+// the material itself is loaded from the mesh's material library.
+struct MeshMaterial {
+  char name[kMaxMaterialNameLength + 1] = {};
+  U32 first_index = 0;
+  U32 index_count = 0;
+
+  NU_NO_DISCARD std::string_view name_view() const {
+    return name;
+  }
+};
+
+static_assert(sizeof(MeshMaterial) == 64);
+
+// A triangle list with every distinct position/texture coordinate/normal combination stored once.
+// Meshes that name materials have them in `materials`, which cover every index in order.
+struct MeshData {
+  nu::DynamicArray<MeshVertex> vertices;
+  nu::DynamicArray<U32> indices;
+  std::string material_library;
+  nu::DynamicArray<MeshMaterial> materials;
+};
+
+// Reads a Wavefront OBJ file into `mesh`. Polygons are split into fans. The first `mtllib` becomes
+// the material library and every `usemtl` starts a material range. Groups and everything else are
+// ignored. Returns false on malformed faces and on names too long to cache.
+bool parse_obj(std::string_view source, MeshData* mesh);
+
+// Reorders the triangles of each material so that consecutive ones share vertices while they are
+// still in the GPU's post-transform cache (Forsyth, "Linear-Speed Vertex Cache Optimisation"), then
+// renumbers the vertices in the order they are first used.
+void optimize_vertex_cache(MeshData* mesh);
+
+// Vertices transformed per triangle with a FIFO post-transform cache of `cache_size` entries.
+// Between 0.5 for an ideal mesh and 3.0 when nothing is reused.
+NU_NO_DISCARD F32 average_cache_miss_ratio(const U32* indices, MemSize index_count,
+                                           U32 vertex_count, U32 cache_size = 16);
+
+// FNV-1a over `size` bytes.
+NU_NO_DISCARD U64 hash_content(const void* data, MemSize size);
+
+// What a cache file was made from. The content hash decides whether the file is still valid; the
+// size and write time only let a load skip reading the source when neither changed.
+struct MeshSource {
+  U64 hash = 0;
+  U64 size = 0;
+  I64 write_time = 0;
+};
+
+// A cache file mapped into memory. The vertices and indices point straight into the mapping, so
+// loading does no per-vertex work.
+class MappedMesh {
+  NU_DELETE_COPY(MappedMesh);
+
+public:
+  MappedMesh() = default;
+  MappedMesh(MappedMesh&& other) noexcept;
+  MappedMesh& operator=(MappedMesh&& other) noexcept;
+  ~MappedMesh();
+
+  // Maps `path` and checks that it is a complete cache file of the current version.
+  bool open(const std::filesystem::path& path);
+  void close();
+
+  NU_NO_DISCARD bool is_open() const {
+    return data_ != nullptr;
+  }
+
+  NU_NO_DISCARD const MeshSource& source() const {
+    return source_;
+  }
+
+  NU_NO_DISCARD const MeshVertex* vertices() const {
+    return vertices_;
+  }
+
+  NU_NO_DISCARD U32 vertex_count() const {
+    return vertex_count_;
+  }
+
+  NU_NO_DISCARD const U32* indices() const {
+    return indices_;
+  }
+
+  NU_NO_DISCARD U32 index_count() const {
+    return index_count_;
+  }
+
+  // Empty if the mesh names no materials.
+  NU_NO_DISCARD std::string_view material_library() const {
+    return material_library_;
+  }
+
+  NU_NO_DISCARD const MeshMaterial* materials() const {
+    return materials_;
+  }
+
+  NU_NO_DISCARD U32 material_count() const {
+    return material_count_;
+  }
+
+  // Copies the mesh out of the mapping, e.g. to build other geometry from it.
+  void copy_to(MeshData* mesh) const;
+
+private:
+  void* data_ = nullptr;
+  MemSize size_ = 0;
+  MeshSource source_;
+  std::string_view material_library_;
+  const MeshMaterial* materials_ = nullptr;
+  const MeshVertex* vertices_ = nullptr;
+  const U32* indices_ = nullptr;
+  U32 material_count_ = 0;
+  U32 vertex_count_ = 0;
+  U32 index_count_ = 0;
+};
+
+// Writes `mesh` as a cache file made from `source`.
+bool write_mesh_cache(const std::filesystem::path& path, const MeshSource& source,
+                      const MeshData& mesh);
+
+// Binary copies of the OBJ files in `source_directory`, kept in `cache_directory`. A copy is made
+// the first time a file is loaded, and again whenever the source's content hash changes. Sources
+// whose size and write time match the copy are not read at all.
+class MeshCache {
+public:
+  MeshCache(std::filesystem::path source_directory, std::filesystem::path cache_directory);
+
+  // Maps the cached copy of `name`, converting the source first if there is no valid copy. Loads
+  // of different names may run concurrently.
+  bool load(std::string_view name, MappedMesh* mesh);
+
+  NU_NO_DISCARD U32 conversions() const {
+    return conversions_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::filesystem::path source_directory_;
+  std::filesystem::path cache_directory_;
+  std::atomic<U32> conversions_ = 0;
+};
+
+}  // namespace ad
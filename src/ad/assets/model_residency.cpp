@@ -0,0 +1,167 @@
+#include "ad/assets/model_residency.h"
+
+#include <utility>
+
+#include "ad/jobs/job_system.h"
+
+namespace ad {
+
+ModelResidency::ModelResidency(MemSize budget, MeshCache* mesh_cache, UploadFunc&& upload,
+                               UnloadFunc&& unload, InUseFunc&& in_use)
+  : budget_{budget},
+    mesh_cache_{mesh_cache},
+    upload_{std::move(upload)},
+    unload_{std::move(unload)},
+    in_use_{std::move(in_use)} {}
+
+ModelResidency::~ModelResidency() {
+  for (const auto& slot : slots_) {
+    wait_for_decode(slot);
+  }
+}
+
+ModelHandle ModelResidency::add(std::string_view name) {
+  for (U32 index = 0; index < slots_.size(); ++index) {
+    if (slots_[index].name == name) {
+      return ModelHandle{index};
+    }
+  }
+
+  slots_.emplace_back().name = name;
+  return ModelHandle{static_cast<U32>(slots_.size() - 1)};
+}
+
+le::RenderModel* ModelResidency::acquire(ModelHandle handle) {
+  if (!handle.is_valid() || handle.index >= slots_.size()) {
+    return nullptr;
+  }
+
+  auto& slot = slots_[handle.index];
+  slot.last_used = ++use_clock_;
+  if (slot.model || slot.failed) {
+    return slot.model;
+  }
+
+  if (!load(&slot)) {
+    return nullptr;
+  }
+
+  // The model is about to be used, so it stays even if that leaves the budget exceeded.
+  trim(handle.index);
+
+  return slot.model;
+}
+
+void ModelResidency::prefetch(ModelHandle handle) {
+  if (!handle.is_valid() || handle.index >= slots_.size()) {
+    return;
+  }
+
+  auto& slot = slots_[handle.index];
+  if (slot.model || slot.failed || slot.decode.load(std::memory_order_acquire) != Decode::None) {
+    return;
+  }
+
+  slot.decode.store(Decode::Running, std::memory_order_relaxed);
+  submit(job_system_, [this, &slot](U32) {
+    slot.decoded = mesh_cache_->load(slot.name, &slot.mesh);
+
+    // Notifying under the lock keeps a waiter, such as the destructor, from returning while the
+    // job still uses the residency.
+    std::lock_guard<std::mutex> lock{decode_mutex_};
+    slot.decode.store(Decode::Done, std::memory_order_release);
+    decode_done_.notify_all();
+  });
+}
+
+void ModelResidency::upload_prefetched() {
+  for (MemSize index = 0; index < slots_.size(); ++index) {
+    auto& slot = slots_[index];
+    if (slot.decode.load(std::memory_order_acquire) != Decode::Done) {
+      continue;
+    }
+
+    // Counts as a use, or the model could be the first to go again.
+    slot.last_used = ++use_clock_;
+    if (load(&slot)) {
+      trim(index);
+    }
+  }
+}
+
+void ModelResidency::trim() {
+  trim(slots_.size());
+}
+
+U32 ModelResidency::resident_count() const {
+  U32 result = 0;
+  for (const auto& slot : slots_) {
+    result += slot.model ? 1 : 0;
+  }
+  return result;
+}
+
+bool ModelResidency::load(Slot* slot) {
+  // A prefetch that is still running is further along than a load started here would be.
+  wait_for_decode(*slot);
+  if (slot->decode.load(std::memory_order_acquire) == Decode::None) {
+    slot->decoded = mesh_cache_->load(slot->name, &slot->mesh);
+  }
+  slot->decode.store(Decode::None, std::memory_order_relaxed);
+
+  MemSize bytes = 0;
+  if (slot->decoded) {
+    slot->model = upload_(slot->name, slot->mesh, &bytes);
+  }
+  slot->mesh.close();
+
+  if (!slot->model) {
+    LOG(Error) << "Could not load model " << slot->name;
+    slot->failed = true;
+    return false;
+  }
+
+  slot->bytes = bytes;
+  resident_bytes_ += bytes;
+  ++load_count_;
+
+  return true;
+}
+
+void ModelResidency::wait_for_decode(const Slot& slot) const {
+  if (slot.decode.load(std::memory_order_acquire) != Decode::Running) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock{decode_mutex_};
+  decode_done_.wait(lock, [&slot] {
+    return slot.decode.load(std::memory_order_acquire) != Decode::Running;
+  });
+}
+
+void ModelResidency::trim(MemSize keep) {
+  while (resident_bytes_ > budget_) {
+    Slot* oldest = nullptr;
+    for (MemSize index = 0; index < slots_.size(); ++index) {
+      auto& slot = slots_[index];
+      if (index == keep || !slot.model || (oldest && slot.last_used >= oldest->last_used)) {
+        continue;
+      }
+      if (!in_use_(slot.model)) {
+        oldest = &slot;
+      }
+    }
+
+    // Everything left is in use.
+    if (!oldest) {
+      return;
+    }
+
+    unload_(oldest->name, oldest->model);
+    oldest->model = nullptr;
+    resident_bytes_ -= oldest->bytes;
+    oldest->bytes = 0;
+  }
+}
+
+}  // namespace ad
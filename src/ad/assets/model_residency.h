@@ -0,0 +1,132 @@
+#pragma once
+
+#include <nucleus/function.h>
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "ad/assets/asset_loader.h"
+#include "ad/assets/mesh_cache.h"
+
+namespace le {
+class RenderModel;
+}
+
+namespace ad {
+
+class JobSystem;
+
+// Keeps models loaded only while a session needs them. A model is loaded the first time it is
+// acquired. Whenever the resident models take up more than the budget, the least recently used
+// ones that nothing draws are unloaded, and loaded again if they are acquired after that.
+//
+// Loading a model maps its mesh from `mesh_cache` and then uploads it. Only the upload has to
+// happen on the thread that owns the renderer; a prefetch maps the mesh on the job system.
+class ModelResidency {
+  NU_DELETE_COPY_AND_MOVE(ModelResidency);
+
+public:
+  // Makes a model from `mesh` on the thread that owns the renderer and sets `bytes` to the memory
+  // it takes up. Returns null if it could not be made.
+  using UploadFunc = nu::Function<le::RenderModel*(std::string_view name, const MappedMesh& mesh,
+                                                   MemSize* bytes)>;
+  // Frees a model made by the upload function.
+  using UnloadFunc = nu::Function<void(std::string_view name, le::RenderModel* model)>;
+  // Whether anything still draws `model`. Models in use are never unloaded.
+  using InUseFunc = nu::Function<bool(le::RenderModel* model)>;
+
+  ModelResidency(MemSize budget, MeshCache* mesh_cache, UploadFunc&& upload, UnloadFunc&& unload,
+                 InUseFunc&& in_use);
+  // Waits for prefetches that are still mapping their mesh.
+  ~ModelResidency();
+
+  // Prefetches map meshes on `job_system`. Without one, they do it on the calling thread.
+  void set_job_system(JobSystem* job_system) {
+    job_system_ = job_system;
+  }
+
+  // Registers `name` without loading it. Adding a name again returns the handle it already has.
+  ModelHandle add(std::string_view name);
+
+  // Loads the model if it is not resident and marks it as the most recently used. Null if it
+  // failed to load; a failed model is not tried again.
+  le::RenderModel* acquire(ModelHandle handle);
+
+  // A hint that `handle` is about to be acquired. Starts mapping its mesh on the job system and
+  // returns without waiting, so the input that asked for it is not held up. The model is uploaded
+  // by `upload_prefetched`, or by `acquire` if that comes first.
+  void prefetch(ModelHandle handle);
+
+  // Uploads the models whose prefetch has mapped their mesh. Call it once a frame.
+  void upload_prefetched();
+
+  // Unloads the least recently used models that are not in use until the rest fit the budget.
+  void trim();
+
+  NU_NO_DISCARD MemSize budget() const {
+    return budget_;
+  }
+
+  NU_NO_DISCARD MemSize resident_bytes() const {
+    return resident_bytes_;
+  }
+
+  NU_NO_DISCARD U32 resident_count() const;
+
+  // Loads so far, counting every reload of an unloaded model.
+  NU_NO_DISCARD U32 load_count() const {
+    return load_count_;
+  }
+
+private:
+  enum class Decode : U8 {
+    None,
+    Running,
+    Done,
+  };
+
+  struct Slot {
+    std::string name;
+    le::RenderModel* model = nullptr;
+    MemSize bytes = 0;
+    U64 last_used = 0;
+    bool failed = false;
+
+    // While `decode` is `Running`, `mesh` and `decoded` belong to a prefetch job.
+    std::atomic<Decode> decode = Decode::None;
+    MappedMesh mesh;
+    bool decoded = false;
+  };
+
+  // Maps the slot's mesh, unless a prefetch already did, and uploads it.
+  bool load(Slot* slot);
+  void wait_for_decode(const Slot& slot) const;
+
+  // Like `trim`, but never unloads the slot at `keep`.
+  void trim(MemSize keep);
+
+  MemSize budget_;
+  MeshCache* mesh_cache_;
+  JobSystem* job_system_ = nullptr;
+  UploadFunc upload_;
+  UnloadFunc unload_;
+  InUseFunc in_use_;
+
+  // A handful of models are registered, so they are searched linearly. Prefetch jobs hold on to
+  // their slot, so slots must not move.
+  std::deque<Slot> slots_;
+  // Signalled whenever a prefetch job finishes, for the thread waiting on its mesh.
+  mutable std::mutex decode_mutex_;
+  mutable std::condition_variable decode_done_;
+  MemSize resident_bytes_ = 0;
+  U64 use_clock_ = 0;
+  U32 load_count_ = 0;
+};
+
+}  // namespace ad
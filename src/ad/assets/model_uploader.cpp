@@ -0,0 +1,123 @@
+#include "ad/assets/model_uploader.h"
+
+#include <legion/resources/render_model.h>
+#include <legion/resources/resource_manager.h>
+
+#include <utility>
+
+namespace ad {
+
+ModelUploader::ModelUploader() = default;
+
+ModelUploader::~ModelUploader() = default;
+
+le::RenderModel* ModelUploader::upload(const MappedMesh& mesh, MemSize* bytes) {
+  return upload(Geometry{mesh.vertices(), mesh.vertex_count(), mesh.indices(), mesh.index_count(),
+                         mesh.material_library(), mesh.materials(), mesh.material_count()},
+                bytes);
+}
+
+le::RenderModel* ModelUploader::upload(const MeshData& mesh, MemSize* bytes) {
+  return upload(Geometry{mesh.vertices.data(), static_cast<U32>(mesh.vertices.size()),
+                         mesh.indices.data(), static_cast<U32>(mesh.indices.size()),
+                         mesh.material_library, mesh.materials.data(),
+                         static_cast<U32>(mesh.materials.size())},
+                bytes);
+}
+
+void ModelUploader::release(le::RenderModel* model) {
+  for (auto it = uploads_.begin(); it != uploads_.end(); ++it) {
+    if (it->model.get() == model) {
+      delete_buffers(*it);
+      uploaded_bytes_ -= it->bytes;
+      uploads_.erase(it);
+      return;
+    }
+  }
+}
+
+le::RenderModel* ModelUploader::upload(const Geometry& geometry, MemSize* bytes) {
+  DCHECK(renderer_);
+
+  // A mesh without materials is drawn in one go, with the default material.
+  MeshMaterial whole_mesh;
+  whole_mesh.index_count = geometry.index_count;
+  const auto* materials = geometry.material_count > 0 ? geometry.materials : &whole_mesh;
+  auto material_count = geometry.material_count > 0 ? geometry.material_count : 1;
+
+  Upload upload;
+  upload.model = std::make_unique<le::RenderModel>();
+
+  // Matches the layout of `MeshVertex`.
+  ca::VertexDefinition definition;
+  definition.add_attribute(ca::ComponentType::Float32, ca::ComponentCount::Three, "position");
+  definition.add_attribute(ca::ComponentType::Float32, ca::ComponentCount::Three, "normal");
+  definition.add_attribute(ca::ComponentType::Float32, ca::ComponentCount::Two, "tex_coord");
+
+  auto vertex_bytes = geometry.vertex_count * sizeof(MeshVertex);
+  upload.vertex_buffer =
+      renderer_->create_vertex_buffer(definition, geometry.vertices, vertex_bytes);
+  bool ok = upload.vertex_buffer.is_valid();
+  upload.bytes = vertex_bytes;
+
+  for (U32 i = 0; ok && i < material_count; ++i) {
+    const auto& material = materials[i];
+
+    le::Material* render_material = nullptr;
+    if (!material.name_view().empty()) {
+      DCHECK(resource_manager_);
+      render_material =
+          resource_manager_->get_material(geometry.material_library, material.name_view());
+      if (!render_material) {
+        LOG(Error) << "Could not load material " << material.name_view() << " from "
+                   << geometry.material_library;
+        ok = false;
+        break;
+      }
+    }
+
+    auto index_bytes = material.index_count * sizeof(U32);
+    auto index_buffer = renderer_->create_index_buffer(
+        ca::ComponentType::Unsigned32, geometry.indices + material.first_index, index_bytes);
+    if (!index_buffer.is_valid()) {
+      ok = false;
+      break;
+    }
+    upload.index_buffers.emplace_back(index_buffer);
+    upload.bytes += index_bytes;
+
+    le::RenderMesh mesh;
+    mesh.vertex_buffer_id = upload.vertex_buffer;
+    mesh.index_buffer_id = index_buffer;
+    mesh.draw_type = ca::DrawType::Triangles;
+    mesh.num_indices = material.index_count;
+    mesh.material = render_material;
+    auto mesh_index = upload.model->meshes().emplaceBack(mesh).index();
+    upload.model->root_node().mesh_indices().emplaceBack(static_cast<U32>(mesh_index));
+  }
+
+  if (!ok) {
+    delete_buffers(upload);
+    return nullptr;
+  }
+
+  if (bytes) {
+    *bytes = upload.bytes;
+  }
+  uploaded_bytes_ += upload.bytes;
+
+  auto* result = upload.model.get();
+  uploads_.emplace_back(std::move(upload));
+  return result;
+}
+
+void ModelUploader::delete_buffers(const Upload& upload) {
+  if (upload.vertex_buffer.is_valid()) {
+    renderer_->delete_vertex_buffer(upload.vertex_buffer);
+  }
+  for (const auto& index_buffer : upload.index_buffers) {
+    renderer_->delete_index_buffer(index_buffer);
+  }
+}
+
+}  // namespace ad
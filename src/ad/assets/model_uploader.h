@@ -0,0 +1,85 @@
+#pragma once
+
+#include <canvas/renderer/renderer.h>
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "ad/assets/mesh_cache.h"
+
+namespace le {
+class RenderModel;
+class ResourceManager;
+}  // namespace le
+
+namespace ad {
+
+// Makes models the renderer can draw straight from mesh vertices and indices, so cached meshes go
+// to the GPU without being parsed again. Owns the models it makes and the buffers behind them.
+// Only use it from the thread that owns the renderer. Buffers of models that are never released
+// stay with the renderer until it goes away.
+class ModelUploader {
+  NU_DELETE_COPY_AND_MOVE(ModelUploader);
+
+public:
+  ModelUploader();
+  ~ModelUploader();
+
+  // Both must be set before the first upload. Materials named by meshes are loaded through
+  // `resource_manager`, from the mesh's material library.
+  void set_renderer(ca::Renderer* renderer) {
+    renderer_ = renderer;
+  }
+
+  void set_resource_manager(le::ResourceManager* resource_manager) {
+    resource_manager_ = resource_manager;
+  }
+
+  // Creates a vertex buffer for the mesh, and an index buffer for each of its materials, and a
+  // model that draws them as triangles with those materials. Returns null if the renderer could not
+  // create the buffers or a material could not be loaded. `bytes`, if given, is set to the size of
+  // the buffers.
+  le::RenderModel* upload(const MappedMesh& mesh, MemSize* bytes = nullptr);
+  le::RenderModel* upload(const MeshData& mesh, MemSize* bytes = nullptr);
+
+  // Deletes the buffers of a model made by `upload` along with the model.
+  void release(le::RenderModel* model);
+
+  // Size of the buffers of every model that has not been released.
+  NU_NO_DISCARD MemSize uploaded_bytes() const {
+    return uploaded_bytes_;
+  }
+
+private:
+  struct Upload {
+    std::unique_ptr<le::RenderModel> model;
+    ca::VertexBufferId vertex_buffer;
+    std::vector<ca::IndexBufferId> index_buffers;
+    MemSize bytes = 0;
+  };
+
+  struct Geometry {
+    const MeshVertex* vertices;
+    U32 vertex_count;
+    const U32* indices;
+    U32 index_count;
+    std::string_view material_library;
+    const MeshMaterial* materials;
+    U32 material_count;
+  };
+
+  le::RenderModel* upload(const Geometry& geometry, MemSize* bytes);
+  void delete_buffers(const Upload& upload);
+
+  ca::Renderer* renderer_ = nullptr;
+  le::ResourceManager* resource_manager_ = nullptr;
+
+  // Uploads are only looked up when a model is released, which is rare.
+  std::vector<Upload> uploads_;
+  MemSize uploaded_bytes_ = 0;
+};
+
+}  // namespace ad
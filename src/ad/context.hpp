@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ad/jobs/job_system.h"
 #include "ad/world/construction_controller.h"
 #include "ad/world/prefabs.h"
 #include "ad/world/world.h"
@@ -12,7 +13,13 @@ public:
   explicit Context(le::ResourceManager* resource_manager)
     : resource_manager_{resource_manager},
       prefabs_{resource_manager},
-      construction_controller_{&world_, &prefabs_} {}
+      construction_controller_{&world_, &prefabs_} {
+    world_.set_job_system(&job_system_);
+  }
+
+  JobSystem& job_system() {
+    return job_system_;
+  }
 
   World& world() {
     return world_;
@@ -28,6 +35,7 @@ public:
 
 private:
   le::ResourceManager* resource_manager_;
+  JobSystem job_system_;
   World world_;
   Prefabs prefabs_;
 
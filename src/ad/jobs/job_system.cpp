@@ -0,0 +1,165 @@
+#include "ad/jobs/job_system.h"
+
+namespace ad {
+
+namespace {
+
+thread_local U32 g_thread_index = 0;
+
+}  // namespace
+
+JobSystem::JobSystem()
+  : JobSystem{std::max(std::thread::hardware_concurrency(), 1u) - 1} {}
+
+JobSystem::JobSystem(U32 worker_count)
+  : thread_count_{worker_count + 1}, queues_{std::make_unique<Queue[]>(thread_count_)} {
+  workers_.reserve(worker_count);
+  for (U32 i = 0; i < worker_count; ++i) {
+    workers_.emplace_back([this, i] { worker_main(i + 1); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  // Submitted jobs nobody waits for could still be queued, and they own their state.
+  while (run_one(current_thread_index())) {
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{sleep_mutex_};
+    stopping_ = true;
+  }
+  wake_up_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+U32 JobSystem::current_thread_index() {
+  return g_thread_index;
+}
+
+void JobSystem::run(MemSize count, MemSize grain, RangeFunc func, void* context) {
+  if (count == 0) {
+    return;
+  }
+
+  Batch batch{func, context, std::max<MemSize>(grain, 1), count};
+
+  auto thread_index = current_thread_index();
+  push(thread_index, Job{&batch, 0, count});
+
+  // Help out until every piece of the batch has run. This thread might run jobs from other batches
+  // as well when it is nested inside another job.
+  while (batch.remaining.load(std::memory_order_acquire) > 0) {
+    if (!run_one(thread_index)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void JobSystem::run_detached(RangeFunc func, ReleaseFunc release, void* context) {
+  auto* batch = new Batch{func, context, 1, 1, release};
+  push(current_thread_index(), Job{batch, 0, 1});
+}
+
+void JobSystem::push(U32 thread_index, const Job& job) {
+  {
+    auto& queue = queues_[thread_index];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    queue.jobs.push_back(job);
+  }
+
+  // Pairs with `worker_main`: either the worker sees the job before it sleeps, or this sees the
+  // sleeping worker. Both sides need sequential consistency for that.
+  queued_jobs_.fetch_add(1, std::memory_order_seq_cst);
+
+  // While every worker is busy, pushing does not touch the shared sleep mutex at all.
+  if (sleeping_workers_.load(std::memory_order_seq_cst) > 0) {
+    std::lock_guard<std::mutex> lock{sleep_mutex_};
+    wake_up_.notify_one();
+  }
+}
+
+bool JobSystem::pop(U32 thread_index, Job* job) {
+  auto& queue = queues_[thread_index];
+  std::lock_guard<std::mutex> lock{queue.mutex};
+  if (queue.jobs.empty()) {
+    return false;
+  }
+
+  *job = queue.jobs.back();
+  queue.jobs.pop_back();
+  queued_jobs_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool JobSystem::steal(U32 thread_index, Job* job) {
+  auto count = thread_count();
+  for (U32 offset = 1; offset < count; ++offset) {
+    auto& queue = queues_[(thread_index + offset) % count];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (!queue.jobs.empty()) {
+      *job = queue.jobs.front();
+      queue.jobs.pop_front();
+      queued_jobs_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool JobSystem::run_one(U32 thread_index) {
+  Job job;
+  if (!pop(thread_index, &job) && !steal(thread_index, &job)) {
+    return false;
+  }
+
+  execute(job, thread_index);
+  return true;
+}
+
+void JobSystem::execute(Job job, U32 thread_index) {
+  auto* batch = job.batch;
+
+  // Keep the first half and offer the second half to thieves until the piece is small enough.
+  while (job.end - job.begin > batch->grain) {
+    auto middle = job.begin + (job.end - job.begin) / 2;
+    push(thread_index, Job{batch, middle, job.end});
+    job.end = middle;
+  }
+
+  batch->func(batch->context, job.begin, job.end, thread_index);
+
+  // A batch from `run` may be gone as soon as its last piece is counted, so read this first.
+  auto release = batch->release;
+  auto size = job.end - job.begin;
+  if (batch->remaining.fetch_sub(size, std::memory_order_acq_rel) == size && release) {
+    release(batch->context);
+    delete batch;
+  }
+}
+
+void JobSystem::worker_main(U32 thread_index) {
+  g_thread_index = thread_index;
+
+  for (;;) {
+    if (run_one(thread_index)) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{sleep_mutex_};
+    sleeping_workers_.fetch_add(1, std::memory_order_seq_cst);
+    wake_up_.wait(lock, [this] {
+      return stopping_ || queued_jobs_.load(std::memory_order_seq_cst) > 0;
+    });
+    sleeping_workers_.fetch_sub(1, std::memory_order_relaxed);
+
+    if (stopping_) {
+      return;
+    }
+  }
+}
+
+}  // namespace ad
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ad {
+
+// Work-stealing thread pool. Every thread owns a deque of jobs: it pushes and pops at the back, and
+// idle threads steal from the front of other threads' deques. A range job larger than its grain
+// splits in half before it runs, so stolen work is always the biggest piece left.
+//
+// The thread calling `parallel_for` takes part in the work as thread 0. Only one thread that is not
+// a worker may use the system at a time.
+class JobSystem {
+  NU_DELETE_COPY_AND_MOVE(JobSystem);
+
+public:
+  // Uses one worker per hardware thread, minus the calling thread.
+  JobSystem();
+  explicit JobSystem(U32 worker_count);
+  // Runs every job that is still queued before it stops the workers.
+  ~JobSystem();
+
+  // Number of threads that can run jobs, including the calling thread.
+  NU_NO_DISCARD U32 thread_count() const {
+    return thread_count_;
+  }
+
+  // Index of the current thread in [0, thread_count()), for indexing per-thread data. Threads that
+  // are not workers get 0.
+  static U32 current_thread_index();
+
+  // Calls `func(begin, end, thread_index)` for pieces of [0, count) no larger than `grain`, and
+  // returns once all of them have run.
+  template <typename Func>
+  void parallel_for(MemSize count, MemSize grain, Func&& func) {
+    using FuncType = std::remove_reference_t<Func>;
+    run(
+        count, grain,
+        [](void* context, MemSize begin, MemSize end, U32 thread_index) {
+          (*static_cast<FuncType*>(context))(begin, end, thread_index);
+        },
+        const_cast<void*>(static_cast<const void*>(&func)));
+  }
+
+  // Queues `func(thread_index)` to run once on a worker and returns without waiting for it. The
+  // caller has to find out by itself when it has run. Without workers, it runs right away on the
+  // calling thread.
+  template <typename Func>
+  void submit(Func&& func) {
+    using FuncType = std::decay_t<Func>;
+    if (thread_count_ == 1) {
+      func(current_thread_index());
+      return;
+    }
+    run_detached(
+        [](void* context, MemSize, MemSize, U32 thread_index) {
+          (*static_cast<FuncType*>(context))(thread_index);
+        },
+        [](void* context) { delete static_cast<FuncType*>(context); },
+        new FuncType{std::forward<Func>(func)});
+  }
+
+private:
+  using RangeFunc = void (*)(void* context, MemSize begin, MemSize end, U32 thread_index);
+  using ReleaseFunc = void (*)(void* context);
+
+  struct Batch {
+    RangeFunc func;
+    void* context;
+    MemSize grain;
+    std::atomic<MemSize> remaining;
+    // Only set for batches from `submit`, which delete themselves once they have run.
+    ReleaseFunc release = nullptr;
+  };
+
+  struct Job {
+    Batch* batch;
+    MemSize begin;
+    MemSize end;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  void run(MemSize count, MemSize grain, RangeFunc func, void* context);
+  void run_detached(RangeFunc func, ReleaseFunc release, void* context);
+
+  void push(U32 thread_index, const Job& job);
+  bool pop(U32 thread_index, Job* job);
+  bool steal(U32 thread_index, Job* job);
+
+  // Finds a job, own first and then stolen, and runs it. Returns false if there was nothing to do.
+  bool run_one(U32 thread_index);
+  void execute(Job job, U32 thread_index);
+
+  void worker_main(U32 thread_index);
+
+  // Fixed before the workers start, which read it while `workers_` is still being filled.
+  U32 thread_count_;
+  std::unique_ptr<Queue[]> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_up_;
+  std::atomic<I64> queued_jobs_ = 0;
+  // Workers waiting on `wake_up_`. Pushing only wakes one when there is one.
+  std::atomic<U32> sleeping_workers_ = 0;
+  bool stopping_ = false;
+};
+
+// Runs `func(begin, end, thread_index)` over [0, count) on `job_system`, or inline on the calling
+// thread if there is no job system or the range is too small to be worth splitting.
+template <typename Func>
+void parallel_for(JobSystem* job_system, MemSize count, MemSize grain, Func&& func) {
+  if (count == 0) {
+    return;
+  }
+
+  if (!job_system || count <= grain) {
+    func(MemSize{0}, count, JobSystem::current_thread_index());
+    return;
+  }
+
+  job_system->parallel_for(count, grain, std::forward<Func>(func));
+}
+
+// Runs `func(thread_index)` once on `job_system` without waiting for it, or right away on the
+// calling thread if there is no job system.
+template <typename Func>
+void submit(JobSystem* job_system, Func&& func) {
+  if (!job_system) {
+    func(JobSystem::current_thread_index());
+    return;
+  }
+
+  job_system->submit(std::forward<Func>(func));
+}
+
+}  // namespace ad
@@ -0,0 +1,72 @@
+#include "ad/profiling/metrics.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ad {
+
+// static
+Metrics& Metrics::get() {
+  static Metrics metrics;
+  return metrics;
+}
+
+void Metrics::set_enabled(bool enabled) {
+  if (enabled && !is_enabled()) {
+    // Start from a clean slate instead of showing whatever was counted before the last disable.
+    std::lock_guard<std::mutex> lock{counters_mutex_};
+    for (auto& counter : counters_) {
+      counter->value_.store(0, std::memory_order_relaxed);
+      counter->last_frame_ = 0;
+    }
+    frame_time_count_ = 0;
+    next_frame_time_ = 0;
+  }
+
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+Metrics::Counter& Metrics::counter(const char* name) {
+  std::lock_guard<std::mutex> lock{counters_mutex_};
+
+  for (auto& counter : counters_) {
+    if (std::strcmp(counter->name(), name) == 0) {
+      return *counter;
+    }
+  }
+
+  counters_.emplace_back(std::make_unique<Counter>(name, &enabled_));
+  return *counters_.back();
+}
+
+void Metrics::end_frame(F64 frame_time_ms) {
+  if (!is_enabled()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{counters_mutex_};
+    for (auto& counter : counters_) {
+      counter->last_frame_ = counter->value_.exchange(0, std::memory_order_relaxed);
+    }
+  }
+
+  frame_times_[next_frame_time_] = frame_time_ms;
+  next_frame_time_ = (next_frame_time_ + 1) % kFrameTimeHistory;
+  frame_time_count_ = std::min(frame_time_count_ + 1, kFrameTimeHistory);
+}
+
+F64 Metrics::frame_time_percentile(F64 fraction) const {
+  if (frame_time_count_ == 0) {
+    return 0.0;
+  }
+
+  F64 sorted[kFrameTimeHistory];
+  std::copy(frame_times_, frame_times_ + frame_time_count_, sorted);
+
+  auto index = static_cast<U32>(std::clamp(fraction, 0.0, 1.0) * (frame_time_count_ - 1) + 0.5);
+  std::nth_element(sorted, sorted + index, sorted + frame_time_count_);
+  return sorted[index];
+}
+
+}  // namespace ad
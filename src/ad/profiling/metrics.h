@@ -0,0 +1,83 @@
+#pragma once
+
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ad {
+
+// Named counters that can stay compiled into release builds: while metrics are disabled, an
+// increment is one relaxed load and a branch. Counters accumulate over a frame; `end_frame` moves
+// the totals into `last_frame` for display.
+class Metrics {
+  NU_DELETE_COPY_AND_MOVE(Metrics);
+
+public:
+  static constexpr U32 kFrameTimeHistory = 256;
+
+  class Counter {
+  public:
+    explicit Counter(const char* name, const std::atomic<bool>* enabled)
+      : name_{name}, enabled_{enabled} {}
+
+    NU_NO_DISCARD const char* name() const {
+      return name_;
+    }
+
+    void add(U64 amount = 1) {
+      if (enabled_->load(std::memory_order_relaxed)) {
+        value_.fetch_add(amount, std::memory_order_relaxed);
+      }
+    }
+
+    // Total from the last complete frame.
+    NU_NO_DISCARD U64 last_frame() const {
+      return last_frame_;
+    }
+
+  private:
+    friend class Metrics;
+
+    const char* name_;
+    const std::atomic<bool>* enabled_;
+    std::atomic<U64> value_ = 0;
+    U64 last_frame_ = 0;
+  };
+
+  // The registry used by the game.
+  static Metrics& get();
+
+  Metrics() = default;
+
+  NU_NO_DISCARD bool is_enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  void set_enabled(bool enabled);
+
+  // Returns the counter named `name`, creating it the first time. The reference stays valid for
+  // the lifetime of the registry, so look counters up once and keep them.
+  Counter& counter(const char* name);
+
+  // Closes the current frame: publishes every counter's total for it and records its duration.
+  void end_frame(F64 frame_time_ms);
+
+  // `fraction` in [0, 1] of the frame times over the last `kFrameTimeHistory` frames.
+  NU_NO_DISCARD F64 frame_time_percentile(F64 fraction) const;
+
+private:
+  std::atomic<bool> enabled_ = false;
+
+  mutable std::mutex counters_mutex_;
+  std::vector<std::unique_ptr<Counter>> counters_;
+
+  F64 frame_times_[kFrameTimeHistory] = {};
+  U32 frame_time_count_ = 0;
+  U32 next_frame_time_ = 0;
+};
+
+}  // namespace ad
@@ -0,0 +1,162 @@
+#include "ad/profiling/profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+namespace ad {
+
+namespace {
+
+std::atomic<U64> g_next_instance_id = 1;
+
+// The buffer this thread last recorded into, and the profiler it belongs to.
+struct ThreadCache {
+  U64 instance_id = 0;
+  void* buffer = nullptr;
+};
+
+thread_local ThreadCache g_thread_cache;
+
+void write_name(std::ostream& out, const char* name) {
+  for (auto* c = name; *c; ++c) {
+    if (*c == '"' || *c == '\\') {
+      out << '\\';
+    }
+    out << *c;
+  }
+}
+
+}  // namespace
+
+// static
+Profiler& Profiler::get() {
+  static Profiler profiler;
+  return profiler;
+}
+
+// static
+U64 Profiler::now_ns() {
+  return static_cast<U64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count());
+}
+
+Profiler::Profiler() : instance_id_{g_next_instance_id.fetch_add(1)} {}
+
+Profiler::~Profiler() = default;
+
+void Profiler::begin_frame() {
+  auto frame = frame_count_.load(std::memory_order_relaxed);
+  frame_starts_[frame % kFrameHistory] = now_ns();
+  frame_count_.store(frame + 1, std::memory_order_release);
+}
+
+void Profiler::record(const char* name, U64 begin_ns, U64 end_ns) {
+  auto* buffer = thread_buffer();
+
+  auto head = buffer->head.load(std::memory_order_relaxed);
+  buffer->events[head % kEventsPerThread] = {name, begin_ns, end_ns};
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+Profiler::ThreadBuffer* Profiler::thread_buffer() {
+  if (g_thread_cache.instance_id == instance_id_) {
+    return static_cast<ThreadBuffer*>(g_thread_cache.buffer);
+  }
+
+  std::lock_guard<std::mutex> lock{buffers_mutex_};
+
+  auto buffer = std::make_unique<ThreadBuffer>();
+  buffer->thread_id = static_cast<U32>(buffers_.size());
+  buffer->events = std::make_unique<Event[]>(kEventsPerThread);
+
+  g_thread_cache = {instance_id_, buffer.get()};
+  buffers_.emplace_back(std::move(buffer));
+
+  return buffers_.back().get();
+}
+
+void Profiler::export_chrome_trace(std::ostream& out, U64 frame_count) const {
+  // The last frame is still running, so the window ends where it started.
+  U64 window_begin = 0;
+  U64 window_end = std::numeric_limits<U64>::max();
+
+  auto frames = this->frame_count();
+  auto complete_frames = std::min<U64>(frames > 0 ? frames - 1 : 0, kFrameHistory - 1);
+  frame_count = std::min(frame_count, complete_frames);
+  auto first_frame = frames - 1 - frame_count;
+  if (frame_count > 0) {
+    window_begin = frame_starts_[first_frame % kFrameHistory];
+    window_end = frame_starts_[(frames - 1) % kFrameHistory];
+  }
+
+  // Chrome traces are in microseconds; make them relative to the window so they stay readable.
+  U64 origin = window_begin;
+  if (frame_count == 0) {
+    origin = std::numeric_limits<U64>::max();
+
+    std::lock_guard<std::mutex> lock{buffers_mutex_};
+    for (const auto& buffer : buffers_) {
+      auto head = buffer->head.load(std::memory_order_acquire);
+      for (U64 i = head - std::min<U64>(head, kEventsPerThread); i < head; ++i) {
+        origin = std::min(origin, buffer->events[i % kEventsPerThread].begin_ns);
+      }
+    }
+  }
+  auto to_us = [origin](U64 ns) {
+    return static_cast<F64>(ns - std::min(ns, origin)) / 1000.0;
+  };
+
+  auto flags = out.flags();
+  auto precision = out.precision();
+  out << std::fixed << std::setprecision(3);
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  auto separator = [&]() -> std::ostream& {
+    if (!first) {
+      out << ",";
+    }
+    first = false;
+    return out << "\n";
+  };
+
+  for (U64 frame = first_frame; frame < first_frame + frame_count; ++frame) {
+    separator() << "{\"name\":\"frame " << frame << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,"
+                << "\"tid\":0,\"ts\":" << to_us(frame_starts_[frame % kFrameHistory]) << "}";
+  }
+
+  std::lock_guard<std::mutex> lock{buffers_mutex_};
+  for (const auto& buffer : buffers_) {
+    auto head = buffer->head.load(std::memory_order_acquire);
+    for (U64 i = head - std::min<U64>(head, kEventsPerThread); i < head; ++i) {
+      const auto& event = buffer->events[i % kEventsPerThread];
+      if (event.begin_ns < window_begin || event.begin_ns >= window_end) {
+        continue;
+      }
+
+      separator() << "{\"name\":\"";
+      write_name(out, event.name);
+      out << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread_id
+          << ",\"ts\":" << to_us(event.begin_ns)
+          << ",\"dur\":" << static_cast<F64>(event.end_ns - event.begin_ns) / 1000.0 << "}";
+    }
+  }
+
+  out << "\n]}\n";
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void Profiler::clear() {
+  std::lock_guard<std::mutex> lock{buffers_mutex_};
+  for (auto& buffer : buffers_) {
+    buffer->head.store(0, std::memory_order_relaxed);
+  }
+  frame_count_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace ad
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// 0 compiles every zone out, 1 keeps frame and system zones, 2 adds a zone for every batch of
+// entities a job works on.
+#if !defined(AD_PROFILE_LEVEL)
+#define AD_PROFILE_LEVEL 1
+#endif
+
+namespace ad {
+
+// Records timed zones into a fixed-size ring buffer per thread, and exports them as Chrome
+// `trace_event` JSON for chrome://tracing or Perfetto.
+//
+// Each thread's buffer is allocated the first time it records a zone; after that, recording never
+// allocates or takes a lock. Once a buffer is full, the oldest zones are overwritten.
+class Profiler {
+  NU_DELETE_COPY_AND_MOVE(Profiler);
+
+public:
+  static constexpr U32 kEventsPerThread = 1 << 15;
+  static constexpr U32 kFrameHistory = 1024;
+
+  struct Event {
+    const char* name;
+    U64 begin_ns;
+    U64 end_ns;
+  };
+
+  // The profiler used by the `AD_PROFILE_*` macros.
+  static Profiler& get();
+
+  static U64 now_ns();
+
+  Profiler();
+  ~Profiler();
+
+  NU_NO_DISCARD bool is_recording() const {
+    return recording_.load(std::memory_order_relaxed);
+  }
+
+  void set_recording(bool recording) {
+    recording_.store(recording, std::memory_order_relaxed);
+  }
+
+  // Marks the start of a frame. Call it from one thread only.
+  void begin_frame();
+
+  NU_NO_DISCARD U64 frame_count() const {
+    return frame_count_.load(std::memory_order_acquire);
+  }
+
+  // `name` must outlive the profiler; string literals are what it is meant for.
+  void record(const char* name, U64 begin_ns, U64 end_ns);
+
+  // Writes the zones that started in the last `frame_count` complete frames. Without any complete
+  // frames, everything still in the buffers is written. Stop recording first; zones recorded
+  // during the export might be torn.
+  void export_chrome_trace(std::ostream& out, U64 frame_count) const;
+
+  // Drops all recorded zones and frames. Only call it while nothing is recording.
+  void clear();
+
+private:
+  struct ThreadBuffer {
+    U32 thread_id;
+    std::unique_ptr<Event[]> events;
+    // Number of events ever written; the ring position is `head % kEventsPerThread`.
+    std::atomic<U64> head = 0;
+  };
+
+  ThreadBuffer* thread_buffer();
+
+  // Tells thread-local caches apart from those of profilers that were destroyed.
+  const U64 instance_id_;
+
+  std::atomic<bool> recording_ = true;
+
+  U64 frame_starts_[kFrameHistory] = {};
+  std::atomic<U64> frame_count_ = 0;
+
+  mutable std::mutex buffers_mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+// Records the time between its construction and destruction as a zone.
+class ProfileZone {
+  NU_DELETE_COPY_AND_MOVE(ProfileZone);
+
+public:
+  explicit ProfileZone(const char* name, Profiler& profiler = Profiler::get())
+    : profiler_{profiler},
+      name_{name},
+      begin_ns_{profiler.is_recording() ? Profiler::now_ns() : 0} {}
+
+  ~ProfileZone() {
+    if (begin_ns_) {
+      profiler_.record(name_, begin_ns_, Profiler::now_ns());
+    }
+  }
+
+private:
+  Profiler& profiler_;
+  const char* name_;
+  U64 begin_ns_;
+};
+
+}  // namespace ad
+
+#define AD_PROFILE_CONCAT_INNER(a, b) a##b
+#define AD_PROFILE_CONCAT(a, b) AD_PROFILE_CONCAT_INNER(a, b)
+
+#if AD_PROFILE_LEVEL >= 1
+#define AD_PROFILE_ZONE(name) ::ad::ProfileZone AD_PROFILE_CONCAT(profile_zone_, __LINE__){name};
+#else
+#define AD_PROFILE_ZONE(name)
+#endif
+
+#if AD_PROFILE_LEVEL >= 2
+#define AD_PROFILE_DETAIL_ZONE(name) \
+  ::ad::ProfileZone AD_PROFILE_CONCAT(profile_zone_, __LINE__){name};
+#else
+#define AD_PROFILE_DETAIL_ZONE(name)
+#endif
@@ -0,0 +1,33 @@
+#include "ad/profiling/startup_timer.h"
+
+#include <iomanip>
+
+namespace ad {
+
+StartupTimer::StartupTimer() : start_{Clock::now()}, phase_start_{start_} {}
+
+void StartupTimer::end_phase(const char* name) {
+  auto now = Clock::now();
+  std::chrono::duration<F64, std::milli> elapsed = now - phase_start_;
+  phases_.emplaceBack(Phase{name, elapsed.count()});
+  phase_start_ = now;
+}
+
+F64 StartupTimer::total_ms() const {
+  std::chrono::duration<F64, std::milli> elapsed = phase_start_ - start_;
+  return elapsed.count();
+}
+
+void StartupTimer::write(std::ostream& out) const {
+  auto flags = out.flags();
+  out << std::fixed << std::setprecision(2);
+  for (const auto& phase : phases_) {
+    out << "  " << std::left << std::setw(24) << phase.name << std::right << std::setw(10)
+        << phase.ms << " ms\n";
+  }
+  out << "  " << std::left << std::setw(24) << "total" << std::right << std::setw(10)
+      << total_ms() << " ms\n";
+  out.flags(flags);
+}
+
+}  // namespace ad
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <nucleus/containers/dynamic_array.h>
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <chrono>
+#include <ostream>
+
+namespace ad {
+
+// Splits the wall clock time from launch to the first frame into named phases.
+class StartupTimer {
+public:
+  struct Phase {
+    const char* name;
+    F64 ms;
+  };
+
+  // Starts timing the first phase.
+  StartupTimer();
+
+  // Ends the running phase as `name` and starts the next one.
+  void end_phase(const char* name);
+
+  NU_NO_DISCARD const nu::DynamicArray<Phase>& phases() const {
+    return phases_;
+  }
+
+  // From construction to the end of the last phase.
+  NU_NO_DISCARD F64 total_ms() const;
+
+  // One line per phase, then the total.
+  void write(std::ostream& out) const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  Clock::time_point start_;
+  Clock::time_point phase_start_;
+  nu::DynamicArray<Phase> phases_;
+};
+
+}  // namespace ad
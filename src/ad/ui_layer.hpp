@@ -7,6 +7,7 @@
 #include <legion/engine/user_interface_engine_layer.hpp>
 
 #include "World/world.h"
+#include "ad/profiling/metrics.h"
 
 namespace ad {
 
@@ -72,6 +73,11 @@ protected:
     minerals_label_->setHorizontalAlignment(el::Alignment::Right);
     resource_container->addChild(minerals_label_);
 
+    counters_container_ = new el::LinearSizerView{&context(), el::Orientation::Vertical};
+    counters_container_->setHorizontalAlignment(el::Alignment::Left);
+    counters_container_->setVerticalAlignment(el::Alignment::Top);
+    context().root_view()->addChild(counters_container_);
+
     return true;
   }
 
@@ -84,12 +90,64 @@ protected:
     sprintf(buf, "%d", context_->world().resources()->minerals());
     minerals_label_->setLabel(buf);
 
-    sprintf(buf, "%llu", context_->world().selected_entity_id().id);
+    sprintf(buf, "%u", context_->world().selected_entity_id().index);
     label_->setLabel(buf);
+
+    update_counters_panel();
+
     context().render(&renderer());
   }
 
 private:
+  // Shows the metrics while they are enabled (toggled with C in the world layer).
+  void update_counters_panel() {
+    auto& metrics = Metrics::get();
+
+    MemSize line = 0;
+    auto print = [&](const char* format, auto... args) {
+      if (line == counter_labels_.size()) {
+        auto* label = new el::LabelView{&context(), "", main_font_};
+        label->setHorizontalAlignment(el::Alignment::Left);
+        counters_container_->addChild(label);
+        counter_labels_.emplaceBack(label);
+      }
+
+      char buf[128];
+      snprintf(buf, sizeof(buf), format, args...);
+      counter_labels_[line++]->setLabel(buf);
+    };
+
+    if (metrics.is_enabled()) {
+      auto& world = context_->world();
+
+      print("frame p50 %.2f ms, p99 %.2f ms", metrics.frame_time_percentile(0.5),
+            metrics.frame_time_percentile(0.99));
+
+      // Summed over all the ticks of the frame, there can be more than one.
+      const auto& systems = world.systems();
+      for (MemSize i = 0; i < systems.system_count(); ++i) {
+        print("  %s %.3f ms", systems.system_name(i), systems.system_frame_duration_ms(i));
+      }
+      print("tick critical path %.3f ms", systems.frame_critical_path_ms());
+      print("render %.3f ms", static_cast<F64>(render_counter_.last_frame()) / 1e6);
+
+      for (U32 type = 1; type < static_cast<U32>(EntityType::Count); ++type) {
+        auto entity_type = static_cast<EntityType>(type);
+        print("  %s %zu", entity_type_name(entity_type),
+              static_cast<size_t>(world.entities().count(entity_type)));
+      }
+
+      auto queries = query_counter_.last_frame();
+      auto candidates = candidate_counter_.last_frame();
+      print("spatial queries %llu, %.1f candidates avg", static_cast<unsigned long long>(queries),
+            queries ? static_cast<F64>(candidates) / static_cast<F64>(queries) : 0.0);
+    }
+
+    for (; line < counter_labels_.size(); ++line) {
+      counter_labels_[line]->setLabel("");
+    }
+  }
+
   nu::ScopedRefPtr<Context> context_;
 
   el::Font* main_font_ = nullptr;
@@ -97,6 +155,13 @@ private:
 
   el::LabelView* electricity_label_ = nullptr;
   el::LabelView* minerals_label_ = nullptr;
+
+  el::LinearSizerView* counters_container_ = nullptr;
+  nu::DynamicArray<el::LabelView*> counter_labels_;
+
+  Metrics::Counter& render_counter_ = Metrics::get().counter("render ns");
+  Metrics::Counter& query_counter_ = Metrics::get().counter("spatial queries");
+  Metrics::Counter& candidate_counter_ = Metrics::get().counter("spatial candidates");
 };
 
 }  // namespace ad
@@ -0,0 +1,85 @@
+#include "ad/world/Systems/movement_kernel.h"
+
+#if AD_MOVEMENT_KERNEL_AVX || AD_MOVEMENT_KERNEL_SSE2
+#include <immintrin.h>
+#endif
+
+namespace ad {
+
+// The kernels load positions and directions as packed pairs of floats.
+static_assert(sizeof(fl::Vec2) == 2 * sizeof(F32));
+
+void integrate_movement_scalar(fl::Vec2* positions, const fl::Vec2* unit_directions,
+                               const F32* speeds, F32* distances_travelled, MemSize count,
+                               F32 delta) {
+  F32 scale = kSpeedScale * delta;
+
+  for (MemSize i = 0; i < count; ++i) {
+    F32 distance = speeds[i] * scale;
+    positions[i] += unit_directions[i] * distance;
+    distances_travelled[i] += distance;
+  }
+}
+
+void integrate_movement(fl::Vec2* positions, const fl::Vec2* unit_directions, const F32* speeds,
+                        F32* distances_travelled, MemSize count, F32 delta) {
+  MemSize i = 0;
+
+#if AD_MOVEMENT_KERNEL_AVX
+  auto scale = _mm256_set1_ps(kSpeedScale * delta);
+
+  for (; i + 8 <= count; i += 8) {
+    auto distance = _mm256_mul_ps(_mm256_loadu_ps(speeds + i), scale);
+
+    auto travelled = _mm256_loadu_ps(distances_travelled + i);
+    _mm256_storeu_ps(distances_travelled + i, _mm256_add_ps(travelled, distance));
+
+    // Duplicate every distance so it lines up with the x and y of its position:
+    // {d0 d0 d1 d1 | d4 d4 d5 d5} and {d2 d2 d3 d3 | d6 d6 d7 d7}, then swap the halves into order.
+    auto low = _mm256_unpacklo_ps(distance, distance);
+    auto high = _mm256_unpackhi_ps(distance, distance);
+    auto distance_0 = _mm256_permute2f128_ps(low, high, 0x20);
+    auto distance_1 = _mm256_permute2f128_ps(low, high, 0x31);
+
+    auto* position = reinterpret_cast<F32*>(positions + i);
+    const auto* direction = reinterpret_cast<const F32*>(unit_directions + i);
+
+    auto position_0 = _mm256_loadu_ps(position);
+    auto position_1 = _mm256_loadu_ps(position + 8);
+    position_0 = _mm256_add_ps(position_0, _mm256_mul_ps(_mm256_loadu_ps(direction), distance_0));
+    position_1 =
+        _mm256_add_ps(position_1, _mm256_mul_ps(_mm256_loadu_ps(direction + 8), distance_1));
+    _mm256_storeu_ps(position, position_0);
+    _mm256_storeu_ps(position + 8, position_1);
+  }
+#elif AD_MOVEMENT_KERNEL_SSE2
+  auto scale = _mm_set1_ps(kSpeedScale * delta);
+
+  for (; i + 4 <= count; i += 4) {
+    auto distance = _mm_mul_ps(_mm_loadu_ps(speeds + i), scale);
+
+    auto travelled = _mm_loadu_ps(distances_travelled + i);
+    _mm_storeu_ps(distances_travelled + i, _mm_add_ps(travelled, distance));
+
+    // Duplicate every distance so it lines up with the x and y of its position.
+    auto distance_0 = _mm_unpacklo_ps(distance, distance);
+    auto distance_1 = _mm_unpackhi_ps(distance, distance);
+
+    auto* position = reinterpret_cast<F32*>(positions + i);
+    const auto* direction = reinterpret_cast<const F32*>(unit_directions + i);
+
+    auto position_0 = _mm_loadu_ps(position);
+    auto position_1 = _mm_loadu_ps(position + 4);
+    position_0 = _mm_add_ps(position_0, _mm_mul_ps(_mm_loadu_ps(direction), distance_0));
+    position_1 = _mm_add_ps(position_1, _mm_mul_ps(_mm_loadu_ps(direction + 4), distance_1));
+    _mm_storeu_ps(position, position_0);
+    _mm_storeu_ps(position + 4, position_1);
+  }
+#endif
+
+  // Whatever did not fill a whole vector.
+  integrate_movement_scalar(positions + i, unit_directions + i, speeds + i,
+                            distances_travelled + i, count - i, delta);
+}
+
+}  // namespace ad
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <floats/vec2.h>
+#include <nucleus/types.h>
+
+#if defined(__AVX__)
+#define AD_MOVEMENT_KERNEL_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AD_MOVEMENT_KERNEL_SSE2 1
+#endif
+
+namespace ad {
+
+// Distance covered per unit of speed and unit of delta.
+constexpr F32 kSpeedScale = 0.01f;
+
+// Moves `count` entities along their unit directions:
+//
+//   positions[i] += unit_directions[i] * speeds[i] * 0.01 * delta
+//   distances_travelled[i] += speeds[i] * 0.01 * delta
+//
+// Uses AVX or SSE2 when the target supports it and falls back to
+// `integrate_movement_scalar` otherwise.
+void integrate_movement(fl::Vec2* positions, const fl::Vec2* unit_directions, const F32* speeds,
+                        F32* distances_travelled, MemSize count, F32 delta);
+
+void integrate_movement_scalar(fl::Vec2* positions, const fl::Vec2* unit_directions,
+                               const F32* speeds, F32* distances_travelled, MemSize count,
+                               F32 delta);
+
+}  // namespace ad
@@ -1,24 +1,104 @@
 #pragma once
 
+#include <algorithm>
+
+#include "ad/jobs/job_system.h"
+#include "ad/profiling/profiler.h"
+#include "ad/world/Systems/movement_kernel.h"
 #include "ad/world/entity_list.hpp"
+#include "ad/world/entity_picker.h"
+#include "ad/world/random.h"
+#include "ad/world/spatial_grid.h"
+#include "ad/world/system.h"
 
 namespace ad {
 
-struct MovementSystem {
-  auto tick(EntityList& entities, F32 delta) -> void {
-    for (auto& entity : entities) {
-      if (entity.movement.speed > 0.0f) {
-        fl::Vec2 d{fl::cosine(entity.movement.direction), fl::sine(entity.movement.direction)};
-        F32 distance = entity.movement.speed * 0.01f * delta;
-        entity.position += d * distance;
+struct MovementSystem : System {
+  static constexpr MemSize kGrainSize = 4096;
+  // Entities pick a new heading every time they have travelled this far. `World` schedules the
+  // reheading timers from it.
+  static constexpr F32 kReheadingDistance = 5.0f;
+
+  // Rows that moved into another grid cell, collected by each thread and applied to the grid after
+  // the parallel part.
+  nu::DynamicArray<nu::DynamicArray<MemSize>> changed_cells;
+
+  const char* name() const override {
+    return "movement";
+  }
+
+  SystemAccess access() const override {
+    return {ACCESS_MOVEMENT | ACCESS_POSITIONS,
+            ACCESS_MOVEMENT | ACCESS_POSITIONS | ACCESS_SPATIAL_INDEX | ACCESS_ENTITY_PICKER};
+  }
+
+  void tick(const SystemContext& context) override {
+    auto& entities = *context.entities;
+    auto* spatial_grid = context.spatial_grid;
+    auto* entity_picker = context.entity_picker;
+    const auto& random = *context.random;
+    auto tick_index = context.tick_index;
+    auto* job_system = context.job_system;
+    auto delta = context.delta;
+
+    changed_cells.resize(job_system ? job_system->thread_count() : 1);
 
-        entity.movement.distance_travelled += distance;
+    entities.for_each_archetype(COMPONENT_MOVEMENT, [&](Archetype& archetype) {
+      parallel_for(job_system, archetype.size(), kGrainSize,
+                   [&](MemSize begin, MemSize end, U32 thread_index) {
+                     AD_PROFILE_DETAIL_ZONE("movement batch")
 
-        if (entity.movement.distance_travelled > 5.0f) {
-          entity.movement.direction = fl::degrees((F32)(std::rand() % 360));
-          entity.movement.distance_travelled = 0.0f;
+                     std::copy(archetype.positions.data() + begin,
+                               archetype.positions.data() + end,
+                               archetype.previous_positions.data() + begin);
+                     std::copy(archetype.directions.data() + begin,
+                               archetype.directions.data() + end,
+                               archetype.previous_directions.data() + begin);
+
+                     integrate_movement(archetype.positions.data() + begin,
+                                        archetype.unit_directions.data() + begin,
+                                        archetype.speeds.data() + begin,
+                                        archetype.distances_travelled.data() + begin, end - begin,
+                                        delta);
+
+                     for (MemSize i = begin; i < end; ++i) {
+                       if (!spatial_grid->update_in_place(archetype.ids[i],
+                                                          archetype.positions[i])) {
+                         changed_cells[thread_index].emplaceBack(i);
+                       }
+                     }
+                   });
+
+      // Moving between cells changes the grid's buckets, which has to happen on one thread.
+      AD_PROFILE_DETAIL_ZONE("movement cell changes")
+      for (auto& rows : changed_cells) {
+        for (auto row : rows) {
+          spatial_grid->update(archetype.ids[row], archetype.positions[row]);
+        }
+        rows.clear();
+      }
+
+      // Only buildings can be selected. The picker skips the ones without a selection circle.
+      if (archetype.has(COMPONENT_BUILDING)) {
+        for (MemSize i = 0; i < archetype.size(); ++i) {
+          entity_picker->update(archetype.ids[i], archetype.positions[i]);
         }
       }
+    });
+
+    // Pick a new heading for the entities whose reheading timer fired. Only here do the cached
+    // unit directions change.
+    if (context.due_reheadings) {
+      const auto& due = *context.due_reheadings;
+      parallel_for(job_system, due.size(), kGrainSize, [&](MemSize begin, MemSize end, U32) {
+        for (MemSize i = begin; i < end; ++i) {
+          auto entity = entities.get(due[i]);
+          auto heading = random.uniform_int(
+              Random::entity_stream(due[i].index, due[i].generation), tick_index, 360);
+          entity.set_direction(fl::degrees(static_cast<F32>(heading)));
+          entity.distance_travelled() = 0.0f;
+        }
+      });
     }
   }
 };
@@ -1,38 +1,71 @@
 #pragma once
 
+#include <vector>
+
+#include "ad/jobs/job_system.h"
+#include "ad/profiling/profiler.h"
 #include "ad/world/entity.h"
 #include "ad/world/entity_list.hpp"
 #include "ad/world/resources.h"
+#include "ad/world/system.h"
 
 namespace ad {
 
-struct ResourceSystem {
-  Resources* resources;
+struct ResourceSystem : System {
+  static constexpr MemSize kGrainSize = 8192;
 
-  explicit ResourceSystem(Resources* resources) : resources{resources} {}
+  // Each thread adds into its own totals, which are summed once all the jobs are done. Aligning
+  // them to a cache line keeps every thread's totals on a line of its own.
+  struct alignas(64) Totals {
+    I32 minerals = 0;
+  };
+  static_assert(sizeof(Totals) == 64);
 
-  auto tick(EntityList& entities, F32 delta) -> void {
-    I32 totalMinerals = 0;
-    I32 totalElectricity = 0;
+  // A `std::vector` allocates over-aligned elements at their alignment.
+  std::vector<Totals> totals;
+
+  const char* name() const override {
+    return "resources";
+  }
+
+  SystemAccess access() const override {
+    return {ACCESS_MINING, ACCESS_RESOURCES};
+  }
 
-    for (auto& entity : entities) {
-      // Electricity
+  void tick(const SystemContext& context) override {
+    auto& entities = *context.entities;
+    auto* resources = context.resources;
+    auto* job_system = context.job_system;
 
-      totalElectricity += entity.electricity.electricity_delta;
+    totals.resize(job_system ? job_system->thread_count() : 1);
+    for (auto& t : totals) {
+      t.minerals = 0;
+    }
 
-      // Mining
+    // Electricity is not summed here: `World` keeps the total up to date as buildings are added,
+    // removed or changed. Only the miners whose mining timer fired this tick are visited.
 
-      entity.mining.time_since_last_cycle += delta;
-      if (entity.mining.time_since_last_cycle >= entity.mining.cycle_duration) {
-        entity.mining.time_since_last_cycle -= entity.mining.cycle_duration;
+    if (context.due_mining_cycles) {
+      const auto& due = *context.due_mining_cycles;
+      parallel_for(job_system, due.size(), kGrainSize,
+                   [&](MemSize begin, MemSize end, U32 thread_index) {
+                     AD_PROFILE_DETAIL_ZONE("mining batch")
 
-        totalMinerals += entity.mining.mineral_amount_per_cycle;
-      }
+                     I32 minerals = 0;
+                     for (MemSize i = begin; i < end; ++i) {
+                       minerals += entities.get(due[i]).mining().mineral_amount_per_cycle;
+                     }
+                     totals[thread_index].minerals += minerals;
+                   });
+    }
+
+    I32 totalMinerals = 0;
+    for (const auto& t : totals) {
+      totalMinerals += t.minerals;
     }
 
-    resources->set_electricity(totalElectricity);
     resources->add_minerals(totalMinerals);
   }
 };
 
-}  //
+}  // namespace ad
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <nucleus/containers/dynamic_array.h>
+
+#include "ad/world/entity.h"
+#include "ad/world/entity_caches.h"
+
+namespace ad {
+
+// Storage for all the entities that share the same set of components. Every field lives in its own
+// array, so a system only pulls the columns it actually reads through the cache.
+struct Archetype {
+  ComponentMask components = 0;
+
+  // Columns every entity has.
+  nu::DynamicArray<EntityId> ids;
+  nu::DynamicArray<EntityType> types;
+  nu::DynamicArray<EntityFlags> flags;
+  nu::DynamicArray<fl::Vec2> positions;
+  nu::DynamicArray<EntityId> targets;
+
+  // Component columns. These stay empty if the component is not in `components`.
+
+  // Movement is split into lanes, so that `integrate_movement` can run over them with SIMD.
+  // `unit_directions` caches the cosine and sine of `directions` and must be kept in sync with it.
+  // The `previous_` lanes hold the state from before the last tick, for render interpolation.
+  // `reheading_timers` and `mining_timers` are the entity's timers on the world's timing wheel.
+  nu::DynamicArray<fl::Angle> directions;
+  nu::DynamicArray<fl::Vec2> unit_directions;
+  nu::DynamicArray<fl::Vec2> previous_positions;
+  nu::DynamicArray<fl::Angle> previous_directions;
+  nu::DynamicArray<F32> speeds;
+  nu::DynamicArray<F32> distances_travelled;
+  nu::DynamicArray<TimerHandle> reheading_timers;
+  nu::DynamicArray<Entity::Building> building;
+  // Transforms of the stretched link and laser models, recomputed only when an end moves.
+  nu::DynamicArray<SegmentTransform> link_transforms;
+  nu::DynamicArray<Entity::Electricity> electricity;
+  nu::DynamicArray<Entity::Mining> mining;
+  nu::DynamicArray<TimerHandle> mining_timers;
+  nu::DynamicArray<SegmentTransform> laser_transforms;
+  nu::DynamicArray<Entity::Render> render;
+  nu::DynamicArray<ModelTransform> model_transforms;
+
+  Archetype() = default;
+  explicit Archetype(ComponentMask components) : components{components} {}
+
+  NU_NO_DISCARD MemSize size() const {
+    return ids.size();
+  }
+
+  NU_NO_DISCARD bool has(ComponentMask mask) const {
+    return NU_BIT_IS_SET(components, mask);
+  }
+
+  // Appends a copy of `prefab` and returns the row it was stored in.
+  MemSize push_back(EntityId id, const Entity& prefab) {
+    auto row = ids.emplaceBack(id).index();
+    types.emplaceBack(prefab.type);
+    flags.emplaceBack(prefab.flags);
+    positions.emplaceBack(prefab.position);
+    targets.emplaceBack(prefab.target);
+
+    if (has(COMPONENT_MOVEMENT)) {
+      directions.emplaceBack(prefab.movement.direction);
+      unit_directions.emplaceBack(
+          fl::Vec2{fl::cosine(prefab.movement.direction), fl::sine(prefab.movement.direction)});
+      previous_positions.emplaceBack(prefab.position);
+      previous_directions.emplaceBack(prefab.movement.direction);
+      speeds.emplaceBack(prefab.movement.speed);
+      distances_travelled.emplaceBack(prefab.movement.distance_travelled);
+      reheading_timers.emplaceBack(TimerHandle{});
+    }
+
+    if (has(COMPONENT_BUILDING)) {
+      building.emplaceBack(prefab.building);
+      link_transforms.emplaceBack(SegmentTransform{});
+    }
+
+    if (has(COMPONENT_ELECTRICITY)) {
+      electricity.emplaceBack(prefab.electricity);
+    }
+
+    if (has(COMPONENT_MINING)) {
+      mining.emplaceBack(prefab.mining);
+      mining_timers.emplaceBack(TimerHandle{});
+      laser_transforms.emplaceBack(SegmentTransform{});
+    }
+
+    if (has(COMPONENT_RENDER)) {
+      render.emplaceBack(prefab.render);
+      model_transforms.emplaceBack(ModelTransform{});
+    }
+
+    return row;
+  }
+
+  void set_direction(MemSize row, fl::Angle direction) {
+    directions[row] = direction;
+    unit_directions[row] = {fl::cosine(direction), fl::sine(direction)};
+  }
+
+  // Removes `row` by moving the last row into its place. Returns the id of the entity that moved,
+  // or an invalid id if `row` was the last row.
+  EntityId swap_remove(MemSize row) {
+    auto last = size() - 1;
+    auto moved = row != last ? ids[last] : EntityId{};
+
+    swap_remove_from(&ids, row);
+    swap_remove_from(&types, row);
+    swap_remove_from(&flags, row);
+    swap_remove_from(&positions, row);
+    swap_remove_from(&targets, row);
+    swap_remove_from(&directions, row);
+    swap_remove_from(&unit_directions, row);
+    swap_remove_from(&previous_positions, row);
+    swap_remove_from(&previous_directions, row);
+    swap_remove_from(&speeds, row);
+    swap_remove_from(&distances_travelled, row);
+    swap_remove_from(&reheading_timers, row);
+    swap_remove_from(&building, row);
+    swap_remove_from(&link_transforms, row);
+    swap_remove_from(&electricity, row);
+    swap_remove_from(&mining, row);
+    swap_remove_from(&mining_timers, row);
+    swap_remove_from(&laser_transforms, row);
+    swap_remove_from(&render, row);
+    swap_remove_from(&model_transforms, row);
+
+    return moved;
+  }
+
+  void clear() {
+    ids.clear();
+    types.clear();
+    flags.clear();
+    positions.clear();
+    targets.clear();
+    directions.clear();
+    unit_directions.clear();
+    previous_positions.clear();
+    previous_directions.clear();
+    speeds.clear();
+    distances_travelled.clear();
+    reheading_timers.clear();
+    building.clear();
+    link_transforms.clear();
+    electricity.clear();
+    mining.clear();
+    mining_timers.clear();
+    laser_transforms.clear();
+    render.clear();
+    model_transforms.clear();
+  }
+
+private:
+  template <typename T>
+  static void swap_remove_from(nu::DynamicArray<T>* column, MemSize row) {
+    if (column->isEmpty()) {
+      return;
+    }
+
+    auto last = column->size() - 1;
+    if (row != last) {
+      (*column)[row] = (*column)[last];
+    }
+    column->resize(last);
+  }
+};
+
+}  // namespace ad
@@ -15,8 +15,19 @@ public:
   explicit ConstructionController(World* world, Prefabs* prefabs)
     : world_{world}, prefabs_{prefabs} {}
 
+  // A hint that building `entity_type` is likely to start soon, so that its model is loaded before
+  // the preview needs it.
+  void prefetch(EntityType entity_type) {
+    prefabs_->prefetch(entity_type);
+  }
+
+  // Does not start if the prefab or its model is missing.
   void start_building(EntityType entity_type) {
     prefab_ = prefabs_->get(entity_type);
+    if (!prefab_) {
+      LOG(Warning) << "Can't build entity type " << static_cast<U32>(entity_type)
+                   << ", its prefab is not available.";
+    }
   }
 
   void cancel_building() {
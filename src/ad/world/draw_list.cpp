@@ -0,0 +1,107 @@
+#include "ad/world/draw_list.h"
+
+#include <algorithm>
+
+#include "ad/world/transform_kernel.h"
+
+namespace ad {
+
+// static
+U64 DrawList::make_key(DrawKind kind, U32 model_index, U32 material, F32 depth) {
+  constexpr U32 kMaxDepth = (1u << kDepthBits) - 1;
+  auto quantized_depth =
+      static_cast<U32>(std::clamp(depth, 0.0f, 1.0f) * static_cast<F32>(kMaxDepth));
+
+  U64 key = static_cast<U64>(kind);
+  key = (key << kModelBits) | (model_index & ((1u << kModelBits) - 1));
+  key = (key << kMaterialBits) | (material & ((1u << kMaterialBits) - 1));
+  key = (key << kDepthBits) | quantized_depth;
+  return key;
+}
+
+void DrawList::clear() {
+  commands_.clear();
+  order_.clear();
+  sorted_.clear();
+  sorted_transforms_.clear();
+  mvps_.clear();
+  models_.clear();
+}
+
+void DrawList::add_model(DrawKind kind, le::RenderModel* model, const fl::Mat4& transform,
+                         F32 depth) {
+  DCHECK(model);
+
+  DrawCommand command;
+  command.key = make_key(kind, model_index(model), 0, depth);
+  command.kind = kind;
+  command.model = model;
+  command.transform = transform;
+  commands_.emplaceBack(command);
+}
+
+void DrawList::add_circle(const fl::Mat4& transform, F32 radius, U32 segments, bool highlighted,
+                          F32 depth) {
+  DrawCommand command;
+  command.key = make_key(DrawKind::SelectionCircle, model_index(nullptr), highlighted ? 1 : 0,
+                         depth);
+  command.kind = DrawKind::SelectionCircle;
+  command.transform = transform;
+  command.radius = radius;
+  command.segments = segments;
+  command.highlighted = highlighted;
+  commands_.emplaceBack(command);
+}
+
+void DrawList::append(const DrawList& other) {
+  constexpr U64 kModelShift = kMaterialBits + kDepthBits;
+  constexpr U64 kModelMask = ((U64{1} << kModelBits) - 1) << kModelShift;
+
+  for (const auto& command : other.commands_) {
+    auto& added = commands_.emplaceBack(command).element();
+    added.key = (command.key & ~kModelMask) |
+                (static_cast<U64>(model_index(command.model)) << kModelShift & kModelMask);
+  }
+}
+
+void DrawList::sort() {
+  // Sort the keys rather than the commands, which are much larger.
+  order_.clear();
+  for (U32 index = 0; index < commands_.size(); ++index) {
+    order_.emplaceBack(SortEntry{commands_[index].key, index});
+  }
+
+  auto by_key = [](const SortEntry& left, const SortEntry& right) {
+    return left.key < right.key || (left.key == right.key && left.index < right.index);
+  };
+  std::sort(order_.data(), order_.data() + order_.size(), by_key);
+
+  // Then lay the commands out in that order, so every batch is contiguous. The transforms get
+  // their own buffer for `compute_mvps`.
+  sorted_.clear();
+  sorted_transforms_.clear();
+  for (const auto& entry : order_) {
+    sorted_.emplaceBack(commands_[entry.index]);
+    sorted_transforms_.emplaceBack(commands_[entry.index].transform);
+  }
+  mvps_.resize(sorted_.size());
+}
+
+void DrawList::compute_mvps(const fl::Mat4& projection_and_view) {
+  DCHECK(mvps_.size() == sorted_transforms_.size());
+  multiply_transforms(projection_and_view, sorted_transforms_.data(), mvps_.data(),
+                      sorted_transforms_.size());
+}
+
+U32 DrawList::model_index(le::RenderModel* model) {
+  for (U32 index = 0; index < models_.size(); ++index) {
+    if (models_[index] == model) {
+      return index;
+    }
+  }
+
+  models_.emplaceBack(model);
+  return static_cast<U32>(models_.size() - 1);
+}
+
+}  // namespace ad
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <floats/mat4.h>
+#include <nucleus/containers/dynamic_array.h>
+#include <nucleus/types.h>
+
+namespace le {
+class RenderModel;
+}
+
+namespace ad {
+
+// What a draw command draws. Commands are submitted in this order.
+enum class DrawKind : U8 {
+  Entity,
+  Link,
+  Laser,
+  SelectionCircle,
+};
+
+// Segment counts of the selection ring templates, from coarse to fine.
+constexpr U32 kCircleLodSegments[] = {16, 32, 64};
+constexpr U32 kCircleLodCount = sizeof(kCircleLodSegments) / sizeof(kCircleLodSegments[0]);
+
+// Picks the ring template for a circle that is `screen_radius` pixels across, so every segment
+// stays a few pixels long.
+inline U32 circle_lod(F32 screen_radius) {
+  if (screen_radius < 12.0f) {
+    return 0;
+  }
+  if (screen_radius < 48.0f) {
+    return 1;
+  }
+  return 2;
+}
+
+struct DrawCommand {
+  U64 key = 0;
+  DrawKind kind = DrawKind::Entity;
+  // Null for selection circles.
+  le::RenderModel* model = nullptr;
+  fl::Mat4 transform = fl::Mat4::identity;
+  // Selection circles drawn through the immediate renderer only, which have no model.
+  F32 radius = 0.0f;
+  U32 segments = 0;
+  bool highlighted = false;
+};
+
+// Draws for one frame, collected before anything is submitted so they can be sorted into batches
+// that share a model. Sort keys hold, from the most significant bits down:
+//
+//   kind (8) | model (16) | material (8) | depth (24)
+//
+// `model` is the order in which the list was given the model, through `add_known_model` or else
+// by its first command, `material` tells apart commands of one model that need different state,
+// and `depth` runs front to back.
+class DrawList {
+public:
+  static constexpr U32 kDepthBits = 24;
+  static constexpr U32 kMaterialBits = 8;
+  static constexpr U32 kModelBits = 16;
+
+  // Packs a sort key. `depth` is clamped to [0, 1].
+  NU_NO_DISCARD static U64 make_key(DrawKind kind, U32 model_index, U32 material, F32 depth);
+
+  NU_NO_DISCARD MemSize size() const {
+    return commands_.size();
+  }
+
+  NU_NO_DISCARD const nu::DynamicArray<DrawCommand>& commands() const {
+    return commands_;
+  }
+
+  void clear();
+
+  // Numbers `model` ahead of any command. Lists given the same known models in the same order
+  // agree on their indices, whichever commands each of them gets, so their keys and batch order do
+  // not depend on how work was split between them.
+  void add_known_model(le::RenderModel* model) {
+    model_index(model);
+  }
+
+  // `model` must not be null. `depth` is the normalized device depth of the command, 0 at the near
+  // plane and 1 at the far plane.
+  void add_model(DrawKind kind, le::RenderModel* model, const fl::Mat4& transform, F32 depth);
+  // A selection circle generated on the fly, for the few that need their own color.
+  void add_circle(const fl::Mat4& transform, F32 radius, U32 segments, bool highlighted,
+                  F32 depth);
+
+  // Adds the commands of `other`, remapping the model indices of any models the two lists numbered
+  // differently. Lets threads fill lists of their own that are merged once they are done.
+  void append(const DrawList& other);
+
+  // Orders the commands by key for `for_each_batch`. `commands` keeps the order they were added
+  // in.
+  void sort();
+
+  // Multiplies `projection_and_view` with the transform of every sorted command in one pass over
+  // a contiguous buffer. Call after `sort`.
+  void compute_mvps(const fl::Mat4& projection_and_view);
+
+  // Calls `func(const DrawCommand* commands, const fl::Mat4* mvps, MemSize count)` for every run
+  // of sorted commands that share their kind and model. `mvps` is only filled in after
+  // `compute_mvps`.
+  template <typename Func>
+  void for_each_batch(Func&& func) const;
+
+private:
+  struct SortEntry {
+    U64 key;
+    U32 index;
+  };
+
+  U32 model_index(le::RenderModel* model);
+
+  nu::DynamicArray<DrawCommand> commands_;
+  nu::DynamicArray<SortEntry> order_;
+  nu::DynamicArray<DrawCommand> sorted_;
+  nu::DynamicArray<fl::Mat4> sorted_transforms_;
+  nu::DynamicArray<fl::Mat4> mvps_;
+  // Models seen since the last `clear`, in the order they were first seen. A frame only uses a
+  // handful, so a linear search is fine.
+  nu::DynamicArray<le::RenderModel*> models_;
+};
+
+template <typename Func>
+void DrawList::for_each_batch(Func&& func) const {
+  MemSize begin = 0;
+  for (MemSize i = 1; i <= sorted_.size(); ++i) {
+    if (i == sorted_.size() || sorted_[i].kind != sorted_[begin].kind ||
+        sorted_[i].model != sorted_[begin].model) {
+      func(sorted_.data() + begin, mvps_.data() + begin, i - begin);
+      begin = i;
+    }
+  }
+}
+
+}  // namespace ad
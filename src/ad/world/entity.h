@@ -7,7 +7,30 @@
 #include "legion/resources/render_model.h"
 #include "nucleus/hash.h"
 
-DECLARE_RESOURCE_ID(Entity);
+// Handle to an entity. `index` names a slot in the `EntityList` and `generation` tells apart the
+// entities that have used that slot over time, so a handle to a destroyed entity never resolves to
+// the entity that replaced it.
+struct EntityId {
+  static constexpr U32 kInvalidIndex = std::numeric_limits<U32>::max();
+
+  U32 index = kInvalidIndex;
+  U32 generation = 0;
+
+  EntityId() = default;
+  explicit EntityId(U32 index, U32 generation = 0) : index{index}, generation{generation} {}
+
+  NU_NO_DISCARD bool is_valid() const {
+    return index != kInvalidIndex;
+  }
+
+  bool operator==(const EntityId& other) const {
+    return index == other.index && generation == other.generation;
+  }
+
+  bool operator!=(const EntityId& other) const {
+    return !(*this == other);
+  }
+};
 
 enum class EntityType : U32 {
   Unknown = 0,
@@ -28,6 +51,25 @@ enum class EntityType : U32 {
   Count,
 };
 
+inline const char* entity_type_name(EntityType entity_type) {
+  switch (entity_type) {
+    case EntityType::CommandCenter:
+      return "Command center";
+    case EntityType::Miner:
+      return "Miner";
+    case EntityType::Turret:
+      return "Turret";
+    case EntityType::Hub:
+      return "Hub";
+    case EntityType::Asteroid:
+      return "Asteroid";
+    case EntityType::EnemyFighter:
+      return "Enemy fighter";
+    default:
+      return "Unknown";
+  }
+}
+
 using EntityFlags = U32;
 
 constexpr EntityFlags ENTITY_FLAG_NEEDS_LINK = NU_BIT(1);
@@ -36,6 +78,16 @@ constexpr EntityFlags ENTITY_FLAG_MINABLE = NU_BIT(3);
 constexpr EntityFlags ENTITY_FLAG_ENEMY = NU_BIT(4);
 constexpr EntityFlags ENTITY_FLAG_ALL = std::numeric_limits<U32>::max();
 
+// Set of optional components an entity carries. Entities with the same set are stored together, see
+// `Archetype`.
+using ComponentMask = U32;
+
+constexpr ComponentMask COMPONENT_MOVEMENT = NU_BIT(0);
+constexpr ComponentMask COMPONENT_BUILDING = NU_BIT(1);
+constexpr ComponentMask COMPONENT_ELECTRICITY = NU_BIT(2);
+constexpr ComponentMask COMPONENT_MINING = NU_BIT(3);
+constexpr ComponentMask COMPONENT_RENDER = NU_BIT(4);
+
 template <>
 struct nu::Hash<EntityType> {
   static HashedValue hashed(EntityType entity_type) {
@@ -43,6 +95,8 @@ struct nu::Hash<EntityType> {
   }
 };
 
+// Full description of an entity. Prefabs are made of these; once spawned, an entity only keeps the
+// components that its prefab actually uses.
 struct Entity {
   EntityId id;
   EntityType type = EntityType::Unknown;
@@ -75,9 +129,39 @@ struct Entity {
 
   struct Render {
     le::RenderModel* model = nullptr;
+    // Radius around the entity's position that contains the model, used for culling.
+    F32 bounding_radius = 1.0f;
   } render;
 
   NU_NO_DISCARD bool has_flags(EntityFlags mask) const {
     return NU_BIT_IS_SET(flags, mask);
   }
+
+  // The components this entity needs, derived from the values that differ from their defaults.
+  NU_NO_DISCARD ComponentMask components() const {
+    ComponentMask result = 0;
+
+    if (movement.speed > 0.0f) {
+      result |= COMPONENT_MOVEMENT;
+    }
+
+    if (building.selection_radius > 0.0f || building.linked_to_id.is_valid() ||
+        has_flags(ENTITY_FLAG_NEEDS_LINK)) {
+      result |= COMPONENT_BUILDING;
+    }
+
+    if (electricity.electricity_delta != 0) {
+      result |= COMPONENT_ELECTRICITY;
+    }
+
+    if (mining.cycle_duration > 0.0f || mining.mineral_amount_per_cycle != 0) {
+      result |= COMPONENT_MINING;
+    }
+
+    if (render.model) {
+      result |= COMPONENT_RENDER;
+    }
+
+    return result;
+  }
 };
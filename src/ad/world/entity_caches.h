@@ -0,0 +1,44 @@
+#pragma once
+
+#include <floats/mat4.h>
+#include <floats/vec2.h>
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <limits>
+
+namespace ad {
+
+// Per-entity values that archetypes store next to the components on behalf of other parts of the
+// world. They are plain values, so the entity storage does not depend on the code that uses them.
+
+// A timer on the world's timing wheel.
+struct TimerHandle {
+  static constexpr U32 kInvalidIndex = std::numeric_limits<U32>::max();
+
+  U32 index = kInvalidIndex;
+  U32 generation = 0;
+
+  NU_NO_DISCARD bool is_valid() const {
+    return index != kInvalidIndex;
+  }
+};
+
+// Model matrix of an entity at `position`, turned by `direction` radians, kept until either
+// changes.
+struct ModelTransform {
+  fl::Vec2 position;
+  F32 direction = 0.0f;
+  fl::Mat4 transform = fl::Mat4::identity;
+  bool is_valid = false;
+};
+
+// Transform of a model stretched from `from` to `to`, kept until either end moves.
+struct SegmentTransform {
+  fl::Vec2 from;
+  fl::Vec2 to;
+  fl::Mat4 transform = fl::Mat4::identity;
+  bool is_valid = false;
+};
+
+}  // namespace ad
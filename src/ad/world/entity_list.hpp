@@ -2,26 +2,328 @@
 
 #include <nucleus/containers/dynamic_array.h>
 
+#include <algorithm>
+#include <iterator>
 #include <ranges>
 
+#include "ad/world/archetype.h"
 #include "ad/world/entity.h"
 
 namespace ad {
 
-using EntityList = nu::DynamicArray<Entity>;
+// Reference to a single entity inside an `Archetype`. Only valid until entities are added or
+// destroyed; store an `EntityId` to refer to an entity for longer.
+class EntityRef {
+public:
+  EntityRef(Archetype* archetype, MemSize row) : archetype_{archetype}, row_{row} {}
 
-auto matching_mask(EntityFlags mask) {
+  NU_NO_DISCARD EntityId id() const {
+    return archetype_->ids[row_];
+  }
+
+  NU_NO_DISCARD EntityType type() const {
+    return archetype_->types[row_];
+  }
+
+  NU_NO_DISCARD EntityFlags flags() const {
+    return archetype_->flags[row_];
+  }
+
+  NU_NO_DISCARD bool has_flags(EntityFlags mask) const {
+    return NU_BIT_IS_SET(flags(), mask);
+  }
+
+  NU_NO_DISCARD bool has(ComponentMask mask) const {
+    return archetype_->has(mask);
+  }
+
+  NU_NO_DISCARD fl::Vec2& position() const {
+    return archetype_->positions[row_];
+  }
+
+  NU_NO_DISCARD EntityId& target() const {
+    return archetype_->targets[row_];
+  }
+
+  NU_NO_DISCARD fl::Angle direction() const {
+    return has(COMPONENT_MOVEMENT) ? archetype_->directions[row_] : fl::Angle::zero;
+  }
+
+  void set_direction(fl::Angle direction) const {
+    DCHECK(has(COMPONENT_MOVEMENT));
+    archetype_->set_direction(row_, direction);
+  }
+
+  NU_NO_DISCARD F32& speed() const {
+    DCHECK(has(COMPONENT_MOVEMENT));
+    return archetype_->speeds[row_];
+  }
+
+  NU_NO_DISCARD F32& distance_travelled() const {
+    DCHECK(has(COMPONENT_MOVEMENT));
+    return archetype_->distances_travelled[row_];
+  }
+
+  NU_NO_DISCARD TimerHandle& reheading_timer() const {
+    DCHECK(has(COMPONENT_MOVEMENT));
+    return archetype_->reheading_timers[row_];
+  }
+
+  NU_NO_DISCARD Entity::Building& building() const {
+    DCHECK(has(COMPONENT_BUILDING));
+    return archetype_->building[row_];
+  }
+
+  NU_NO_DISCARD SegmentTransform& link_transform() const {
+    DCHECK(has(COMPONENT_BUILDING));
+    return archetype_->link_transforms[row_];
+  }
+
+  NU_NO_DISCARD Entity::Electricity& electricity() const {
+    DCHECK(has(COMPONENT_ELECTRICITY));
+    return archetype_->electricity[row_];
+  }
+
+  NU_NO_DISCARD Entity::Mining& mining() const {
+    DCHECK(has(COMPONENT_MINING));
+    return archetype_->mining[row_];
+  }
+
+  NU_NO_DISCARD TimerHandle& mining_timer() const {
+    DCHECK(has(COMPONENT_MINING));
+    return archetype_->mining_timers[row_];
+  }
+
+  NU_NO_DISCARD Entity::Render& render() const {
+    DCHECK(has(COMPONENT_RENDER));
+    return archetype_->render[row_];
+  }
+
+private:
+  Archetype* archetype_;
+  MemSize row_;
+};
+
+// All the entities in the world, grouped into one `Archetype` per combination of components.
+class EntityList {
+public:
+  // Walks every entity in every archetype.
+  class Iterator {
+  public:
+    using iterator_concept = std::forward_iterator_tag;
+    using value_type = EntityRef;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+    Iterator(nu::DynamicArray<Archetype>* archetypes, MemSize archetype, MemSize row)
+      : archetypes_{archetypes}, archetype_{archetype}, row_{row} {
+      skip_empty();
+    }
+
+    EntityRef operator*() const {
+      return {&(*archetypes_)[archetype_], row_};
+    }
+
+    Iterator& operator++() {
+      ++row_;
+      skip_empty();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      auto result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return archetype_ == other.archetype_ && row_ == other.row_;
+    }
+
+  private:
+    void skip_empty() {
+      while (archetype_ < archetypes_->size() && row_ >= (*archetypes_)[archetype_].size()) {
+        ++archetype_;
+        row_ = 0;
+      }
+    }
+
+    nu::DynamicArray<Archetype>* archetypes_ = nullptr;
+    MemSize archetype_ = 0;
+    MemSize row_ = 0;
+  };
+
+  NU_NO_DISCARD MemSize size() const {
+    return size_;
+  }
+
+  // Number of live entities of `entity_type`.
+  NU_NO_DISCARD MemSize count(EntityType entity_type) const {
+    return type_counts_[static_cast<U32>(entity_type)];
+  }
+
+  // One past the highest `EntityId::index` handed out so far.
+  NU_NO_DISCARD MemSize slot_count() const {
+    return slots_.size();
+  }
+
+  NU_NO_DISCARD nu::DynamicArray<Archetype>& archetypes() {
+    return archetypes_;
+  }
+
+  // Spawns a copy of `prefab` into the archetype matching its components. Slots of destroyed
+  // entities are reused before new ones are allocated.
+  EntityId add(const Entity& prefab) {
+    auto components = prefab.components();
+
+    MemSize archetype_index = 0;
+    for (; archetype_index < archetypes_.size(); ++archetype_index) {
+      if (archetypes_[archetype_index].components == components) {
+        break;
+      }
+    }
+    if (archetype_index == archetypes_.size()) {
+      archetypes_.emplaceBack(components);
+    }
+
+    U32 index;
+    if (free_head_ != kEndOfFreeList) {
+      index = free_head_;
+      free_head_ = slots_[index].row;
+    } else {
+      index = static_cast<U32>(slots_.size());
+      slots_.emplaceBack(Slot{});
+    }
+
+    auto& slot = slots_[index];
+    auto entity_id = EntityId{index, slot.generation};
+
+    slot.archetype = static_cast<U32>(archetype_index);
+    slot.row = static_cast<U32>(archetypes_[archetype_index].push_back(entity_id, prefab));
+
+    ++size_;
+    ++type_counts_[static_cast<U32>(prefab.type)];
+
+    return entity_id;
+  }
+
+  // Removes the entity in O(1). Its handle, and any copies of it, stop being alive.
+  bool destroy(EntityId entity_id) {
+    if (!is_alive(entity_id)) {
+      return false;
+    }
+
+    auto& slot = slots_[entity_id.index];
+    auto& archetype = archetypes_[slot.archetype];
+
+    --type_counts_[static_cast<U32>(archetype.types[slot.row])];
+
+    auto moved = archetype.swap_remove(slot.row);
+    if (moved.is_valid()) {
+      slots_[moved.index].row = slot.row;
+    }
+
+    slot.archetype = kNoArchetype;
+    slot.row = free_head_;
+    ++slot.generation;
+    free_head_ = entity_id.index;
+
+    --size_;
+
+    return true;
+  }
+
+  NU_NO_DISCARD bool is_alive(EntityId entity_id) const {
+    return entity_id.index < slots_.size() &&
+           slots_[entity_id.index].generation == entity_id.generation &&
+           slots_[entity_id.index].archetype != kNoArchetype;
+  }
+
+  NU_NO_DISCARD EntityRef get(EntityId entity_id) {
+    DCHECK(is_alive(entity_id));
+    auto& slot = slots_[entity_id.index];
+    return {&archetypes_[slot.archetype], slot.row};
+  }
+
+  // Calls `func(Archetype&)` for every archetype that has all the components in `mask`.
+  template <typename Func>
+  void for_each_archetype(ComponentMask mask, Func&& func) {
+    for (auto& archetype : archetypes_) {
+      if (archetype.has(mask) && archetype.size() > 0) {
+        func(archetype);
+      }
+    }
+  }
+
+  template <typename Func>
+  void for_each_archetype(ComponentMask mask, Func&& func) const {
+    for (const auto& archetype : archetypes_) {
+      if (archetype.has(mask) && archetype.size() > 0) {
+        func(archetype);
+      }
+    }
+  }
+
+  void clear() {
+    for (auto& archetype : archetypes_) {
+      archetype.clear();
+    }
+
+    // Keep the slots so that handles from before the clear are still detected as stale.
+    free_head_ = kEndOfFreeList;
+    for (auto index = static_cast<U32>(slots_.size()); index-- > 0;) {
+      auto& slot = slots_[index];
+      if (slot.archetype != kNoArchetype) {
+        slot.archetype = kNoArchetype;
+        ++slot.generation;
+      }
+      slot.row = free_head_;
+      free_head_ = index;
+    }
+
+    size_ = 0;
+    std::fill(std::begin(type_counts_), std::end(type_counts_), 0);
+  }
+
+  Iterator begin() {
+    return {&archetypes_, 0, 0};
+  }
+
+  Iterator end() {
+    return {&archetypes_, archetypes_.size(), 0};
+  }
+
+private:
+  static constexpr U32 kNoArchetype = std::numeric_limits<U32>::max();
+  static constexpr U32 kEndOfFreeList = std::numeric_limits<U32>::max();
+
+  // Where the entity using this slot lives. While the slot is free, `row` links to the next free
+  // slot instead.
+  struct Slot {
+    U32 archetype = kNoArchetype;
+    U32 row = 0;
+    U32 generation = 0;
+  };
+
+  nu::DynamicArray<Archetype> archetypes_;
+  nu::DynamicArray<Slot> slots_;
+  U32 free_head_ = kEndOfFreeList;
+  MemSize size_ = 0;
+  MemSize type_counts_[static_cast<U32>(EntityType::Count)] = {};
+};
+
+inline auto matching_mask(EntityFlags mask) {
   return std::ranges::views::filter(
-      [mask](const Entity& entity) { return entity.has_flags(mask); });
+      [mask](const EntityRef& entity) { return entity.has_flags(mask); });
 }
 
-auto excluding_id(EntityId id) {
-  return std::views::filter([id](const Entity& entity) { return entity.id != id; });
+inline auto excluding_id(EntityId id) {
+  return std::views::filter([id](const EntityRef& entity) { return entity.id() != id; });
 }
 
-auto within_radius(const fl::Vec2 center, F32 radius) {
-  return std::views::filter([center, radius](Entity& entity) {
-    F32 distance_to_entity = fl::distance(center, entity.position);
+inline auto within_radius(const fl::Vec2 center, F32 radius) {
+  return std::views::filter([center, radius](const EntityRef& entity) {
+    F32 distance_to_entity = fl::distance(center, entity.position());
     return distance_to_entity <= radius;
   });
 }
@@ -31,11 +333,11 @@ EntityId closest(Range&& range, const fl::Vec2& position) {
   F32 closest_distance = std::numeric_limits<F32>::max();
   EntityId closest_id;
 
-  for (auto& entity : std::forward<Range>(range)) {
-    auto distance_to_entity = fl::distance(position, entity.position);
+  for (auto&& entity : std::forward<Range>(range)) {
+    auto distance_to_entity = fl::distance(position, entity.position());
     if (distance_to_entity <= closest_distance) {
       closest_distance = distance_to_entity;
-      closest_id = entity.id;
+      closest_id = entity.id();
     }
   }
 
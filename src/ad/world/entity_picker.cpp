@@ -0,0 +1,122 @@
+#include "ad/world/entity_picker.h"
+
+namespace ad {
+
+EntityPicker::EntityPicker(F32 cell_size) : grid_{cell_size} {}
+
+void EntityPicker::clear() {
+  grid_.clear();
+  selection_radii_.clear();
+  max_selection_radius_ = 0.0f;
+  candidates_.clear();
+  candidates_valid_ = false;
+}
+
+void EntityPicker::insert(EntityId entity_id, const fl::Vec2& position, F32 selection_radius) {
+  DCHECK(selection_radius > 0.0f);
+
+  grid_.insert(entity_id, position, 0);
+
+  if (entity_id.index >= selection_radii_.size()) {
+    selection_radii_.resize(entity_id.index + 1, 0.0f);
+  }
+  selection_radii_[entity_id.index] = selection_radius;
+  max_selection_radius_ = std::max(max_selection_radius_, selection_radius);
+
+  candidates_valid_ = false;
+}
+
+void EntityPicker::update(EntityId entity_id, const fl::Vec2& position) {
+  if (!contains(entity_id)) {
+    return;
+  }
+
+  if (!grid_.update_in_place(entity_id, position)) {
+    grid_.update(entity_id, position);
+  }
+
+  if (!candidates_valid_) {
+    return;
+  }
+
+  // Candidates that moved out of reach stay; `pick` checks the distance anyway.
+  for (auto& candidate : candidates_) {
+    if (candidate.id == entity_id) {
+      candidate.position = position;
+      return;
+    }
+  }
+
+  auto selection_radius = selection_radii_[entity_id.index];
+  if (reaches_candidates_cell(position, selection_radius)) {
+    candidates_.emplaceBack(Candidate{entity_id, position, selection_radius});
+  }
+}
+
+void EntityPicker::remove(EntityId entity_id) {
+  grid_.remove(entity_id);
+  if (entity_id.index < selection_radii_.size()) {
+    selection_radii_[entity_id.index] = 0.0f;
+  }
+  candidates_valid_ = false;
+}
+
+EntityId EntityPicker::pick(const fl::Vec2& position) {
+  auto inverse_cell_size = 1.0f / grid_.cell_size();
+  auto cell_x = static_cast<I32>(std::floor(position.x * inverse_cell_size));
+  auto cell_y = static_cast<I32>(std::floor(position.y * inverse_cell_size));
+
+  if (!candidates_valid_ || cell_x != candidates_cell_x_ || cell_y != candidates_cell_y_) {
+    gather_candidates(cell_x, cell_y);
+  }
+
+  EntityId result;
+  F32 closest_distance = std::numeric_limits<F32>::max();
+
+  for (const auto& candidate : candidates_) {
+    auto distance = fl::distance(candidate.position, position);
+    if (distance < candidate.selection_radius && distance < closest_distance) {
+      closest_distance = distance;
+      result = candidate.id;
+    }
+  }
+
+  return result;
+}
+
+void EntityPicker::gather_candidates(I32 cell_x, I32 cell_y) {
+  candidates_.clear();
+
+  candidates_cell_x_ = cell_x;
+  candidates_cell_y_ = cell_y;
+  candidates_valid_ = true;
+
+  auto cell_size = grid_.cell_size();
+  fl::Vec2 cell_center{(static_cast<F32>(cell_x) + 0.5f) * cell_size,
+                       (static_cast<F32>(cell_y) + 0.5f) * cell_size};
+
+  // Anything whose circle reaches into the cell is within half the cell diagonal plus the largest
+  // selection radius of the cell center.
+  auto query_radius = cell_size * 0.7072f + max_selection_radius_;
+
+  grid_.for_each_within_radius(cell_center, query_radius, 0, [&](EntityId entity_id,
+                                                                  const fl::Vec2& position) {
+    auto selection_radius = selection_radii_[entity_id.index];
+    if (reaches_candidates_cell(position, selection_radius)) {
+      candidates_.emplaceBack(Candidate{entity_id, position, selection_radius});
+    }
+  });
+}
+
+bool EntityPicker::reaches_candidates_cell(const fl::Vec2& position, F32 selection_radius) const {
+  auto cell_size = grid_.cell_size();
+  fl::Vec2 cell_min{static_cast<F32>(candidates_cell_x_) * cell_size,
+                    static_cast<F32>(candidates_cell_y_) * cell_size};
+  fl::Vec2 cell_max = cell_min + fl::Vec2{cell_size, cell_size};
+
+  fl::Vec2 nearest{std::clamp(position.x, cell_min.x, cell_max.x),
+                   std::clamp(position.y, cell_min.y, cell_max.y)};
+  return fl::distance(nearest, position) < selection_radius;
+}
+
+}  // namespace ad
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <nucleus/containers/dynamic_array.h>
+
+#include "ad/world/entity.h"
+#include "ad/world/spatial_grid.h"
+
+namespace ad {
+
+// Finds the selectable entity under the cursor. Selectable entities are kept in their own grid,
+// and the entities whose selection circles touch the cursor's cell are cached, so while the cursor
+// stays inside one cell no grid query is made at all. Moving entities keep the cache up to date
+// instead of throwing it away.
+class EntityPicker {
+public:
+  explicit EntityPicker(F32 cell_size = 4.0f);
+
+  void clear();
+
+  void insert(EntityId entity_id, const fl::Vec2& position, F32 selection_radius);
+  // Does nothing for entities that were not inserted.
+  void update(EntityId entity_id, const fl::Vec2& position);
+  void remove(EntityId entity_id);
+
+  NU_NO_DISCARD bool contains(EntityId entity_id) const {
+    return entity_id.index < selection_radii_.size() && selection_radii_[entity_id.index] > 0.0f;
+  }
+
+  // Returns the entity whose selection circle contains `position`. If more than one does, the one
+  // with its center closest to `position` wins.
+  EntityId pick(const fl::Vec2& position);
+
+private:
+  struct Candidate {
+    EntityId id;
+    fl::Vec2 position;
+    F32 selection_radius;
+  };
+
+  void gather_candidates(I32 cell_x, I32 cell_y);
+  // Whether a selection circle at `position` reaches into the cell the candidates are for.
+  NU_NO_DISCARD bool reaches_candidates_cell(const fl::Vec2& position, F32 selection_radius) const;
+
+  SpatialGrid grid_;
+
+  // Selection radius of every inserted entity, indexed by `EntityId::index`, or 0 if the entity is
+  // not in the picker.
+  nu::DynamicArray<F32> selection_radii_;
+  F32 max_selection_radius_ = 0.0f;
+
+  nu::DynamicArray<Candidate> candidates_;
+  I32 candidates_cell_x_ = 0;
+  I32 candidates_cell_y_ = 0;
+  bool candidates_valid_ = false;
+};
+
+}  // namespace ad
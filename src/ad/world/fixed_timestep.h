@@ -0,0 +1,82 @@
+#pragma once
+
+#include <nucleus/macros.h>
+#include <nucleus/types.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ad {
+
+// Turns variable frame times into a whole number of fixed-size simulation ticks. Time that does not
+// fill a tick is carried over to the next frame, and `alpha` says how far the frame is between the
+// last two ticks, so rendering can interpolate between them.
+class FixedTimestep {
+public:
+  static constexpr U32 kDefaultMaxSubsteps = 5;
+
+  // `tick_delta` is in the same units as the frame deltas passed to `advance`. It must be
+  // positive.
+  explicit FixedTimestep(F32 tick_delta, U32 max_substeps = kDefaultMaxSubsteps)
+    : tick_delta_{tick_delta}, max_substeps_{max_substeps} {
+    DCHECK(tick_delta > 0.0f);
+  }
+
+  NU_NO_DISCARD F32 tick_delta() const {
+    return tick_delta_;
+  }
+
+  // The carried time is kept. If it fills ticks of the new delta, the next `advance` runs them.
+  void set_tick_delta(F32 tick_delta) {
+    DCHECK(tick_delta > 0.0f);
+    tick_delta_ = tick_delta;
+  }
+
+  NU_NO_DISCARD U32 max_substeps() const {
+    return max_substeps_;
+  }
+
+  void set_max_substeps(U32 max_substeps) {
+    max_substeps_ = max_substeps;
+  }
+
+  // Adds a frame's time and returns how many ticks to run for it. After a long stall at most
+  // `max_substeps` ticks are returned and the rest of the time is dropped, otherwise slow ticks
+  // make the next frame even longer and the simulation never catches up.
+  U32 advance(F32 frame_delta) {
+    accumulator_ += std::max(frame_delta, 0.0f);
+
+    U32 ticks = 0;
+    while (accumulator_ >= tick_delta_ && ticks < max_substeps_) {
+      accumulator_ -= tick_delta_;
+      ++ticks;
+    }
+
+    if (accumulator_ >= tick_delta_) {
+      auto remainder = std::fmod(accumulator_, tick_delta_);
+      dropped_time_ += accumulator_ - remainder;
+      accumulator_ = remainder;
+    }
+
+    return ticks;
+  }
+
+  // How far the current frame is past the last tick, as a fraction of a tick in [0, 1). Between
+  // a shorter `set_tick_delta` and the next `advance`, a whole tick can be carried and this is 1.
+  NU_NO_DISCARD F32 alpha() const {
+    return std::min(accumulator_ / tick_delta_, 1.0f);
+  }
+
+  // Total time thrown away because of the substep cap.
+  NU_NO_DISCARD F32 dropped_time() const {
+    return dropped_time_;
+  }
+
+private:
+  F32 tick_delta_;
+  U32 max_substeps_;
+  F32 accumulator_ = 0.0f;
+  F32 dropped_time_ = 0.0f;
+};
+
+}  // namespace ad
@@ -0,0 +1,144 @@
+#include "ad/world/frustum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ad {
+
+namespace {
+
+F32 element(const fl::Mat4& m, U32 row, U32 column) {
+  const auto& c = m.col[column];
+  switch (row) {
+    case 0:
+      return c.x;
+    case 1:
+      return c.y;
+    case 2:
+      return c.z;
+    default:
+      return c.w;
+  }
+}
+
+F32 dot(const fl::Vec4& plane, const fl::Vec3& point) {
+  return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+}
+
+fl::Vec3 cross(const fl::Vec4& a, const fl::Vec4& b) {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+// The point where three planes meet. They must not be parallel.
+fl::Vec3 intersect(const fl::Vec4& a, const fl::Vec4& b, const fl::Vec4& c) {
+  auto bc = cross(b, c);
+  auto ca = cross(c, a);
+  auto ab = cross(a, b);
+  auto denominator = -(a.x * bc.x + a.y * bc.y + a.z * bc.z);
+  return {(a.w * bc.x + b.w * ca.x + c.w * ab.x) / denominator,
+          (a.w * bc.y + b.w * ca.y + c.w * ab.y) / denominator,
+          (a.w * bc.z + b.w * ca.z + c.w * ab.z) / denominator};
+}
+
+}  // namespace
+
+Frustum::Frustum(const fl::Mat4& projection_and_view) {
+  auto row = [&](U32 r) {
+    return fl::Vec4{element(projection_and_view, r, 0), element(projection_and_view, r, 1),
+                    element(projection_and_view, r, 2), element(projection_and_view, r, 3)};
+  };
+  auto combine = [](const fl::Vec4& a, const fl::Vec4& b, F32 sign) {
+    return fl::Vec4{a.x + b.x * sign, a.y + b.y * sign, a.z + b.z * sign, a.w + b.w * sign};
+  };
+
+  auto w = row(3);
+  planes_[kLeft] = combine(w, row(0), 1.0f);
+  planes_[kRight] = combine(w, row(0), -1.0f);
+  planes_[kBottom] = combine(w, row(1), 1.0f);
+  planes_[kTop] = combine(w, row(1), -1.0f);
+  planes_[kNear] = combine(w, row(2), 1.0f);
+  planes_[kFar] = combine(w, row(2), -1.0f);
+
+  // Normalized, so that `dot` gives real distances for the sphere test.
+  for (auto& plane : planes_) {
+    auto length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    if (length > 0.0f) {
+      plane = {plane.x / length, plane.y / length, plane.z / length, plane.w / length};
+    }
+  }
+}
+
+bool Frustum::intersects_sphere(const fl::Vec3& center, F32 radius) const {
+  for (const auto& plane : planes_) {
+    if (dot(plane, center) < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Frustum::intersects_box(const fl::Vec3& min, const fl::Vec3& max) const {
+  for (const auto& plane : planes_) {
+    // The corner furthest along the plane's normal.
+    fl::Vec3 corner{plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y,
+                    plane.z >= 0.0f ? max.z : min.z};
+    if (dot(plane, corner) < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Frustum::ground_bounds(F32 half_height, fl::Vec2* min, fl::Vec2* max) const {
+  fl::Vec3 corners[8];
+  for (U32 i = 0; i < 8; ++i) {
+    corners[i] = intersect(planes_[i & 1 ? kRight : kLeft], planes_[i & 2 ? kTop : kBottom],
+                           planes_[i & 4 ? kFar : kNear]);
+  }
+
+  // The corners of the frustum inside the slab, and the points where its edges cross the slab's
+  // faces, are the corners of the part of the frustum inside the slab.
+  constexpr U32 kEdges[12][2] = {{0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3},
+                                 {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+
+  *min = {std::numeric_limits<F32>::max(), std::numeric_limits<F32>::max()};
+  *max = {std::numeric_limits<F32>::lowest(), std::numeric_limits<F32>::lowest()};
+  bool found = false;
+
+  auto include = [&](F32 x, F32 y) {
+    *min = {std::min(min->x, x), std::min(min->y, y)};
+    *max = {std::max(max->x, x), std::max(max->y, y)};
+    found = true;
+  };
+
+  for (const auto& edge : kEdges) {
+    const auto& from = corners[edge[0]];
+    const auto& to = corners[edge[1]];
+
+    // Clip the edge to the slab.
+    F32 t_min = 0.0f;
+    F32 t_max = 1.0f;
+    auto dz = to.z - from.z;
+    if (dz == 0.0f) {
+      if (std::abs(from.z) > half_height) {
+        continue;
+      }
+    } else {
+      auto t_a = (-half_height - from.z) / dz;
+      auto t_b = (half_height - from.z) / dz;
+      t_min = std::max(t_min, std::min(t_a, t_b));
+      t_max = std::min(t_max, std::max(t_a, t_b));
+      if (t_min > t_max) {
+        continue;
+      }
+    }
+
+    include(from.x + (to.x - from.x) * t_min, from.y + (to.y - from.y) * t_min);
+    include(from.x + (to.x - from.x) * t_max, from.y + (to.y - from.y) * t_max);
+  }
+
+  return found;
+}
+
+}  // namespace ad
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <floats/mat4.h>
+#include <nucleus/types.h>
+
+namespace ad {
+
+// The volume a camera sees, as six planes facing inwards. Built from a projection-view matrix, so
+// it works for perspective and orthographic cameras alike.
+class Frustum {
+public:
+  // Extracts the planes from the rows of `projection_and_view` (Gribb & Hartmann), for clip space
+  // with -w <= z <= w.
+  explicit Frustum(const fl::Mat4& projection_and_view);
+
+  NU_NO_DISCARD bool intersects_sphere(const fl::Vec3& center, F32 radius) const;
+  // Box from `min` to `max`. Can report boxes that are just outside a corner of the frustum as
+  // intersecting, which is fine for culling.
+  NU_NO_DISCARD bool intersects_box(const fl::Vec3& min, const fl::Vec3& max) const;
+
+  // The part of the z = 0 plane, thickened to `-half_height <= z <= half_height`, that the frustum
+  // overlaps, as a rectangle from `min` to `max`. Returns false if the frustum misses the slab.
+  bool ground_bounds(F32 half_height, fl::Vec2* min, fl::Vec2* max) const;
+
+private:
+  enum Plane : U32 {
+    kLeft,
+    kRight,
+    kBottom,
+    kTop,
+    kNear,
+    kFar,
+    kPlaneCount,
+  };
+
+  // Normal in xyz, distance in w. Points with `dot(normal, point) + w >= 0` are inside.
+  fl::Vec4 planes_[kPlaneCount];
+};
+
+}  // namespace ad
@@ -1,50 +1,59 @@
 #include "ad/world/generator.hpp"
 
-#include <floats/random.h>
-
 namespace ad {
 
 bool populate_world(World* world, Prefabs* prefabs) {
-  Entity* command_center = prefabs->get(EntityType::CommandCenter);
-  if (!command_center) {
-    LOG(Error) << "Could not load command center prefab.";
+  // Prefabs are only taken when an entity is spawned, so that models of entities that aren't
+  // spawned are never loaded.
+  if (!prefabs->contains(EntityType::CommandCenter)) {
+    LOG(Error) << "Could not find command center prefab.";
     return false;
   }
 
-  Entity* miner = prefabs->get(EntityType::Miner);
-  if (!miner) {
-    LOG(Error) << "Could not load miner prefab.";
+  if (!prefabs->contains(EntityType::Miner)) {
+    LOG(Error) << "Could not find miner prefab.";
     return false;
   }
 
-  Entity* asteroid = prefabs->get(EntityType::Asteroid);
-  if (!asteroid) {
-    LOG(Error) << "Could not load asteroid prefab.";
+  if (!prefabs->contains(EntityType::Asteroid)) {
+    LOG(Error) << "Could not find asteroid prefab.";
     return false;
   }
 
-  Entity* enemy_fighter = prefabs->get(EntityType::EnemyFighter);
-  if (!enemy_fighter) {
-    LOG(Error) << "Could not load enemy fighter prefab.";
+  if (!prefabs->contains(EntityType::EnemyFighter)) {
+    LOG(Error) << "Could not find enemy fighter prefab.";
     return false;
   }
 
   world->clear();
 
+  auto random = world->random().stream(Random::kPopulateStream);
+
+  // Entities whose model could not be loaded are left out, so nothing is drawn without a model.
+  U32 skipped = 0;
+  auto create = [&](EntityType entity_type, const fl::Vec2& position) {
+    auto* prefab = prefabs->get(entity_type);
+    if (!prefab) {
+      ++skipped;
+      return EntityId{};
+    }
+    return world->add_entity_from_prefab(prefab, position);
+  };
+
   auto create_command_center = [&](const fl::Vec2& position) {
-    return world->add_entity_from_prefab(command_center, position);
+    return create(EntityType::CommandCenter, position);
   };
 
   auto create_miner = [&](const fl::Vec2& position) {
-    return world->add_entity_from_prefab(miner, position);
+    return create(EntityType::Miner, position);
   };
 
   auto create_asteroid = [&](const fl::Vec2& position) {
-    return world->add_entity_from_prefab(asteroid, position);
+    return create(EntityType::Asteroid, position);
   };
 
   auto create_enemy_fighter = [&](const fl::Vec2& position) {
-    return world->add_entity_from_prefab(enemy_fighter, position);
+    return create(EntityType::EnemyFighter, position);
   };
 
   // Command center
@@ -63,8 +72,8 @@ bool populate_world(World* world, Prefabs* prefabs) {
 
 #if 1
   for (U32 i = 0; i < 10; ++i) {
-    fl::Angle theta = fl::degrees((F32)(fl::randomInt() % 360));
-    F32 distance = 30.0f + static_cast<F32>(fl::randomInt() % 10);
+    fl::Angle theta = fl::degrees((F32)random.next_int(360));
+    F32 distance = 30.0f + static_cast<F32>(random.next_int(10));
     create_asteroid(fl::Vec2{fl::cosine(theta) * distance, fl::sine(theta) * distance});
   }
 #endif  // 0
@@ -73,12 +82,16 @@ bool populate_world(World* world, Prefabs* prefabs) {
 
 #if 0
   for (U32 i = 0; i < 20; ++i) {
-    fl::Angle theta = fl::degrees((F32)(fl::randomInt() % 360));
-    F32 distance = (F32)(fl::randomInt() % 100);
+    fl::Angle theta = fl::degrees((F32)random.next_int(360));
+    F32 distance = (F32)random.next_int(100);
     create_enemy_fighter(fl::Vec2{fl::cosine(theta) * distance, fl::sine(theta) * distance});
   }
 #endif  // 0
 
+  if (skipped > 0) {
+    LOG(Warning) << "Skipped " << skipped << " entities whose model could not be loaded.";
+  }
+
   return true;
 }
 
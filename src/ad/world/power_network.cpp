@@ -0,0 +1,184 @@
+#include "ad/world/power_network.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ad {
+
+void PowerNetwork::clear() {
+  nodes_.clear();
+  total_electricity_ = 0;
+}
+
+void PowerNetwork::add(EntityId entity_id, I32 electricity_delta) {
+  DCHECK(entity_id.is_valid());
+
+  if (entity_id.index >= nodes_.size()) {
+    nodes_.resize(entity_id.index + 1);
+  }
+
+  auto& node = nodes_[entity_id.index];
+  DCHECK(!node.present);
+
+  node.generation = entity_id.generation;
+  node.present = true;
+  node.linked_to = EntityId{};
+  node.electricity_delta = electricity_delta;
+  make_singleton(entity_id.index);
+
+  total_electricity_ += electricity_delta;
+}
+
+void PowerNetwork::link(EntityId from, EntityId to) {
+  auto* from_node = node_for(from);
+  if (!from_node || !node_for(to)) {
+    return;
+  }
+
+  auto previous = from_node->linked_to;
+  from_node->linked_to = to;
+
+  if (previous.is_valid() && previous != to && node_for(previous)) {
+    // Dropping the old link might split the network.
+    rebuild(from.index, kInvalidIndex);
+  } else {
+    unite(from.index, to.index);
+  }
+}
+
+void PowerNetwork::remove(EntityId entity_id) {
+  auto* node = node_for(entity_id);
+  if (!node) {
+    return;
+  }
+
+  total_electricity_ -= node->electricity_delta;
+  rebuild(entity_id.index, entity_id.index);
+}
+
+void PowerNetwork::set_electricity_delta(EntityId entity_id, I32 electricity_delta) {
+  auto* node = node_for(entity_id);
+  if (!node) {
+    return;
+  }
+
+  auto old_stats = stats_for(node->electricity_delta);
+  auto new_stats = stats_for(electricity_delta);
+  total_electricity_ += electricity_delta - node->electricity_delta;
+  node->electricity_delta = electricity_delta;
+
+  auto& root = nodes_[find(entity_id.index)];
+  root.stats.supply += new_stats.supply - old_stats.supply;
+  root.stats.demand += new_stats.demand - old_stats.demand;
+}
+
+bool PowerNetwork::contains(EntityId entity_id) const {
+  return node_for(entity_id) != nullptr;
+}
+
+U32 PowerNetwork::network_id(EntityId entity_id) {
+  return node_for(entity_id) ? find(entity_id.index) : kInvalidIndex;
+}
+
+PowerNetwork::Stats PowerNetwork::stats(EntityId entity_id) {
+  return node_for(entity_id) ? nodes_[find(entity_id.index)].stats : Stats{};
+}
+
+bool PowerNetwork::is_powered(EntityId entity_id) {
+  auto network = stats(entity_id);
+  return network.supply > 0 && network.supply >= network.demand;
+}
+
+// static
+PowerNetwork::Stats PowerNetwork::stats_for(I32 electricity_delta) {
+  return {std::max(electricity_delta, 0), std::max(-electricity_delta, 0), 1};
+}
+
+PowerNetwork::Node* PowerNetwork::node_for(EntityId entity_id) {
+  return const_cast<Node*>(std::as_const(*this).node_for(entity_id));
+}
+
+const PowerNetwork::Node* PowerNetwork::node_for(EntityId entity_id) const {
+  if (entity_id.index >= nodes_.size()) {
+    return nullptr;
+  }
+
+  const auto& node = nodes_[entity_id.index];
+  return node.present && node.generation == entity_id.generation ? &node : nullptr;
+}
+
+U32 PowerNetwork::find(U32 index) {
+  while (nodes_[index].parent != index) {
+    auto& node = nodes_[index];
+    node.parent = nodes_[node.parent].parent;
+    index = node.parent;
+  }
+  return index;
+}
+
+void PowerNetwork::unite(U32 a, U32 b) {
+  auto root_a = find(a);
+  auto root_b = find(b);
+  if (root_a == root_b) {
+    return;
+  }
+
+  if (nodes_[root_a].rank < nodes_[root_b].rank) {
+    std::swap(root_a, root_b);
+  }
+
+  auto& parent = nodes_[root_a];
+  auto& child = nodes_[root_b];
+
+  child.parent = root_a;
+  if (parent.rank == child.rank) {
+    ++parent.rank;
+  }
+
+  parent.stats.supply += child.stats.supply;
+  parent.stats.demand += child.stats.demand;
+  parent.stats.building_count += child.stats.building_count;
+
+  // Splicing two rings together is a swap of their `next` links.
+  std::swap(parent.next, child.next);
+}
+
+void PowerNetwork::make_singleton(U32 index) {
+  auto& node = nodes_[index];
+  node.parent = index;
+  node.rank = 0;
+  node.next = index;
+  node.stats = stats_for(node.electricity_delta);
+}
+
+void PowerNetwork::rebuild(U32 member, U32 excluding) {
+  members_.clear();
+  auto index = member;
+  do {
+    members_.emplaceBack(index);
+    index = nodes_[index].next;
+  } while (index != member);
+
+  for (auto i : members_) {
+    make_singleton(i);
+  }
+
+  if (excluding != kInvalidIndex) {
+    nodes_[excluding].present = false;
+  }
+
+  // Every link inside the network belongs to one of its members, so relinking the members
+  // restores everything that is left.
+  for (auto i : members_) {
+    if (!nodes_[i].present) {
+      continue;
+    }
+
+    const auto& linked_to = nodes_[i].linked_to;
+    if (linked_to.is_valid() && node_for(linked_to)) {
+      unite(i, linked_to.index);
+    }
+  }
+}
+
+}  // namespace ad
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <nucleus/containers/dynamic_array.h>
+
+#include "ad/world/entity.h"
+
+namespace ad {
+
+// Groups buildings into networks along their links and keeps every network's electricity supply
+// and demand, so "is this building powered" never walks the link graph.
+//
+// Networks are the sets of a disjoint-set forest (union by rank, path halving), so adding a
+// building, linking it and changing its electricity are all O(α(N)). Disjoint sets can not split,
+// so removing a building rebuilds the network it was in from its remaining links, which only
+// touches the members of that one network.
+class PowerNetwork {
+public:
+  struct Stats {
+    // Sum of the positive electricity deltas in the network.
+    I32 supply = 0;
+    // Sum of the negative electricity deltas in the network, as a positive number.
+    I32 demand = 0;
+    U32 building_count = 0;
+  };
+
+  void clear();
+
+  void add(EntityId entity_id, I32 electricity_delta);
+  // Replaces the building's outgoing link. Both buildings must have been added.
+  void link(EntityId from, EntityId to);
+  void remove(EntityId entity_id);
+
+  void set_electricity_delta(EntityId entity_id, I32 electricity_delta);
+
+  NU_NO_DISCARD bool contains(EntityId entity_id) const;
+
+  // Buildings with the same network id are connected. Ids change when networks merge or split.
+  NU_NO_DISCARD U32 network_id(EntityId entity_id);
+
+  NU_NO_DISCARD Stats stats(EntityId entity_id);
+
+  // A building is powered if its network produces at least as much electricity as it uses.
+  NU_NO_DISCARD bool is_powered(EntityId entity_id);
+
+  // Sum of the electricity deltas of all buildings.
+  NU_NO_DISCARD I32 total_electricity() const {
+    return total_electricity_;
+  }
+
+private:
+  static constexpr U32 kInvalidIndex = EntityId::kInvalidIndex;
+
+  struct Node {
+    U32 generation = 0;
+    bool present = false;
+
+    U32 parent = kInvalidIndex;
+    U32 rank = 0;
+    // Members of a network form a ring through `next`, so a network can be listed without
+    // scanning every node.
+    U32 next = kInvalidIndex;
+
+    EntityId linked_to;
+    I32 electricity_delta = 0;
+
+    // Only valid on the root of a network.
+    Stats stats;
+  };
+
+  static Stats stats_for(I32 electricity_delta);
+
+  Node* node_for(EntityId entity_id);
+  const Node* node_for(EntityId entity_id) const;
+
+  U32 find(U32 index);
+  void unite(U32 a, U32 b);
+  void make_singleton(U32 index);
+  // Splits the network containing `member` into singletons and links them up again, leaving out
+  // `excluding` if it is a valid index.
+  void rebuild(U32 member, U32 excluding);
+
+  nu::DynamicArray<Node> nodes_;
+  // Scratch space for `rebuild`.
+  nu::DynamicArray<U32> members_;
+  I32 total_electricity_ = 0;
+};
+
+}  // namespace ad
@@ -4,21 +4,81 @@
 #include <nucleus/containers/hash_map.h>
 #include <nucleus/function.h>
 
+#include <string_view>
+
+#include "ad/assets/model_residency.h"
 #include "ad/world/entity.h"
 
 class Prefabs {
 public:
   explicit Prefabs(le::ResourceManager* resource_manager) : resource_manager_{resource_manager} {}
 
+  // Models named with `set_model` are loaded through `residency` when first needed. Set it before
+  // naming any models, and set it to null before the residency goes away. Without a residency,
+  // prefabs with a named model are not available.
+  void set_model_residency(ad::ModelResidency* model_residency) {
+    // Models loaded through the previous residency belong to it.
+    for (U32 type = 0; type < static_cast<U32>(EntityType::Count); ++type) {
+      auto entity_type = static_cast<EntityType>(type);
+      auto prefab = prefabs_.find(entity_type);
+      if (prefab.was_found() && models_.find(entity_type).was_found()) {
+        prefab.value().render.model = nullptr;
+      }
+    }
+
+    model_residency_ = model_residency;
+  }
+
+  // The prefab for spawning or previewing an entity. If the prefab has a named model, the model is
+  // loaded first if it is not resident, so only take a prefab when it is about to be used. Null if
+  // there is no such prefab or its model could not be loaded. The prefab's model stays valid until
+  // the model residency unloads it, see `forget_model`.
   Entity* get(EntityType entity_type) {
     auto result = prefabs_.find(entity_type);
     if (!result.was_found()) {
       return nullptr;
     }
 
+    auto model = models_.find(entity_type);
+    if (model.was_found()) {
+      if (!model_residency_) {
+        return nullptr;
+      }
+
+      // The residency logs why the model is missing.
+      auto* render_model = model_residency_->acquire(model.value());
+      if (!render_model) {
+        return nullptr;
+      }
+      result.value().render.model = render_model;
+    }
+
     return &result.value();
   }
 
+  // Call when `model` is unloaded, so that no prefab keeps pointing at it. `get` loads it again.
+  void forget_model(const le::RenderModel* model) {
+    for (U32 type = 0; type < static_cast<U32>(EntityType::Count); ++type) {
+      auto result = prefabs_.find(static_cast<EntityType>(type));
+      if (result.was_found() && result.value().render.model == model) {
+        result.value().render.model = nullptr;
+      }
+    }
+  }
+
+  NU_NO_DISCARD bool contains(EntityType entity_type) {
+    return prefabs_.find(entity_type).was_found();
+  }
+
+  // Starts loading the prefab's model ahead of `get`, e.g. while a build is about to start,
+  // without waiting for it.
+  void prefetch(EntityType entity_type) {
+    auto model = models_.find(entity_type);
+    if (model.was_found() && model_residency_) {
+      model_residency_->prefetch(model.value());
+    }
+  }
+
   bool set(EntityType entity_type, nu::Function<bool(le::ResourceManager*, Entity*)>&& func) {
     auto result = prefabs_.insert(entity_type, {});
     Entity* storage = &result.value();
@@ -28,7 +88,16 @@ public:
     return func(resource_manager_, storage);
   }
 
+  // Gives the prefab a model that is only loaded once the prefab is used.
+  void set_model(EntityType entity_type, std::string_view model_name) {
+    DCHECK(model_residency_);
+    models_.insert(entity_type, model_residency_->add(model_name));
+  }
+
 private:
   le::ResourceManager* resource_manager_;
   nu::HashMap<EntityType, Entity> prefabs_;
+
+  ad::ModelResidency* model_residency_ = nullptr;
+  nu::HashMap<EntityType, ad::ModelHandle> models_;
 };
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <nucleus/types.h>
+
+namespace ad {
+
+// Counter-based random number generator. Every value is a pure function of (seed, stream, counter),
+// so there is no shared state to advance: any thread can produce the value for any entity and tick
+// in any order, and the same seed always produces the same world.
+class Random {
+public:
+  // A sequence of values on one stream, for code that just wants "the next number".
+  class Stream {
+  public:
+    Stream(const Random* random, U64 stream) : random_{random}, stream_{stream} {}
+
+    U64 next() {
+      return random_->value(stream_, counter_++);
+    }
+
+    // Uniform in [0, bound).
+    U32 next_int(U32 bound) {
+      return random_->uniform_int(stream_, counter_++, bound);
+    }
+
+    // Uniform in [0, 1).
+    F32 next_float() {
+      return random_->uniform_float(stream_, counter_++);
+    }
+
+  private:
+    const Random* random_;
+    U64 stream_;
+    U64 counter_ = 0;
+  };
+
+  static constexpr U64 kDefaultSeed = 0x5EED'AD00'0000'0001;
+
+  // Streams used by the world itself. Entity streams never have the top bit set.
+  static constexpr U64 kPopulateStream = 0x8000'0000'0000'0001;
+
+  // Every entity gets its own stream for as long as it lives. A new entity in a recycled slot gets
+  // a new stream.
+  static constexpr U64 entity_stream(U32 index, U32 generation) {
+    return (static_cast<U64>(generation & 0x7FFF'FFFF) << 32) | index;
+  }
+
+  explicit Random(U64 seed = kDefaultSeed) : seed_{seed} {}
+
+  NU_NO_DISCARD U64 seed() const {
+    return seed_;
+  }
+
+  void set_seed(U64 seed) {
+    seed_ = seed;
+  }
+
+  NU_NO_DISCARD Stream stream(U64 stream) const {
+    return Stream{this, stream};
+  }
+
+  NU_NO_DISCARD U64 value(U64 stream, U64 counter) const {
+    // Two rounds of the SplitMix64 finalizer: one to derive a key for the stream, one to mix the
+    // counter into it.
+    auto key = mix(seed_ + stream * 0xD1B54A32D192ED03ull);
+    return mix(key + counter * 0x9E3779B97F4A7C15ull);
+  }
+
+  // Uniform in [0, bound).
+  NU_NO_DISCARD U32 uniform_int(U64 stream, U64 counter, U32 bound) const {
+    // Multiply-shift instead of modulo, which is both faster and unbiased enough for gameplay.
+    return static_cast<U32>(((value(stream, counter) >> 32) * bound) >> 32);
+  }
+
+  // Uniform in [0, 1).
+  NU_NO_DISCARD F32 uniform_float(U64 stream, U64 counter) const {
+    return static_cast<F32>(value(stream, counter) >> 40) * (1.0f / 16777216.0f);
+  }
+
+private:
+  static U64 mix(U64 z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  U64 seed_;
+};
+
+}  // namespace ad
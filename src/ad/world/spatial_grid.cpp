@@ -0,0 +1,258 @@
+#include "ad/world/spatial_grid.h"
+
+#include "ad/profiling/metrics.h"
+
+namespace ad {
+
+namespace {
+
+Metrics::Counter& g_query_counter = Metrics::get().counter("spatial queries");
+Metrics::Counter& g_candidate_counter = Metrics::get().counter("spatial candidates");
+
+template <typename Func>
+void for_each_flag_bit(EntityFlags flags, Func&& func) {
+  while (flags) {
+    func(static_cast<U32>(std::countr_zero(flags)));
+    flags &= flags - 1;
+  }
+}
+
+}  // namespace
+
+// static
+void SpatialGrid::record_query(MemSize candidates) {
+  g_query_counter.add();
+  g_candidate_counter.add(candidates);
+}
+
+SpatialGrid::SpatialGrid(F32 cell_size)
+  : cell_size_{cell_size}, inverse_cell_size_{1.0f / cell_size} {}
+
+void SpatialGrid::clear() {
+  for (auto& layer : layers_) {
+    layer.buckets.clear();
+    layer.slots.clear();
+    layer.count = 0;
+    layer.min_cell = {0, 0};
+    layer.max_cell = {0, 0};
+  }
+}
+
+void SpatialGrid::insert(EntityId entity_id, const fl::Vec2& position, EntityFlags flags) {
+  DCHECK(entity_id.is_valid());
+
+  Entry entry{entity_id, position, flags};
+
+  insert_into_layer(&layers_[0], entry);
+  for_each_flag_bit(flags, [&](U32 bit) { insert_into_layer(&layers_[bit + 1], entry); });
+}
+
+void SpatialGrid::update(EntityId entity_id, const fl::Vec2& position) {
+  auto& all = layers_[0];
+  if (entity_id.index >= all.slots.size() || all.slots[entity_id.index].bucket == kInvalidBucket) {
+    return;
+  }
+
+  auto slot = all.slots[entity_id.index];
+  auto entry = all.buckets[slot.bucket][slot.index];
+
+  auto update_layer = [&](Layer* layer) {
+    auto& s = layer->slots[entity_id.index];
+    auto& stored = layer->buckets[s.bucket][s.index];
+
+    if (cell_for(stored.position) == cell_for(position)) {
+      stored.position = position;
+      return;
+    }
+
+    remove_from_layer(layer, entity_id);
+    insert_into_layer(layer, Entry{entity_id, position, entry.flags});
+  };
+
+  update_layer(&all);
+  for_each_flag_bit(entry.flags, [&](U32 bit) { update_layer(&layers_[bit + 1]); });
+}
+
+bool SpatialGrid::update_in_place(EntityId entity_id, const fl::Vec2& position) {
+  auto& all = layers_[0];
+  if (entity_id.index >= all.slots.size() || all.slots[entity_id.index].bucket == kInvalidBucket) {
+    return true;
+  }
+
+  auto slot = all.slots[entity_id.index];
+  auto& entry = all.buckets[slot.bucket][slot.index];
+  if (cell_for(entry.position) != cell_for(position)) {
+    return false;
+  }
+
+  auto flags = entry.flags;
+  entry.position = position;
+  for_each_flag_bit(flags, [&](U32 bit) {
+    auto& layer = layers_[bit + 1];
+    auto& s = layer.slots[entity_id.index];
+    layer.buckets[s.bucket][s.index].position = position;
+  });
+
+  return true;
+}
+
+void SpatialGrid::remove(EntityId entity_id) {
+  auto& all = layers_[0];
+  if (entity_id.index >= all.slots.size() || all.slots[entity_id.index].bucket == kInvalidBucket) {
+    return;
+  }
+
+  auto slot = all.slots[entity_id.index];
+  auto flags = all.buckets[slot.bucket][slot.index].flags;
+
+  remove_from_layer(&all, entity_id);
+  for_each_flag_bit(flags, [&](U32 bit) { remove_from_layer(&layers_[bit + 1], entity_id); });
+}
+
+EntityId SpatialGrid::closest(const fl::Vec2& position, EntityFlags mask,
+                              EntityId excluding) const {
+  return closest_in_layer(layers_[layer_for_mask(mask)], position,
+                          std::numeric_limits<F32>::max(), mask, excluding);
+}
+
+EntityId SpatialGrid::closest_within_radius(const fl::Vec2& position, F32 radius,
+                                            EntityFlags mask, EntityId excluding) const {
+  return closest_in_layer(layers_[layer_for_mask(mask)], position, radius, mask, excluding);
+}
+
+void SpatialGrid::insert_into_layer(Layer* layer, const Entry& entry) {
+  if (layer->buckets.isEmpty()) {
+    layer->buckets.resize(kInitialBucketCount);
+  } else if (layer->count >= layer->buckets.size() * 4) {
+    rehash_layer(layer, layer->buckets.size() * 4);
+  }
+
+  auto cell = cell_for(entry.position);
+  if (layer->count == 0) {
+    layer->min_cell = cell;
+    layer->max_cell = cell;
+  } else {
+    layer->min_cell = {std::min(layer->min_cell.x, cell.x), std::min(layer->min_cell.y, cell.y)};
+    layer->max_cell = {std::max(layer->max_cell.x, cell.x), std::max(layer->max_cell.y, cell.y)};
+  }
+
+  auto bucket_index = bucket_for(*layer, cell);
+  auto& bucket = layer->buckets[bucket_index];
+  auto result = bucket.emplaceBack(entry);
+
+  if (entry.id.index >= layer->slots.size()) {
+    layer->slots.resize(entry.id.index + 1);
+  }
+  layer->slots[entry.id.index] = Slot{bucket_index, static_cast<U32>(result.index())};
+
+  ++layer->count;
+}
+
+void SpatialGrid::remove_from_layer(Layer* layer, EntityId entity_id) {
+  auto& slot = layer->slots[entity_id.index];
+  DCHECK(slot.bucket != kInvalidBucket);
+
+  auto& bucket = layer->buckets[slot.bucket];
+  auto last_index = static_cast<U32>(bucket.size() - 1);
+  if (slot.index != last_index) {
+    bucket[slot.index] = bucket[last_index];
+    layer->slots[bucket[slot.index].id.index].index = slot.index;
+  }
+  bucket.resize(last_index);
+
+  slot = Slot{};
+  --layer->count;
+}
+
+void SpatialGrid::rehash_layer(Layer* layer, MemSize bucket_count) {
+  nu::DynamicArray<nu::DynamicArray<Entry>> old_buckets = std::move(layer->buckets);
+
+  layer->buckets.clear();
+  layer->buckets.resize(bucket_count);
+
+  for (auto& bucket : old_buckets) {
+    for (auto& entry : bucket) {
+      auto bucket_index = bucket_for(*layer, cell_for(entry.position));
+      auto result = layer->buckets[bucket_index].emplaceBack(entry);
+      layer->slots[entry.id.index] = Slot{bucket_index, static_cast<U32>(result.index())};
+    }
+  }
+}
+
+EntityId SpatialGrid::closest_in_layer(const Layer& layer, const fl::Vec2& position, F32 radius,
+                                       EntityFlags mask, EntityId excluding) const {
+  if (layer.count == 0) {
+    record_query(0);
+    return EntityId{};
+  }
+
+  F32 closest_distance = std::numeric_limits<F32>::max();
+  EntityId closest_id;
+  MemSize candidates = 0;
+
+  auto visit_bucket = [&](const nu::DynamicArray<Entry>& bucket) {
+    candidates += bucket.size();
+    for (const auto& entry : bucket) {
+      if (entry.id == excluding || !NU_BIT_IS_SET(entry.flags, mask)) {
+        continue;
+      }
+
+      auto distance = fl::distance(position, entry.position);
+      if (distance > radius) {
+        continue;
+      }
+
+      // Break ties on the id so that results do not depend on bucket order.
+      if (distance < closest_distance ||
+          (distance == closest_distance && entry.id.index > closest_id.index)) {
+        closest_distance = distance;
+        closest_id = entry.id;
+      }
+    }
+  };
+
+  auto center = cell_for(position);
+
+  // Rings beyond the occupied extent can not hold anything.
+  I32 max_ring = std::max(std::max(center.x - layer.min_cell.x, layer.max_cell.x - center.x),
+                          std::max(center.y - layer.min_cell.y, layer.max_cell.y - center.y));
+  if (radius < std::numeric_limits<F32>::max()) {
+    max_ring = std::min(max_ring, static_cast<I32>(std::ceil(radius * inverse_cell_size_)));
+  }
+
+  for (I32 ring = 0; ring <= max_ring; ++ring) {
+    // Once the square of rings covers more cells than there are buckets, finish with one pass over
+    // the whole table.
+    auto side = static_cast<U64>(ring) * 2 + 1;
+    if (side * side >= layer.buckets.size()) {
+      for (const auto& bucket : layer.buckets) {
+        visit_bucket(bucket);
+      }
+      record_query(candidates);
+      return closest_id;
+    }
+
+    if (ring == 0) {
+      visit_bucket(layer.buckets[bucket_for(layer, center)]);
+    } else {
+      for (I32 x = -ring; x <= ring; ++x) {
+        visit_bucket(layer.buckets[bucket_for(layer, {center.x + x, center.y - ring})]);
+        visit_bucket(layer.buckets[bucket_for(layer, {center.x + x, center.y + ring})]);
+      }
+      for (I32 y = -ring + 1; y <= ring - 1; ++y) {
+        visit_bucket(layer.buckets[bucket_for(layer, {center.x - ring, center.y + y})]);
+        visit_bucket(layer.buckets[bucket_for(layer, {center.x + ring, center.y + y})]);
+      }
+    }
+
+    // Everything outside the rings searched so far is at least `ring` cells away.
+    if (closest_distance < static_cast<F32>(ring) * cell_size_) {
+      break;
+    }
+  }
+
+  record_query(candidates);
+  return closest_id;
+}
+
+}  // namespace ad
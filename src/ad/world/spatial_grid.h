@@ -0,0 +1,246 @@
+#pragma once
+
+#include <nucleus/containers/dynamic_array.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "ad/world/entity.h"
+
+namespace ad {
+
+// Uniform grid over entity positions that answers nearest and radius queries by only looking at the
+// cells around the query position. Cells are hashed into a power-of-two bucket table, so the world
+// does not need fixed bounds.
+//
+// Each entity is stored once in the "all" layer and once more in a layer for every flag it carries.
+// A query for a rare flag (e.g. `ENTITY_FLAG_LINKABLE`) then only walks buckets holding linkable
+// entities, instead of cells packed with asteroids.
+class SpatialGrid {
+public:
+  explicit SpatialGrid(F32 cell_size = 10.0f);
+
+  NU_NO_DISCARD F32 cell_size() const {
+    return cell_size_;
+  }
+
+  void clear();
+
+  void insert(EntityId entity_id, const fl::Vec2& position, EntityFlags flags);
+  void update(EntityId entity_id, const fl::Vec2& position);
+  // Updates the position if the entity stays in the same cell and returns false otherwise, in
+  // which case `update` has to be called. It only touches the entity's own entries, so it may run
+  // concurrently for different entities.
+  bool update_in_place(EntityId entity_id, const fl::Vec2& position);
+  void remove(EntityId entity_id);
+
+  // Returns the entity closest to `position` that has all the flags in `mask`, ignoring
+  // `excluding`.
+  NU_NO_DISCARD EntityId closest(const fl::Vec2& position, EntityFlags mask,
+                                 EntityId excluding = EntityId{}) const;
+
+  // Same as `closest`, but only considers entities within `radius` of `position`.
+  NU_NO_DISCARD EntityId closest_within_radius(const fl::Vec2& position, F32 radius,
+                                               EntityFlags mask,
+                                               EntityId excluding = EntityId{}) const;
+
+  // Calls `func(EntityId, const fl::Vec2&)` for every entity within `radius` of `center` that has
+  // all the flags in `mask`.
+  template <typename Func>
+  void for_each_within_radius(const fl::Vec2& center, F32 radius, EntityFlags mask,
+                              Func&& func) const;
+
+  // Calls `func(EntityId, const fl::Vec2&)` for every entity in the cells that overlap the
+  // rectangle from `min` to `max`. Cells for which `accept_cell(cell_min, cell_max)` returns false
+  // are skipped with all the entities in them.
+  template <typename AcceptCell, typename Func>
+  void for_each_in_cells(const fl::Vec2& min, const fl::Vec2& max, AcceptCell&& accept_cell,
+                         Func&& func) const;
+
+private:
+  // Layer 0 holds every entity, layer `n + 1` holds the entities with flag bit `n` set.
+  static constexpr U32 kLayerCount = 33;
+  static constexpr U32 kInvalidBucket = std::numeric_limits<U32>::max();
+  static constexpr U32 kInitialBucketCount = 64;
+
+  struct Entry {
+    EntityId id;
+    fl::Vec2 position;
+    EntityFlags flags;
+  };
+
+  struct Slot {
+    U32 bucket = kInvalidBucket;
+    U32 index = 0;
+  };
+
+  struct Cell {
+    I32 x;
+    I32 y;
+
+    bool operator==(const Cell& other) const {
+      return x == other.x && y == other.y;
+    }
+  };
+
+  struct Layer {
+    nu::DynamicArray<nu::DynamicArray<Entry>> buckets;
+    // Where each entity lives in `buckets`, indexed by `EntityId::index`.
+    nu::DynamicArray<Slot> slots;
+    MemSize count = 0;
+
+    // Extent of all the cells that were ever occupied. It only grows, which keeps it a valid bound
+    // for terminating searches.
+    Cell min_cell = {0, 0};
+    Cell max_cell = {0, 0};
+  };
+
+  // Feeds the "spatial queries" and "spatial candidates" metrics.
+  static void record_query(MemSize candidates);
+
+  static U32 layer_for_mask(EntityFlags mask) {
+    return mask == 0 ? 0 : 1 + static_cast<U32>(std::countr_zero(mask));
+  }
+
+  Cell cell_for(const fl::Vec2& position) const {
+    return {static_cast<I32>(std::floor(position.x * inverse_cell_size_)),
+            static_cast<I32>(std::floor(position.y * inverse_cell_size_))};
+  }
+
+  static U32 bucket_for(const Layer& layer, const Cell& cell) {
+    auto hash = static_cast<U32>(cell.x) * 73856093u ^ static_cast<U32>(cell.y) * 19349663u;
+    return hash & static_cast<U32>(layer.buckets.size() - 1);
+  }
+
+  void insert_into_layer(Layer* layer, const Entry& entry);
+  void remove_from_layer(Layer* layer, EntityId entity_id);
+  void rehash_layer(Layer* layer, MemSize bucket_count);
+
+  EntityId closest_in_layer(const Layer& layer, const fl::Vec2& position, F32 radius,
+                            EntityFlags mask, EntityId excluding) const;
+
+  F32 cell_size_;
+  F32 inverse_cell_size_;
+
+  Layer layers_[kLayerCount];
+};
+
+template <typename Func>
+void SpatialGrid::for_each_within_radius(const fl::Vec2& center, F32 radius, EntityFlags mask,
+                                         Func&& func) const {
+  const auto& layer = layers_[layer_for_mask(mask)];
+  if (layer.count == 0) {
+    record_query(0);
+    return;
+  }
+
+  MemSize candidates = 0;
+  auto visit = [&](const Entry& entry) {
+    ++candidates;
+    if (NU_BIT_IS_SET(entry.flags, mask) && fl::distance(center, entry.position) <= radius) {
+      func(entry.id, entry.position);
+    }
+  };
+
+  auto min_cell = cell_for(center - fl::Vec2{radius, radius});
+  auto max_cell = cell_for(center + fl::Vec2{radius, radius});
+  min_cell = {std::max(min_cell.x, layer.min_cell.x), std::max(min_cell.y, layer.min_cell.y)};
+  max_cell = {std::min(max_cell.x, layer.max_cell.x), std::min(max_cell.y, layer.max_cell.y)};
+  if (min_cell.x > max_cell.x || min_cell.y > max_cell.y) {
+    record_query(0);
+    return;
+  }
+
+  auto cell_count = static_cast<U64>(max_cell.x - min_cell.x + 1) *
+                    static_cast<U64>(max_cell.y - min_cell.y + 1);
+
+  // When the query covers more cells than there are buckets, walking the whole table is cheaper
+  // and visits every entry exactly once.
+  if (cell_count >= layer.buckets.size()) {
+    for (const auto& bucket : layer.buckets) {
+      for (const auto& entry : bucket) {
+        visit(entry);
+      }
+    }
+    record_query(candidates);
+    return;
+  }
+
+  for (I32 y = min_cell.y; y <= max_cell.y; ++y) {
+    for (I32 x = min_cell.x; x <= max_cell.x; ++x) {
+      Cell cell{x, y};
+      for (const auto& entry : layer.buckets[bucket_for(layer, cell)]) {
+        // Buckets are shared by all the cells that hash into them, so only report the entries
+        // that really live in this cell, otherwise they would be visited more than once.
+        if (cell_for(entry.position) == cell) {
+          visit(entry);
+        }
+      }
+    }
+  }
+
+  record_query(candidates);
+}
+
+template <typename AcceptCell, typename Func>
+void SpatialGrid::for_each_in_cells(const fl::Vec2& min, const fl::Vec2& max,
+                                    AcceptCell&& accept_cell, Func&& func) const {
+  const auto& layer = layers_[0];
+
+  auto min_cell = cell_for(min);
+  auto max_cell = cell_for(max);
+  min_cell = {std::max(min_cell.x, layer.min_cell.x), std::max(min_cell.y, layer.min_cell.y)};
+  max_cell = {std::min(max_cell.x, layer.max_cell.x), std::min(max_cell.y, layer.max_cell.y)};
+  if (layer.count == 0 || min_cell.x > max_cell.x || min_cell.y > max_cell.y) {
+    record_query(0);
+    return;
+  }
+
+  MemSize candidates = 0;
+  auto cell_count = static_cast<U64>(max_cell.x - min_cell.x + 1) *
+                    static_cast<U64>(max_cell.y - min_cell.y + 1);
+
+  // As in `for_each_within_radius`, walk the whole table when that is cheaper. Cells can't be
+  // rejected as a whole then, so every entry inside the rectangle is reported.
+  if (cell_count >= layer.buckets.size()) {
+    for (const auto& bucket : layer.buckets) {
+      for (const auto& entry : bucket) {
+        auto cell = cell_for(entry.position);
+        if (cell.x >= min_cell.x && cell.x <= max_cell.x && cell.y >= min_cell.y &&
+            cell.y <= max_cell.y) {
+          ++candidates;
+          func(entry.id, entry.position);
+        }
+      }
+    }
+    record_query(candidates);
+    return;
+  }
+
+  for (I32 y = min_cell.y; y <= max_cell.y; ++y) {
+    for (I32 x = min_cell.x; x <= max_cell.x; ++x) {
+      Cell cell{x, y};
+      const auto& bucket = layer.buckets[bucket_for(layer, cell)];
+      if (bucket.isEmpty()) {
+        continue;
+      }
+
+      fl::Vec2 cell_min{static_cast<F32>(x) * cell_size_, static_cast<F32>(y) * cell_size_};
+      if (!accept_cell(cell_min, cell_min + fl::Vec2{cell_size_, cell_size_})) {
+        continue;
+      }
+
+      for (const auto& entry : bucket) {
+        if (cell_for(entry.position) == cell) {
+          ++candidates;
+          func(entry.id, entry.position);
+        }
+      }
+    }
+  }
+
+  record_query(candidates);
+}
+
+}  // namespace ad
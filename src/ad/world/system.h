@@ -0,0 +1,72 @@
+#pragma once
+
+#include <nucleus/containers/dynamic_array.h>
+#include <nucleus/types.h>
+
+#include "ad/world/entity.h"
+
+class Resources;
+
+namespace ad {
+
+class EntityList;
+class EntityPicker;
+class JobSystem;
+class Random;
+class SpatialGrid;
+
+// Data a system can read or write. The component bits match `ComponentMask`, the rest cover the
+// data that lives outside the entity columns.
+using AccessMask = U32;
+
+constexpr AccessMask ACCESS_MOVEMENT = COMPONENT_MOVEMENT;
+constexpr AccessMask ACCESS_BUILDING = COMPONENT_BUILDING;
+constexpr AccessMask ACCESS_ELECTRICITY = COMPONENT_ELECTRICITY;
+constexpr AccessMask ACCESS_MINING = COMPONENT_MINING;
+constexpr AccessMask ACCESS_RENDER = COMPONENT_RENDER;
+constexpr AccessMask ACCESS_POSITIONS = NU_BIT(8);
+constexpr AccessMask ACCESS_TARGETS = NU_BIT(9);
+constexpr AccessMask ACCESS_SPATIAL_INDEX = NU_BIT(10);
+constexpr AccessMask ACCESS_RESOURCES = NU_BIT(11);
+// The selectable entities under the cursor, which follow the entities that move.
+constexpr AccessMask ACCESS_ENTITY_PICKER = NU_BIT(12);
+
+struct SystemAccess {
+  AccessMask reads = 0;
+  AccessMask writes = 0;
+
+  // Two systems conflict if either writes something the other one touches.
+  NU_NO_DISCARD bool conflicts_with(const SystemAccess& other) const {
+    return (writes & (other.reads | other.writes)) != 0 || (other.writes & reads) != 0;
+  }
+};
+
+// Everything a system gets to work with during a tick.
+struct SystemContext {
+  EntityList* entities = nullptr;
+  SpatialGrid* spatial_grid = nullptr;
+  EntityPicker* entity_picker = nullptr;
+  Resources* resources = nullptr;
+  const Random* random = nullptr;
+  JobSystem* job_system = nullptr;
+  U64 tick_index = 0;
+  F32 delta = 0.0f;
+  // Entities whose timers fired this tick.
+  const nu::DynamicArray<EntityId>* due_mining_cycles = nullptr;
+  const nu::DynamicArray<EntityId>* due_reheadings = nullptr;
+};
+
+class System {
+public:
+  virtual ~System() = default;
+
+  NU_NO_DISCARD virtual const char* name() const = 0;
+
+  // Must cover everything `tick` touches, otherwise the scheduler might run it alongside a system
+  // it races with.
+  NU_NO_DISCARD virtual SystemAccess access() const = 0;
+
+  virtual void tick(const SystemContext& context) = 0;
+};
+
+}  // namespace ad
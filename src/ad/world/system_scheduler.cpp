@@ -0,0 +1,105 @@
+#include "ad/world/system_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "ad/jobs/job_system.h"
+#include "ad/profiling/profiler.h"
+
+namespace ad {
+
+void SystemScheduler::add_system(std::unique_ptr<System> system) {
+  auto index = nodes_.size();
+  auto access = system->access();
+
+  auto& node = nodes_.emplaceBack().element();
+  node.system = std::move(system);
+
+  // A system depends on every earlier system it conflicts with. Edges only point backwards, so the
+  // graph can not have cycles and registration order is a valid serial order.
+  for (MemSize i = 0; i < index; ++i) {
+    if (nodes_[i].system->access().conflicts_with(access)) {
+      nodes_[index].dependencies.emplaceBack(i);
+      nodes_[i].dependents.emplaceBack(index);
+    }
+  }
+}
+
+void SystemScheduler::tick(const SystemContext& context) {
+  auto count = nodes_.size();
+
+  pending_dependencies_.resize(count);
+  finish_ms_.resize(count);
+  ready_.clear();
+
+  for (MemSize i = 0; i < count; ++i) {
+    pending_dependencies_[i] = nodes_[i].dependencies.size();
+    if (pending_dependencies_[i] == 0) {
+      ready_.emplaceBack(i);
+    }
+  }
+
+  // Run the graph in waves: every system whose dependencies are done runs concurrently with the
+  // others in its wave.
+  while (!ready_.isEmpty()) {
+    if (context.job_system && ready_.size() > 1) {
+      context.job_system->parallel_for(ready_.size(), 1, [&](MemSize begin, MemSize end, U32) {
+        for (MemSize i = begin; i < end; ++i) {
+          run_system(ready_[i], context);
+        }
+      });
+    } else {
+      for (auto index : ready_) {
+        run_system(index, context);
+      }
+    }
+
+    next_ready_.clear();
+    for (auto index : ready_) {
+      for (auto dependent : nodes_[index].dependents) {
+        if (--pending_dependencies_[dependent] == 0) {
+          next_ready_.emplaceBack(dependent);
+        }
+      }
+    }
+
+    std::swap(ready_, next_ready_);
+  }
+
+  // Nodes are in a valid serial order, so every dependency's finish time is known by the time it
+  // is needed.
+  critical_path_ms_ = 0.0;
+  total_work_ms_ = 0.0;
+  for (MemSize i = 0; i < count; ++i) {
+    F64 start_ms = 0.0;
+    for (auto dependency : nodes_[i].dependencies) {
+      start_ms = std::max(start_ms, finish_ms_[dependency]);
+    }
+
+    finish_ms_[i] = start_ms + nodes_[i].duration_ms;
+    critical_path_ms_ = std::max(critical_path_ms_, finish_ms_[i]);
+    total_work_ms_ += nodes_[i].duration_ms;
+    nodes_[i].frame_duration_ms += nodes_[i].duration_ms;
+  }
+  frame_critical_path_ms_ += critical_path_ms_;
+}
+
+void SystemScheduler::begin_frame() {
+  for (auto& node : nodes_) {
+    node.frame_duration_ms = 0.0;
+  }
+  frame_critical_path_ms_ = 0.0;
+}
+
+void SystemScheduler::run_system(MemSize index, const SystemContext& context) {
+  auto& node = nodes_[index];
+  AD_PROFILE_ZONE(node.system->name())
+
+  auto start = std::chrono::steady_clock::now();
+  node.system->tick(context);
+  std::chrono::duration<F64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+  node.duration_ms = elapsed.count();
+}
+
+}  // namespace ad
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <nucleus/containers/dynamic_array.h>
+
+#include <memory>
+
+#include "ad/world/system.h"
+
+namespace ad {
+
+// Runs the registered systems every tick. Systems that conflict (see `SystemAccess`) run in the
+// order they were added; everything else runs concurrently on the context's job system.
+class SystemScheduler {
+public:
+  // Constructs a system from `args` and returns it, for callers that want to keep a typed pointer.
+  template <typename T, typename... Args>
+  T* add(Args&&... args) {
+    auto system = std::make_unique<T>(std::forward<Args>(args)...);
+    T* result = system.get();
+    add_system(std::move(system));
+    return result;
+  }
+
+  void tick(const SystemContext& context);
+
+  // Starts a new frame for the `frame_*` timings. A frame can run any number of ticks.
+  void begin_frame();
+
+  NU_NO_DISCARD MemSize system_count() const {
+    return nodes_.size();
+  }
+
+  NU_NO_DISCARD const char* system_name(MemSize index) const {
+    return nodes_[index].system->name();
+  }
+
+  // How long the system took during the last tick.
+  NU_NO_DISCARD F64 system_duration_ms(MemSize index) const {
+    return nodes_[index].duration_ms;
+  }
+
+  // How long the system took over all ticks since `begin_frame`.
+  NU_NO_DISCARD F64 system_frame_duration_ms(MemSize index) const {
+    return nodes_[index].frame_duration_ms;
+  }
+
+  // Indices of the systems that have to finish before the system at `index` may start.
+  NU_NO_DISCARD const nu::DynamicArray<MemSize>& dependencies(MemSize index) const {
+    return nodes_[index].dependencies;
+  }
+
+  // Length of the longest chain of dependent systems during the last tick. With enough threads,
+  // this is how long the tick takes.
+  NU_NO_DISCARD F64 critical_path_ms() const {
+    return critical_path_ms_;
+  }
+
+  // Sum of the critical paths of all ticks since `begin_frame`.
+  NU_NO_DISCARD F64 frame_critical_path_ms() const {
+    return frame_critical_path_ms_;
+  }
+
+  // Sum of all system durations during the last tick.
+  NU_NO_DISCARD F64 total_work_ms() const {
+    return total_work_ms_;
+  }
+
+private:
+  struct Node {
+    std::unique_ptr<System> system;
+    nu::DynamicArray<MemSize> dependencies;
+    nu::DynamicArray<MemSize> dependents;
+    F64 duration_ms = 0.0;
+    F64 frame_duration_ms = 0.0;
+  };
+
+  void add_system(std::unique_ptr<System> system);
+  void run_system(MemSize index, const SystemContext& context);
+
+  nu::DynamicArray<Node> nodes_;
+
+  // Scratch space for `tick`.
+  nu::DynamicArray<MemSize> pending_dependencies_;
+  nu::DynamicArray<F64> finish_ms_;
+  nu::DynamicArray<MemSize> ready_;
+  nu::DynamicArray<MemSize> next_ready_;
+
+  F64 critical_path_ms_ = 0.0;
+  F64 total_work_ms_ = 0.0;
+  F64 frame_critical_path_ms_ = 0.0;
+};
+
+}  // namespace ad
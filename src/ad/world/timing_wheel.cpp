@@ -0,0 +1,151 @@
+#include "ad/world/timing_wheel.h"
+
+#include <algorithm>
+
+namespace ad {
+
+TimingWheel::TimingWheel() {
+  std::fill(std::begin(slots_), std::end(slots_), kInvalidIndex);
+}
+
+TimingWheel::Handle TimingWheel::schedule(U64 due_tick, EntityId entity_id, U32 kind) {
+  U32 index;
+  if (free_head_ != kInvalidIndex) {
+    index = free_head_;
+    free_head_ = nodes_[index].next;
+  } else {
+    index = static_cast<U32>(nodes_.size());
+    nodes_.emplaceBack(Node{});
+  }
+
+  auto& node = nodes_[index];
+  node.timer = {entity_id, kind, due_tick};
+  link(index);
+
+  ++size_;
+
+  return {index, node.generation};
+}
+
+bool TimingWheel::cancel(Handle handle) {
+  if (!is_scheduled(handle)) {
+    return false;
+  }
+
+  unlink(handle.index);
+  release(handle.index);
+
+  return true;
+}
+
+bool TimingWheel::is_scheduled(Handle handle) const {
+  return handle.index < nodes_.size() && nodes_[handle.index].generation == handle.generation &&
+         nodes_[handle.index].slot != kInvalidIndex;
+}
+
+void TimingWheel::advance(U64 tick, nu::DynamicArray<Timer>* expired) {
+  for (; current_tick_ <= tick; ++current_tick_) {
+    // When a level wraps around, the next slot of the level above is due to be spread out over the
+    // levels below it. Higher levels go first, so their timers can keep moving down.
+    if ((current_tick_ & kSlotMask) == 0) {
+      U32 top = 1;
+      while (top + 1 < kLevelCount &&
+             ((current_tick_ >> (kLevelBits * top)) & kSlotMask) == 0) {
+        ++top;
+      }
+      for (U32 level = top; level >= 1; --level) {
+        cascade(level);
+      }
+    }
+
+    auto& head = slots_[current_tick_ & kSlotMask];
+    while (head != kInvalidIndex) {
+      auto index = head;
+      unlink(index);
+      expired->emplaceBack(nodes_[index].timer);
+      release(index);
+    }
+  }
+}
+
+void TimingWheel::clear(U64 tick) {
+  for (U32 index = 0; index < nodes_.size(); ++index) {
+    if (nodes_[index].slot != kInvalidIndex) {
+      unlink(index);
+      release(index);
+    }
+  }
+
+  current_tick_ = tick;
+}
+
+U32 TimingWheel::slot_for(U64 due_tick) const {
+  // Late timers go into the slot that is processed next.
+  if (due_tick < current_tick_) {
+    due_tick = current_tick_;
+  }
+
+  auto delta = due_tick - current_tick_;
+  for (U32 level = 0; level < kLevelCount; ++level) {
+    if (delta < (U64{1} << (kLevelBits * (level + 1)))) {
+      return level * kSlotsPerLevel + ((due_tick >> (kLevelBits * level)) & kSlotMask);
+    }
+  }
+
+  // Further out than the wheel reaches. Park the timer in the last slot the top level visits
+  // before wrapping around; it is put back in when that slot cascades.
+  auto top_shift = kLevelBits * (kLevelCount - 1);
+  return (kLevelCount - 1) * kSlotsPerLevel + (((current_tick_ >> top_shift) - 1) & kSlotMask);
+}
+
+void TimingWheel::link(U32 index) {
+  auto& node = nodes_[index];
+  node.slot = slot_for(node.timer.due_tick);
+  node.previous = kInvalidIndex;
+  node.next = slots_[node.slot];
+
+  if (node.next != kInvalidIndex) {
+    nodes_[node.next].previous = index;
+  }
+  slots_[node.slot] = index;
+}
+
+void TimingWheel::unlink(U32 index) {
+  auto& node = nodes_[index];
+
+  if (node.previous != kInvalidIndex) {
+    nodes_[node.previous].next = node.next;
+  } else {
+    slots_[node.slot] = node.next;
+  }
+
+  if (node.next != kInvalidIndex) {
+    nodes_[node.next].previous = node.previous;
+  }
+}
+
+void TimingWheel::release(U32 index) {
+  auto& node = nodes_[index];
+  node.slot = kInvalidIndex;
+  node.previous = kInvalidIndex;
+  node.next = free_head_;
+  ++node.generation;
+  free_head_ = index;
+
+  --size_;
+}
+
+void TimingWheel::cascade(U32 level) {
+  auto slot = level * kSlotsPerLevel + ((current_tick_ >> (kLevelBits * level)) & kSlotMask);
+
+  auto index = slots_[slot];
+  slots_[slot] = kInvalidIndex;
+
+  while (index != kInvalidIndex) {
+    auto next = nodes_[index].next;
+    link(index);
+    index = next;
+  }
+}
+
+}  // namespace ad
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <nucleus/containers/dynamic_array.h>
+
+#include "ad/world/entity.h"
+#include "ad/world/entity_caches.h"
+
+namespace ad {
+
+// Hierarchical timing wheel over tick indices. Four levels of 256 slots cover 2^32 ticks; a timer
+// goes into the coarsest level it needs and moves down a level every time the wheel below it
+// wraps around. Scheduling and cancelling are O(1), and advancing only touches timers that are
+// due or that move down a level.
+class TimingWheel {
+public:
+  using Handle = TimerHandle;
+
+  struct Timer {
+    EntityId entity_id;
+    U32 kind = 0;
+    U64 due_tick = 0;
+  };
+
+  TimingWheel();
+
+  // The next tick `advance` will process.
+  NU_NO_DISCARD U64 current_tick() const {
+    return current_tick_;
+  }
+
+  NU_NO_DISCARD MemSize size() const {
+    return size_;
+  }
+
+  // Schedules a timer for `due_tick`. Timers due before `current_tick` fire on the next `advance`.
+  Handle schedule(U64 due_tick, EntityId entity_id, U32 kind);
+
+  // Returns false if the timer already fired or was cancelled.
+  bool cancel(Handle handle);
+
+  NU_NO_DISCARD bool is_scheduled(Handle handle) const;
+
+  // Tick the timer is due on; only valid while it is scheduled.
+  NU_NO_DISCARD U64 due_tick(Handle handle) const {
+    DCHECK(is_scheduled(handle));
+    return nodes_[handle.index].timer.due_tick;
+  }
+
+  // Processes every tick up to and including `tick` and appends the timers that fired to
+  // `expired`, tick by tick.
+  void advance(U64 tick, nu::DynamicArray<Timer>* expired);
+
+  // Drops every timer and starts over at `tick`.
+  void clear(U64 tick = 0);
+
+private:
+  static constexpr U32 kInvalidIndex = std::numeric_limits<U32>::max();
+  static constexpr U32 kLevelBits = 8;
+  static constexpr U32 kSlotsPerLevel = 1 << kLevelBits;
+  static constexpr U32 kSlotMask = kSlotsPerLevel - 1;
+  static constexpr U32 kLevelCount = 4;
+
+  struct Node {
+    Timer timer;
+    U32 generation = 0;
+    // Slot the node is linked into, or `kInvalidIndex` while it is free. While free, `next` links
+    // to the next free node.
+    U32 slot = kInvalidIndex;
+    U32 previous = kInvalidIndex;
+    U32 next = kInvalidIndex;
+  };
+
+  U32 slot_for(U64 due_tick) const;
+  void link(U32 index);
+  void unlink(U32 index);
+  void release(U32 index);
+  void cascade(U32 level);
+
+  nu::DynamicArray<Node> nodes_;
+  U32 free_head_ = kInvalidIndex;
+
+  // Head node of every slot, level by level.
+  U32 slots_[kLevelCount * kSlotsPerLevel];
+
+  U64 current_tick_ = 0;
+  MemSize size_ = 0;
+};
+
+}  // namespace ad
@@ -0,0 +1,80 @@
+#include "ad/world/transform_kernel.h"
+
+#if AD_TRANSFORM_KERNEL_AVX || AD_TRANSFORM_KERNEL_SSE2
+#include <immintrin.h>
+#endif
+
+namespace ad {
+
+// The kernels treat a matrix as 16 packed floats, column by column.
+static_assert(sizeof(fl::Mat4) == 16 * sizeof(F32));
+
+void multiply_transforms_scalar(const fl::Mat4& lhs, const fl::Mat4* rhs, fl::Mat4* out,
+                                MemSize count) {
+  const auto* l = reinterpret_cast<const F32*>(&lhs);
+
+  for (MemSize m = 0; m < count; ++m) {
+    const auto* r = reinterpret_cast<const F32*>(rhs + m);
+    auto* o = reinterpret_cast<F32*>(out + m);
+
+    for (U32 column = 0; column < 4; ++column) {
+      for (U32 row = 0; row < 4; ++row) {
+        o[column * 4 + row] = l[row] * r[column * 4] + l[4 + row] * r[column * 4 + 1] +
+                              l[8 + row] * r[column * 4 + 2] + l[12 + row] * r[column * 4 + 3];
+      }
+    }
+  }
+}
+
+void multiply_transforms(const fl::Mat4& lhs, const fl::Mat4* rhs, fl::Mat4* out,
+                         MemSize count) {
+#if AD_TRANSFORM_KERNEL_AVX
+  // Every column of the result is the columns of `lhs` weighted by one column of `rhs`. Two
+  // columns are done at once, with the columns of `lhs` repeated in both halves.
+  const auto* l = reinterpret_cast<const F32*>(&lhs);
+  auto l0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l));
+  auto l1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 4));
+  auto l2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 8));
+  auto l3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 12));
+
+  for (MemSize m = 0; m < count; ++m) {
+    const auto* r = reinterpret_cast<const F32*>(rhs + m);
+    auto* o = reinterpret_cast<F32*>(out + m);
+
+    for (U32 column = 0; column < 4; column += 2) {
+      // {r0 r1 r2 r3 | r4 r5 r6 r7}, then every element spread over its half.
+      auto columns = _mm256_loadu_ps(r + column * 4);
+      auto result = _mm256_mul_ps(l0, _mm256_permute_ps(columns, 0x00));
+      result = _mm256_add_ps(result, _mm256_mul_ps(l1, _mm256_permute_ps(columns, 0x55)));
+      result = _mm256_add_ps(result, _mm256_mul_ps(l2, _mm256_permute_ps(columns, 0xAA)));
+      result = _mm256_add_ps(result, _mm256_mul_ps(l3, _mm256_permute_ps(columns, 0xFF)));
+      _mm256_storeu_ps(o + column * 4, result);
+    }
+  }
+#elif AD_TRANSFORM_KERNEL_SSE2
+  // Every column of the result is the columns of `lhs` weighted by one column of `rhs`.
+  const auto* l = reinterpret_cast<const F32*>(&lhs);
+  auto l0 = _mm_loadu_ps(l);
+  auto l1 = _mm_loadu_ps(l + 4);
+  auto l2 = _mm_loadu_ps(l + 8);
+  auto l3 = _mm_loadu_ps(l + 12);
+
+  for (MemSize m = 0; m < count; ++m) {
+    const auto* r = reinterpret_cast<const F32*>(rhs + m);
+    auto* o = reinterpret_cast<F32*>(out + m);
+
+    for (U32 column = 0; column < 4; ++column) {
+      const auto* c = r + column * 4;
+      auto result = _mm_mul_ps(l0, _mm_set1_ps(c[0]));
+      result = _mm_add_ps(result, _mm_mul_ps(l1, _mm_set1_ps(c[1])));
+      result = _mm_add_ps(result, _mm_mul_ps(l2, _mm_set1_ps(c[2])));
+      result = _mm_add_ps(result, _mm_mul_ps(l3, _mm_set1_ps(c[3])));
+      _mm_storeu_ps(o + column * 4, result);
+    }
+  }
+#else
+  multiply_transforms_scalar(lhs, rhs, out, count);
+#endif
+}
+
+}  // namespace ad
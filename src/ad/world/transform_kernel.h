@@ -0,0 +1,25 @@
+#pragma once
+
+#include <floats/mat4.h>
+#include <nucleus/types.h>
+
+#if defined(__AVX__)
+#define AD_TRANSFORM_KERNEL_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AD_TRANSFORM_KERNEL_SSE2 1
+#endif
+
+namespace ad {
+
+// Multiplies `count` matrices by the same matrix on the left:
+//
+//   out[i] = lhs * rhs[i]
+//
+// Matrices are 16 column-major floats. Uses AVX or SSE2 when the target supports it and falls back
+// to `multiply_transforms_scalar` otherwise. `out` may not overlap `rhs`.
+void multiply_transforms(const fl::Mat4& lhs, const fl::Mat4* rhs, fl::Mat4* out, MemSize count);
+
+void multiply_transforms_scalar(const fl::Mat4& lhs, const fl::Mat4* rhs, fl::Mat4* out,
+                                MemSize count);
+
+}  // namespace ad
@@ -1,59 +1,378 @@
 #include "ad/world/world.h"
 
 #include <canvas/utils/immediate_shapes.h>
-#include <nucleus/profiling.h>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "ad/profiling/profiler.h"
+#include "ad/world/Systems/movement_system.h"
+#include "ad/world/Systems/resource_system.h"
 #include "ad/world/construction_controller.h"
 
 namespace ad {
 
-World::World() = default;
+namespace {
+
+fl::Vec2 interpolate(const fl::Vec2& from, const fl::Vec2& to, F32 alpha) {
+  return from + (to - from) * alpha;
+}
+
+// Turns along the shorter arc, so headings that wrap around don't spin the long way.
+fl::Angle interpolate(fl::Angle from, fl::Angle to, F32 alpha) {
+  constexpr F32 kPi = 3.14159265358979f;
+  auto difference = std::remainder(to.radians() - from.radians(), 2.0f * kPi);
+  return fl::Angle::fromRadians(from.radians() + difference * alpha);
+}
+
+// Radius around the entity's position that everything drawn for it fits in.
+F32 cull_radius(const EntityRef& entity) {
+  F32 radius = 0.0f;
+  if (entity.has(COMPONENT_RENDER)) {
+    radius = std::max(radius, entity.render().bounding_radius);
+  }
+  if (entity.has(COMPONENT_BUILDING)) {
+    radius = std::max(radius, entity.building().selection_radius);
+  }
+  return radius;
+}
+
+// Links and lasers are stretched models about this wide.
+constexpr F32 kSegmentHalfWidth = 0.5f;
+
+bool is_segment_visible(const Frustum& frustum, const fl::Vec2& from, const fl::Vec2& to) {
+  return frustum.intersects_box(
+      {std::min(from.x, to.x) - kSegmentHalfWidth, std::min(from.y, to.y) - kSegmentHalfWidth,
+       -kSegmentHalfWidth},
+      {std::max(from.x, to.x) + kSegmentHalfWidth, std::max(from.y, to.y) + kSegmentHalfWidth,
+       kSegmentHalfWidth});
+}
+
+// Stretches a model that is one unit long along y from `from` to `to`.
+fl::Mat4 stretched_transform(const fl::Vec2& from, const fl::Vec2& to) {
+  auto distance_to_linked = fl::distance(from, to);
+  auto angle = fl::arcTangent2(to.x - from.x, to.y - from.y);
+
+  fl::Mat4 model = fl::Mat4::identity;
+  model = model * fl::translation_matrix({from, 0.0f});
+  model = model * fl::rotation_matrix(fl::Vec3::forward, fl::Angle::fromRadians(angle));
+  model = model * fl::scale_matrix({1.0f, distance_to_linked, 1.0f});
+  return model;
+}
+
+// Appends the vertices of `mesh` to `batch`, placed with `transform`, a `stretched_transform` that
+// scales by `length` along y. Normals only take the rotation, with the stretch undone.
+void append_stretched(MeshData* batch, const MeshData& mesh, const fl::Mat4& transform,
+                      F32 length) {
+  auto inverse_length_squared = 1.0f / (length * length);
+  for (const auto& vertex : mesh.vertices) {
+    auto position = transform * fl::Vec4{vertex.position, 1.0f};
+    auto normal = transform * fl::Vec4{vertex.normal.x, vertex.normal.y * inverse_length_squared,
+                                       vertex.normal.z, 0.0f};
+    auto normal_length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+    if (normal_length > 0.0f) {
+      normal = fl::Vec4{normal.x / normal_length, normal.y / normal_length,
+                        normal.z / normal_length, 0.0f};
+    }
+    batch->vertices.emplaceBack(MeshVertex{{position.x, position.y, position.z},
+                                           {normal.x, normal.y, normal.z},
+                                           vertex.tex_coord});
+  }
+}
+
+// `stretched_transform`, reusing `cache` while both ends stay where they were.
+const fl::Mat4& stretched_transform(SegmentTransform* cache, const fl::Vec2& from,
+                                    const fl::Vec2& to) {
+  if (!cache->is_valid || cache->from != from || cache->to != to) {
+    cache->from = from;
+    cache->to = to;
+    cache->transform = stretched_transform(from, to);
+    cache->is_valid = true;
+  }
+  return cache->transform;
+}
 
-bool World::initialize(le::ResourceManager* resource_manager) {
-  link_model_ = resource_manager->get_render_model("link.obj");
+// The model matrix for `position` and `direction`, reusing `cache` while neither changed. Only
+// moving entities ever need a new one.
+const fl::Mat4& model_transform(ModelTransform* cache, const fl::Vec2& position,
+                                fl::Angle direction) {
+  if (!cache->is_valid || cache->position != position ||
+      cache->direction != direction.radians()) {
+    auto translation = fl::translation_matrix(fl::Vec3{position, 0.0f});
+    auto rotation = fl::rotation_matrix(fl::Vec3{0.0f, 0.0f, 1.0f}, direction);
+    cache->position = position;
+    cache->direction = direction.radians();
+    cache->transform = fl::create_model_matrix(translation, rotation, fl::Mat4::identity);
+    cache->is_valid = true;
+  }
+  return cache->transform;
+}
+
+// `transform * scale_matrix({scale, scale, 1})`, without the full multiply.
+fl::Mat4 scale_xy(const fl::Mat4& transform, F32 scale) {
+  auto result = transform;
+  const auto& x = transform.col[0];
+  const auto& y = transform.col[1];
+  result.col[0] = {x.x * scale, x.y * scale, x.z * scale, x.w * scale};
+  result.col[1] = {y.x * scale, y.y * scale, y.z * scale, y.w * scale};
+  return result;
+}
+
+// Normalized device depth of a point on the ground, 0 at the near plane and 1 at the far plane.
+F32 depth_of(const fl::Mat4& projection_and_view, const fl::Vec2& position) {
+  auto clip = projection_and_view * fl::Vec4{position.x, position.y, 0.0f, 1.0f};
+  return clip.w != 0.0f ? clip.z / clip.w * 0.5f + 0.5f : 0.0f;
+}
+
+// How many pixels `radius` around `position` covers on a viewport `viewport_height` pixels high.
+F32 screen_radius(const fl::Mat4& projection_and_view, const fl::Vec2& position, F32 radius,
+                  F32 viewport_height) {
+  auto center = projection_and_view * fl::Vec4{position.x, position.y, 0.0f, 1.0f};
+  auto edge = projection_and_view * fl::Vec4{position.x, position.y + radius, 0.0f, 1.0f};
+  if (center.w <= 0.0f || edge.w <= 0.0f) {
+    return 0.0f;
+  }
+
+  auto dx = edge.x / edge.w - center.x / center.w;
+  auto dy = edge.y / edge.w - center.y / center.w;
+  return std::sqrt(dx * dx + dy * dy) * 0.5f * viewport_height;
+}
+
+// Ring models matching `kCircleLodSegments`.
+constexpr const char* kCircleTemplateNames[] = {"selection_ring_16.obj", "selection_ring_32.obj",
+                                                "selection_ring_64.obj"};
+static_assert(std::size(kCircleTemplateNames) == kCircleLodCount);
+
+// Rows of an archetype handed to a thread at a time while building the draw list.
+constexpr MemSize kDrawListGrainSize = 4096;
+
+// Buildings within this distance of a building being placed show their selection circles.
+constexpr F32 kConstructionRingRadius = 15.0f;
+
+// Number of ticks of `delta` it takes to cover `remaining`, at least one.
+U64 ticks_to_cover(F32 remaining, F32 delta) {
+  auto ticks = std::ceil(remaining / delta);
+  return ticks < 1.0f ? 1 : static_cast<U64>(ticks);
+}
+
+}  // namespace
+
+World::World() {
+  systems_.add<ResourceSystem>();
+  systems_.add<MovementSystem>();
+}
+
+void World::request_models(AssetLoader* loader) {
+  link_model_handle_ = loader->request("link.obj", true);
+  miner_laser_model_handle_ = loader->request("miner_laser.obj");
+  for (U32 lod = 0; lod < kCircleLodCount; ++lod) {
+    circle_template_handles_[lod] = loader->request(kCircleTemplateNames[lod]);
+  }
+}
+
+bool World::initialize(const AssetLoader& loader) {
+  link_model_ = loader.model(link_model_handle_);
   if (!link_model_) {
     return false;
   }
 
-  miner_laser_model_ = resource_manager->get_render_model("miner_laser.obj");
+  auto* link_mesh = loader.mesh(link_model_handle_);
+  if (link_mesh) {
+    MeshData mesh;
+    link_mesh->copy_to(&mesh);
+    set_link_mesh(std::move(mesh));
+  }
+
+  miner_laser_model_ = loader.model(miner_laser_model_handle_);
   if (!miner_laser_model_) {
     return false;
   }
 
+  for (U32 lod = 0; lod < kCircleLodCount; ++lod) {
+    circle_templates_[lod] = loader.model(circle_template_handles_[lod]);
+    if (!circle_templates_[lod]) {
+      return false;
+    }
+  }
+
+  link_batch_dirty_ = true;
+
   return true;
 }
 
 void World::clear() {
   entities_.clear();
+  spatial_grid_.clear();
+  entity_picker_.clear();
+  power_network_.clear();
+  resources_.set_electricity(0);
+  timing_wheel_.clear();
+  pending_timers_.clear();
+  tick_count_ = 0;
+  max_cull_radius_ = 0.0f;
+  model_uses_.clear();
+  link_batch_dirty_ = true;
 }
 
 EntityId World::add_entity_from_prefab(Entity* prefab, const fl::Vec2& position) {
-  auto result = entities_.emplaceBack(*prefab);
-
-  auto& entity = result.element();
-  auto entity_id = EntityId{result.index()};
+  // Spawn the entity at its position, so that it doesn't interpolate in from the prefab's.
+  Entity instance = *prefab;
+  instance.position = position;
 
-  entity.id = entity_id;
+  auto entity_id = entities_.add(instance);
+  auto entity = entities_.get(entity_id);
 
-  if (entity.type == EntityType::CommandCenter) {
+  if (entity.type() == EntityType::CommandCenter) {
     command_center_id_ = entity_id;
   }
 
-  entity.position = position;
+  spatial_grid_.insert(entity_id, position, entity.flags());
+  max_cull_radius_ = std::max(max_cull_radius_, cull_radius(entity));
+
+  if (entity.has(COMPONENT_RENDER)) {
+    add_model_use(entity.render().model, 1);
+  }
+
+  if (entity.has(COMPONENT_BUILDING) && entity.building().selection_radius > 0.0f) {
+    entity_picker_.insert(entity_id, position, entity.building().selection_radius);
+  }
+
+  if (entity.has(COMPONENT_BUILDING)) {
+    link_batch_dirty_ = true;
+  }
 
   // If this entity requires a link, then find a suitable link.
   if (entity.has_flags(ENTITY_FLAG_NEEDS_LINK)) {
-    entity.building.linked_to_id = find_closest_to(entity_id, ENTITY_FLAG_LINKABLE);
+    entity.building().linked_to_id = find_closest_to(entity_id, ENTITY_FLAG_LINKABLE);
+  }
+
+  auto electricity_delta =
+      entity.has(COMPONENT_ELECTRICITY) ? entity.electricity().electricity_delta : 0;
+  if (entity.has(COMPONENT_ELECTRICITY) ||
+      (entity.flags() & (ENTITY_FLAG_NEEDS_LINK | ENTITY_FLAG_LINKABLE)) != 0) {
+    power_network_.add(entity_id, electricity_delta);
+    if (entity.has(COMPONENT_BUILDING) && entity.building().linked_to_id.is_valid()) {
+      power_network_.link(entity_id, entity.building().linked_to_id);
+    }
+    update_electricity();
   }
 
-  if (entity.type == EntityType::Miner) {
+  if (entity.type() == EntityType::Miner) {
     // Select an asteroid target for the miner.
-    entity.target = find_miner_target(entity_id);
+    entity.target() = find_miner_target(entity_id);
+  }
+
+  // Timers are scheduled on the next tick, once the tick delta is known.
+  if (entity.has(COMPONENT_MINING) || entity.has(COMPONENT_MOVEMENT)) {
+    pending_timers_.emplaceBack(entity_id);
   }
 
   return entity_id;
 }
 
+bool World::destroy_entity(EntityId entity_id) {
+  if (!entities_.is_alive(entity_id)) {
+    return false;
+  }
+
+  auto entity = entities_.get(entity_id);
+  if (entity.has(COMPONENT_MINING)) {
+    timing_wheel_.cancel(entity.mining_timer());
+  }
+  if (entity.has(COMPONENT_MOVEMENT)) {
+    timing_wheel_.cancel(entity.reheading_timer());
+  }
+
+  // Links to or from the entity disappear with it.
+  if (entity.has(COMPONENT_BUILDING) || entity.has_flags(ENTITY_FLAG_LINKABLE)) {
+    link_batch_dirty_ = true;
+  }
+
+  if (entity.has(COMPONENT_RENDER)) {
+    add_model_use(entity.render().model, -1);
+  }
+
+  spatial_grid_.remove(entity_id);
+  entity_picker_.remove(entity_id);
+  power_network_.remove(entity_id);
+  entities_.destroy(entity_id);
+
+  // Other entities might still hold the handle in `target` or `building.linked_to_id`. Those are
+  // checked with `is_alive` where they are used.
+
+  if (selected_entity_id_ == entity_id) {
+    selected_entity_id_ = EntityId{};
+  }
+
+  if (command_center_id_ == entity_id) {
+    command_center_id_ = EntityId{};
+  }
+
+  update_electricity();
+
+  return true;
+}
+
+void World::add_known_models(DrawList* draw_list) const {
+  draw_list->add_known_model(nullptr);
+  draw_list->add_known_model(link_model_);
+  draw_list->add_known_model(link_batch_model_);
+  draw_list->add_known_model(miner_laser_model_);
+  for (auto* circle_template : circle_templates_) {
+    draw_list->add_known_model(circle_template);
+  }
+  for (const auto& use : model_uses_) {
+    draw_list->add_known_model(use.model);
+  }
+}
+
+U32 World::model_use_count(const le::RenderModel* model) const {
+  for (const auto& use : model_uses_) {
+    if (use.model == model) {
+      return use.count;
+    }
+  }
+  return 0;
+}
+
+void World::add_model_use(le::RenderModel* model, I32 delta) {
+  for (MemSize i = 0; i < model_uses_.size(); ++i) {
+    auto& use = model_uses_[i];
+    if (use.model != model) {
+      continue;
+    }
+
+    use.count = static_cast<U32>(static_cast<I32>(use.count) + delta);
+
+    // An unloaded model's address can be reused by the next model that is loaded, which must not
+    // start out with the old model's uses.
+    if (use.count == 0) {
+      use = model_uses_[model_uses_.size() - 1];
+      model_uses_.resize(model_uses_.size() - 1);
+    }
+    return;
+  }
+
+  DCHECK(delta > 0);
+  model_uses_.emplaceBack(ModelUse{model, static_cast<U32>(delta)});
+}
+
+void World::set_electricity_delta(EntityId entity_id, I32 electricity_delta) {
+  auto entity = entities_.get(entity_id);
+  DCHECK(entity.has(COMPONENT_ELECTRICITY));
+
+  entity.electricity().electricity_delta = electricity_delta;
+  power_network_.set_electricity_delta(entity_id, electricity_delta);
+  update_electricity();
+}
+
+void World::update_electricity() {
+  // Only the network the command center is in counts, buildings elsewhere are not powered.
+  auto network = power_network_.stats(command_center_id_);
+  resources_.set_electricity(network.supply - network.demand);
+}
+
 void World::set_cursor_position(const fl::Vec2& position) {
   cursor_position_ = position;
 
@@ -61,32 +380,154 @@ void World::set_cursor_position(const fl::Vec2& position) {
 }
 
 EntityId World::get_entity_under_cursor() const {
-  // This is not a system right now, because the proper solution is probably not to go through each
-  // entity to check.
+  // Kept up to date by `set_cursor_position`.
+  return selected_entity_id_;
+}
+
+void World::tick(F32 delta) {
+  AD_PROFILE_ZONE("world tick")
+
+  if (delta != last_delta_ && timing_wheel_.size() > 0) {
+    reschedule_timers(delta);
+  }
+  schedule_pending_timers(delta);
+  dispatch_timers(delta);
+
+  SystemContext context;
+  context.entities = &entities_;
+  context.spatial_grid = &spatial_grid_;
+  context.entity_picker = &entity_picker_;
+  context.resources = &resources_;
+  context.random = &random_;
+  context.job_system = job_system_;
+  context.tick_index = tick_count_;
+  context.delta = delta;
+  context.due_mining_cycles = &due_mining_cycles_;
+  context.due_reheadings = &due_reheadings_;
+
+  systems_.tick(context);
+
+  last_delta_ = delta;
+  ++tick_count_;
+}
 
-  MemSize id = 0;
-  for (const auto& entity : entities_) {
-    if (entity.building.selection_radius == 0.0f) {
+void World::schedule_pending_timers(F32 delta) {
+  for (auto entity_id : pending_timers_) {
+    if (!entities_.is_alive(entity_id)) {
       continue;
     }
 
-    F32 distance_to_cursor = fl::length(entity.position - cursor_position_);
-    if (distance_to_cursor < entity.building.selection_radius) {
-      return EntityId{id};
+    auto entity = entities_.get(entity_id);
+    if (entity.has(COMPONENT_MINING)) {
+      entity.mining_timer() = schedule_mining_cycle(entity, tick_count_, delta);
+    }
+    if (entity.has(COMPONENT_MOVEMENT)) {
+      entity.reheading_timer() =
+          schedule_reheading(entity, tick_count_, entity.distance_travelled(), delta);
     }
-    ++id;
   }
+  pending_timers_.clear();
+}
+
+void World::reschedule_timers(F32 delta) {
+  AD_PROFILE_DETAIL_ZONE("reschedule timers")
+
+  entities_.for_each_archetype(COMPONENT_MINING, [&](Archetype& archetype) {
+    for (MemSize i = 0; i < archetype.size(); ++i) {
+      auto& timer = archetype.mining_timers[i];
+      if (!timing_wheel_.is_scheduled(timer)) {
+        continue;
+      }
+
+      // Until the timer fires, `time_since_last_cycle` holds the time it will overshoot the end
+      // of the cycle by.
+      auto& mining = archetype.mining[i];
+      auto ticks_left = timing_wheel_.due_tick(timer) + 1 - tick_count_;
+      mining.time_since_last_cycle +=
+          mining.cycle_duration - static_cast<F32>(ticks_left) * last_delta_;
+
+      timing_wheel_.cancel(timer);
+      timer = schedule_mining_cycle(entities_.get(archetype.ids[i]), tick_count_, delta);
+    }
+  });
+
+  entities_.for_each_archetype(COMPONENT_MOVEMENT, [&](Archetype& archetype) {
+    for (MemSize i = 0; i < archetype.size(); ++i) {
+      auto& timer = archetype.reheading_timers[i];
+      if (!timing_wheel_.is_scheduled(timer)) {
+        continue;
+      }
 
-  return EntityId{};
+      timing_wheel_.cancel(timer);
+      timer = schedule_reheading(entities_.get(archetype.ids[i]), tick_count_,
+                                 archetype.distances_travelled[i], delta);
+    }
+  });
 }
 
-void World::tick(F32 delta) {
-  resource_system_.tick(entities_, delta);
-  movement_system_.tick(entities_, delta);
+void World::dispatch_timers(F32 delta) {
+  expired_timers_.clear();
+  timing_wheel_.advance(tick_count_, &expired_timers_);
+
+  due_mining_cycles_.clear();
+  due_reheadings_.clear();
+
+  // Timers are cancelled when their entity is destroyed, so every entity here is alive.
+  for (const auto& timer : expired_timers_) {
+    auto entity = entities_.get(timer.entity_id);
+    switch (timer.kind) {
+      case TIMER_MINING_CYCLE:
+        // Miners on the power network only mine while their network is powered. The timer keeps
+        // running, so mining resumes on the cycle after power comes back.
+        if (!power_network_.contains(timer.entity_id) || is_powered(timer.entity_id)) {
+          due_mining_cycles_.emplaceBack(timer.entity_id);
+        }
+        entity.mining_timer() = schedule_mining_cycle(entity, tick_count_ + 1, delta);
+        break;
+
+      case TIMER_REHEADING:
+        // The movement system resets the distance when it picks the new heading.
+        due_reheadings_.emplaceBack(timer.entity_id);
+        entity.reheading_timer() = schedule_reheading(entity, tick_count_ + 1, 0.0f, delta);
+        break;
+
+      default:
+        DCHECK(false);
+        break;
+    }
+  }
+}
+
+TimingWheel::Handle World::schedule_mining_cycle(const EntityRef& entity, U64 from_tick,
+                                                 F32 delta) {
+  auto& mining = entity.mining();
+  auto ticks = ticks_to_cover(mining.cycle_duration - mining.time_since_last_cycle, delta);
+
+  // Carry the time past the end of the cycle over into the next one, as counting down every tick
+  // would.
+  mining.time_since_last_cycle += static_cast<F32>(ticks) * delta - mining.cycle_duration;
+
+  return timing_wheel_.schedule(from_tick + ticks - 1, entity.id(), TIMER_MINING_CYCLE);
+}
+
+TimingWheel::Handle World::schedule_reheading(const EntityRef& entity, U64 from_tick,
+                                              F32 distance_travelled, F32 delta) {
+  auto step = entity.speed() * (kSpeedScale * delta);
+  if (step <= 0.0f) {
+    return {};
+  }
+
+  // The heading changes on the first tick that takes the entity past the reheading distance.
+  auto remaining = MovementSystem::kReheadingDistance - distance_travelled;
+  auto ticks = remaining < 0.0f ? U64{1} : static_cast<U64>(std::floor(remaining / step)) + 1;
+
+  return timing_wheel_.schedule(from_tick + ticks - 1, entity.id(), TIMER_REHEADING);
 }
 
 void World::render(ca::Renderer* renderer, le::Camera* camera,
-                   ConstructionController* construction_controller) {
+                   ConstructionController* construction_controller, F32 alpha) {
+  AD_PROFILE_ZONE("world render")
+
   fl::Mat4 projection = fl::Mat4::identity;
   camera->updateProjectionMatrix(&projection);
 
@@ -95,154 +536,394 @@ void World::render(ca::Renderer* renderer, le::Camera* camera,
 
   auto projection_and_view = projection * view;
 
-  // Render the entities.
+  build_draw_list(projection_and_view, construction_controller, alpha, &draw_list_);
+  submit_draw_list(renderer, projection_and_view, &draw_list_);
+}
 
-  renderer->state().depth_test(true);
+void World::build_draw_list(const fl::Mat4& projection_and_view,
+                            ConstructionController* construction_controller, F32 alpha,
+                            DrawList* draw_list) {
+  AD_PROFILE_DETAIL_ZONE("build draw list")
 
-  ca::ImmediateRenderer immediate{renderer};
+  draw_list->clear();
+  add_known_models(draw_list);
 
-  for (unsigned i = 0; i < entities_.size(); ++i) {
-    PROFILE("item")
+  Frustum frustum{projection_and_view};
+  find_visible_entities(frustum, &visible_entities_);
+  while (render_flags_.size() < entities_.slot_count()) {
+    render_flags_.emplaceBack(U8{0});
+  }
+  for (auto entity_id : visible_entities_) {
+    render_flags_[entity_id.index] = kVisible;
+  }
 
-    const auto& entity = entities_[i];
+  // While placing a building, the circles of the buildings around it show.
+  bool is_constructing = construction_controller && construction_controller->is_building();
+  if (is_constructing) {
+    spatial_grid_.for_each_within_radius(
+        cursor_position_, kConstructionRingRadius, 0, [&](EntityId entity_id, const fl::Vec2&) {
+          render_flags_[entity_id.index] |= kInConstructionRange;
+        });
+  }
 
-    auto translation = fl::translation_matrix(fl::Vec3{entity.position, 0.0f});
-    auto rotation = fl::rotation_matrix(fl::Vec3{0.0f, 0.0f, 1.0f}, entity.movement.direction);
+  // Worked out from how many ticks are left until the cycle ends.
+  auto time_since_last_cycle = [&](const Entity::Mining& mining, TimingWheel::Handle timer) {
+    if (!timing_wheel_.is_scheduled(timer)) {
+      return mining.time_since_last_cycle;
+    }
+    auto ticks_left = timing_wheel_.due_tick(timer) + 1 - tick_count_;
+    return mining.cycle_duration - static_cast<F32>(ticks_left) * last_delta_;
+  };
+
+  auto add_segment = [&](DrawList* commands, DrawKind kind, le::RenderModel* model,
+                         const fl::Vec2& from, const fl::Vec2& to, const fl::Mat4& transform) {
+    if (model && is_segment_visible(frustum, from, to)) {
+      commands->add_model(kind, model, transform, depth_of(projection_and_view, from));
+    }
+  };
 
-    auto mvp =
-        projection_and_view * fl::create_model_matrix(translation, rotation, fl::Mat4::identity);
+  // Links are culled by their own bounds, they can be in view while neither building is.
 
-    // Draw the entity circle.
+  if (link_batch_dirty_) {
+    rebuild_link_batch();
+  }
 
-    // TODO: set projection_and_view
-    if (entity.building.selection_radius > 0.0f) {
-      auto color = ca::Color::red;
-      if (EntityId{i} == selected_entity_id_) {
-        color = ca::Color::green;
-      }
-      ca::draw_circle(&immediate, mvp, fl::Vec3::zero, entity.building.selection_radius,
-                      static_cast<I32>(entity.building.selection_radius / 0.1f), color);
+  if (link_batch_model_) {
+    if (is_segment_visible(frustum, link_batch_min_, link_batch_max_)) {
+      auto center = (link_batch_min_ + link_batch_max_) * 0.5f;
+      draw_list->add_model(DrawKind::Link, link_batch_model_, fl::Mat4::identity,
+                           depth_of(projection_and_view, center));
+    }
+  } else {
+    for (const auto& link : static_links_) {
+      add_segment(draw_list, DrawKind::Link, link_model_, link.from, link.to, link.transform);
     }
+  }
 
-    // Draw entity model.
-    le::renderModel(renderer, *entity.render.model, mvp);
+  for (auto entity_id : moving_links_) {
+    auto entity = entities_.get(entity_id);
+    if (!entities_.is_alive(entity.building().linked_to_id)) {
+      continue;
+    }
+    auto from = entity.position();
+    auto to = entities_.get(entity.building().linked_to_id).position();
+    add_segment(draw_list, DrawKind::Link, link_model_, from, to,
+                stretched_transform(&entity.link_transform(), from, to));
+  }
 
-    // Draw the entity's link.
-    {
-      if (entity.building.linked_to_id.is_valid()) {
-        auto& linked_to = entities_[entity.building.linked_to_id.id];
+  // Entities are spread over the job system. Every thread adds to a list of its own, and only
+  // reads shared state apart from the caches in the rows it was handed.
+  thread_draw_lists_.resize(job_system_ ? job_system_->thread_count() : 1);
+  for (auto& commands : thread_draw_lists_) {
+    commands.clear();
+    add_known_models(&commands);
+  }
 
-        render_stretched_obj(renderer, projection_and_view, entity.position, linked_to.position,
-                             link_model_);
-      }
+  for (auto& archetype : entities_.archetypes()) {
+    if (!archetype.has(COMPONENT_RENDER)) {
+      continue;
     }
 
-    // Draw a miner's laser.
-    if (entity.type == EntityType::Miner && entity.target.is_valid() &&
-        entity.mining.time_since_last_cycle < entity.mining.cycle_duration * 0.75f) {
-      const auto& target = entities_[entity.target.id];
-      render_stretched_obj(renderer, projection_and_view, entity.position, target.position,
-                           miner_laser_model_);
+    bool has_movement = archetype.has(COMPONENT_MOVEMENT);
+    bool has_building = archetype.has(COMPONENT_BUILDING);
+    bool has_mining = archetype.has(COMPONENT_MINING);
+
+    auto add_rows = [&](MemSize begin, MemSize end, U32 thread_index) {
+      AD_PROFILE_DETAIL_ZONE("draw list batch")
+
+      auto* commands = &thread_draw_lists_[thread_index];
+      for (MemSize i = begin; i < end; ++i) {
+        auto position = archetype.positions[i];
+        auto direction = fl::Angle::zero;
+        if (has_movement) {
+          position = interpolate(archetype.previous_positions[i], position, alpha);
+          direction = interpolate(archetype.previous_directions[i], archetype.directions[i], alpha);
+        }
+
+        // A miner's laser is on for the first three quarters of every cycle. Like links, it is
+        // culled by its own bounds.
+        if (has_mining && archetype.types[i] == EntityType::Miner &&
+            entities_.is_alive(archetype.targets[i]) &&
+            time_since_last_cycle(archetype.mining[i], archetype.mining_timers[i]) <
+                archetype.mining[i].cycle_duration * 0.75f) {
+          auto target = entities_.get(archetype.targets[i]).position();
+          add_segment(commands, DrawKind::Laser, miner_laser_model_, position, target,
+                      stretched_transform(&archetype.laser_transforms[i], position, target));
+        }
+
+        auto flags = render_flags_[archetype.ids[i].index];
+        if (!(flags & kVisible)) {
+          continue;
+        }
+
+        const auto& transform =
+            model_transform(&archetype.model_transforms[i], position, direction);
+        auto depth = depth_of(projection_and_view, position);
+
+        // Only the circles that need to stand out are generated; the rest are drawn from the ring
+        // templates.
+        if (has_building && archetype.building[i].selection_radius > 0.0f) {
+          auto radius = archetype.building[i].selection_radius;
+          auto lod =
+              circle_lod(screen_radius(projection_and_view, position, radius, viewport_height_));
+          bool is_hovered = archetype.ids[i] == selected_entity_id_;
+          if (is_hovered || (flags & kInConstructionRange)) {
+            commands->add_circle(transform, radius, kCircleLodSegments[lod], is_hovered, depth);
+          } else if (circle_templates_[lod]) {
+            commands->add_model(DrawKind::SelectionCircle, circle_templates_[lod],
+                                scale_xy(transform, radius), depth);
+          }
+        }
+
+        if (archetype.render[i].model) {
+          commands->add_model(DrawKind::Entity, archetype.render[i].model, transform, depth);
+        }
+      }
+    };
+    parallel_for(job_system_, archetype.size(), kDrawListGrainSize, add_rows);
+  }
+
+  {
+    AD_PROFILE_DETAIL_ZONE("merge draw lists")
+    for (const auto& commands : thread_draw_lists_) {
+      draw_list->append(commands);
     }
   }
 
-  // Render the construction prefab:
-  if (construction_controller->is_building()) {
+  for (auto entity_id : visible_entities_) {
+    render_flags_[entity_id.index] = 0;
+  }
+  if (is_constructing) {
+    spatial_grid_.for_each_within_radius(
+        cursor_position_, kConstructionRingRadius, 0,
+        [&](EntityId entity_id, const fl::Vec2&) { render_flags_[entity_id.index] = 0; });
+  }
+
+  // The construction prefab under the cursor, with the link and laser it would get.
+  if (is_constructing) {
     Entity* prefab = construction_controller->prefab();
     DCHECK(prefab);
 
-    auto model = fl::translation_matrix(fl::Vec3{cursor_position_, 0.0f});
-    auto mvp = projection_and_view * model;
-
-    le::renderModel(renderer, *prefab->render.model, mvp);
-
-    {
-      // Render a link to the closest entity.
-      auto linkable = entities_ | std::views::filter([](const Entity& entity) {
-                        return entity.has_flags(ENTITY_FLAG_LINKABLE);
-                      });
-      auto closest_id = closest(linkable, cursor_position_);
+    if (prefab->render.model) {
+      draw_list->add_model(DrawKind::Entity, prefab->render.model,
+                           fl::translation_matrix(fl::Vec3{cursor_position_, 0.0f}),
+                           depth_of(projection_and_view, cursor_position_));
+    }
 
-      if (closest_id.is_valid()) {
-        const auto& closest = entities_[closest_id.id];
-        render_stretched_obj(renderer, projection_and_view, cursor_position_, closest.position,
-                             link_model_);
-      }
+    // These follow the cursor, so there is nothing to cache.
+    auto closest_id = find_closest_to(cursor_position_, ENTITY_FLAG_LINKABLE);
+    if (closest_id.is_valid()) {
+      auto to = entities_.get(closest_id).position();
+      add_segment(draw_list, DrawKind::Link, link_model_, cursor_position_, to,
+                  stretched_transform(cursor_position_, to));
     }
 
-    // If we are rendering a miner, then find a target and render a mining laser.
     if (prefab->type == EntityType::Miner) {
-      // Render a link to the closest entity.
-      auto closest_id = find_miner_target(cursor_position_);
-      if (closest_id.is_valid()) {
-        const auto& closest = entities_[closest_id.id];
-        render_stretched_obj(renderer, projection_and_view, cursor_position_, closest.position,
-                             miner_laser_model_);
+      auto target_id = find_miner_target(cursor_position_);
+      if (target_id.is_valid()) {
+        auto to = entities_.get(target_id).position();
+        add_segment(draw_list, DrawKind::Laser, miner_laser_model_, cursor_position_, to,
+                    stretched_transform(cursor_position_, to));
       }
     }
   }
+}
+
+void World::submit_draw_list(ca::Renderer* renderer, const fl::Mat4& projection_and_view,
+                             DrawList* draw_list) {
+  AD_PROFILE_DETAIL_ZONE("submit draw list")
+
+  draw_list->sort();
+
+  renderer->state().depth_test(true);
+
+  // Selection circles sort last. The generated ones go through the immediate renderer in one go.
+  ca::ImmediateRenderer immediate{renderer};
+
+  // The renderer has no instanced path, so a batch is still drawn one command at a time, but
+  // without switching models in between.
+  draw_list->compute_mvps(projection_and_view);
+
+  draw_list->for_each_batch([&](const DrawCommand* commands, const fl::Mat4* mvps, MemSize count) {
+    for (MemSize i = 0; i < count; ++i) {
+      const auto& command = commands[i];
+      const auto& mvp = mvps[i];
+      if (command.kind == DrawKind::SelectionCircle && !command.model) {
+        auto color = command.highlighted ? ca::Color::green : ca::Color::red;
+        ca::draw_circle(&immediate, mvp, fl::Vec3::zero, command.radius,
+                        static_cast<I32>(command.segments), color);
+      } else {
+        DCHECK(command.model);
+        le::renderModel(renderer, *command.model, mvp);
+      }
+    }
+  });
 
   immediate.submit_to_renderer();
 }
 
-void World::update_selected_entity() {
-  for (unsigned i = 0; i < entities_.size(); ++i) {
-    const auto& entity = entities_[i];
+void World::find_visible_entities(const fl::Mat4& projection_and_view,
+                                  nu::DynamicArray<EntityId>* visible) {
+  find_visible_entities(Frustum{projection_and_view}, visible);
+}
 
-    if (entity.building.selection_radius <= 0.0f) {
-      continue;
-    }
+void World::find_visible_entities(const Frustum& frustum, nu::DynamicArray<EntityId>* visible) {
+  AD_PROFILE_DETAIL_ZONE("cull")
+
+  visible->clear();
+
+  // Entities lie in the z = 0 plane, so only the part of the view within reach of it matters.
+  auto reach = max_cull_radius_;
+  fl::Vec2 min;
+  fl::Vec2 max;
+  if (!frustum.ground_bounds(reach, &min, &max)) {
+    return;
+  }
+
+  auto margin = fl::Vec2{reach, reach};
+  auto accept_cell = [&](const fl::Vec2& cell_min, const fl::Vec2& cell_max) {
+    return frustum.intersects_box({cell_min - margin, -reach}, {cell_max + margin, reach});
+  };
+
+  spatial_grid_.for_each_in_cells(
+      min - margin, max + margin, accept_cell, [&](EntityId entity_id, const fl::Vec2& position) {
+        auto entity = entities_.get(entity_id);
+        if (frustum.intersects_sphere({position, 0.0f}, cull_radius(entity))) {
+          visible->emplaceBack(entity_id);
+        }
+      });
+}
+
+void World::rebuild_link_batch() {
+  AD_PROFILE_DETAIL_ZONE("rebuild link batch")
+
+  static_links_.clear();
+  moving_links_.clear();
+
+  entities_.for_each_archetype(COMPONENT_BUILDING | COMPONENT_RENDER, [&](Archetype& archetype) {
+    for (MemSize i = 0; i < archetype.size(); ++i) {
+      auto linked_to_id = archetype.building[i].linked_to_id;
+      if (!entities_.is_alive(linked_to_id)) {
+        continue;
+      }
 
-    auto distance_to_cursor = fl::distance(entity.position, cursor_position_);
-    if (distance_to_cursor < entity.building.selection_radius) {
-      selected_entity_id_ = EntityId{i};
-      return;
+      auto linked_to = entities_.get(linked_to_id);
+      if (archetype.has(COMPONENT_MOVEMENT) || linked_to.has(COMPONENT_MOVEMENT)) {
+        moving_links_.emplaceBack(archetype.ids[i]);
+        continue;
+      }
+
+      auto from = archetype.positions[i];
+      auto to = linked_to.position();
+      static_links_.emplaceBack(StaticLink{from, to, stretched_transform(from, to)});
     }
+  });
+
+  upload_link_batch();
+
+  link_batch_dirty_ = false;
+  ++link_batch_rebuilds_;
+}
+
+void World::clear_link_batch_uploader() {
+  if (link_batch_model_) {
+    release_link_batch_(link_batch_model_);
+    link_batch_model_ = nullptr;
   }
 
-  selected_entity_id_ = EntityId{};
+  upload_link_batch_ = {};
+  release_link_batch_ = {};
+  has_link_batch_uploader_ = false;
+  link_batch_dirty_ = true;
 }
 
-void World::render_stretched_obj(ca::Renderer* renderer, const fl::Mat4& projection_and_view,
-                                 const fl::Vec2& from, const fl::Vec2& to,
-                                 le::RenderModel* render_model) const {
-  auto distance_to_linked = fl::distance(from, to);
-  auto angle = fl::arcTangent2(to.x - from.x, to.y - from.y);
+void World::upload_link_batch() {
+  if (link_batch_model_) {
+    release_link_batch_(link_batch_model_);
+    link_batch_model_ = nullptr;
+  }
 
-  fl::Mat4 model = fl::Mat4::identity;
-  model = model * fl::translation_matrix({from, 0.0f});
-  model = model * fl::rotation_matrix(fl::Vec3::forward, fl::Angle::fromRadians(angle));
-  model = model * fl::scale_matrix({1.0f, distance_to_linked, 1.0f});
+  if (!has_link_batch_uploader_ || link_mesh_.vertices.size() == 0 || static_links_.size() == 0) {
+    return;
+  }
 
-  le::renderModel(renderer, *render_model, projection_and_view * model);
+  link_batch_mesh_.vertices.clear();
+  link_batch_mesh_.indices.clear();
+  link_batch_mesh_.materials.clear();
+  link_batch_mesh_.material_library = link_mesh_.material_library;
+  link_batch_mesh_.vertices.reserve(static_links_.size() * link_mesh_.vertices.size());
+  link_batch_mesh_.indices.reserve(static_links_.size() * link_mesh_.indices.size());
+  nu::DynamicArray<U32> first_vertices;
+
+  link_batch_min_ = static_links_[0].from;
+  link_batch_max_ = static_links_[0].from;
+  for (const auto& link : static_links_) {
+    link_batch_min_ = {std::min({link_batch_min_.x, link.from.x, link.to.x}),
+                       std::min({link_batch_min_.y, link.from.y, link.to.y})};
+    link_batch_max_ = {std::max({link_batch_max_.x, link.from.x, link.to.x}),
+                       std::max({link_batch_max_.y, link.from.y, link.to.y})};
+
+    // A link between buildings in the same place has nothing to draw.
+    auto length = fl::distance(link.from, link.to);
+    if (length > 0.0f) {
+      first_vertices.emplaceBack(static_cast<U32>(link_batch_mesh_.vertices.size()));
+      append_stretched(&link_batch_mesh_, link_mesh_, link.transform, length);
+    }
+  }
+
+  // The indices of all links go material by material, so that every material of the link mesh is
+  // still a single range of the batch.
+  auto append_indices = [&](U32 first_index, U32 index_count) {
+    for (auto first_vertex : first_vertices) {
+      for (U32 i = first_index; i < first_index + index_count; ++i) {
+        link_batch_mesh_.indices.emplaceBack(first_vertex + link_mesh_.indices[i]);
+      }
+    }
+  };
+  if (link_mesh_.materials.size() == 0) {
+    append_indices(0, static_cast<U32>(link_mesh_.indices.size()));
+  }
+  for (const auto& material : link_mesh_.materials) {
+    MeshMaterial batch_material = material;
+    batch_material.first_index = static_cast<U32>(link_batch_mesh_.indices.size());
+    append_indices(material.first_index, material.index_count);
+    batch_material.index_count =
+        static_cast<U32>(link_batch_mesh_.indices.size()) - batch_material.first_index;
+    link_batch_mesh_.materials.emplaceBack(batch_material);
+  }
+
+  // Without a model the links are drawn one by one, as without an uploader.
+  link_batch_model_ = upload_link_batch_(link_batch_mesh_);
+  if (!link_batch_model_) {
+    LOG(Warning) << "Could not upload the batch of " << static_links_.size() << " links.";
+  }
+}
+
+void World::update_selected_entity() {
+  selected_entity_id_ = entity_picker_.pick(cursor_position_);
 }
 
 EntityId World::find_closest_to(EntityId entity_id, U32 mask) {
   DCHECK(entity_id.is_valid());
-  auto& miner = entities_[entity_id.id];
+  auto entity = entities_.get(entity_id);
 
-  auto all = entities_ | excluding_id(entity_id) | matching_mask(mask);
-  return closest(all, miner.position);
+  return spatial_grid_.closest(entity.position(), mask, entity_id);
 }
 
 EntityId World::find_closest_to(const fl::Vec2& position, U32 mask) {
-  auto is_minable = entities_ | matching_mask(mask);
-
-  return closest(is_minable, position);
+  return spatial_grid_.closest(position, mask);
 }
 
 EntityId World::find_miner_target(EntityId miner_id) {
   DCHECK(miner_id.is_valid());
-  auto& miner = entities_[miner_id.id];
+  auto miner = entities_.get(miner_id);
 
-  return closest(entities_ | excluding_id(miner_id) | matching_mask(ENTITY_FLAG_MINABLE) |
-                     within_radius(miner.position, 10.0f),
-                 miner.position);
+  return spatial_grid_.closest_within_radius(miner.position(), 10.0f, ENTITY_FLAG_MINABLE,
+                                             miner_id);
 }
 
 EntityId World::find_miner_target(const fl::Vec2& position) {
-  return closest(entities_ | matching_mask(ENTITY_FLAG_MINABLE) | within_radius(position, 10.0f),
-                 position);
+  return spatial_grid_.closest_within_radius(position, 10.0f, ENTITY_FLAG_MINABLE);
 }
 
 }  // namespace ad
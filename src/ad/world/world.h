@@ -2,13 +2,24 @@
 
 #include <legion/world/camera.h>
 #include <nucleus/containers/dynamic_array.h>
+#include <nucleus/function.h>
 #include <nucleus/macros.h>
 
-#include "ad/world/Systems/movement_system.h"
-#include "ad/world/Systems/resource_system.h"
+#include <utility>
+
+#include "ad/assets/asset_loader.h"
+#include "ad/jobs/job_system.h"
+#include "ad/world/draw_list.h"
 #include "ad/world/entity.h"
 #include "ad/world/entity_list.hpp"
+#include "ad/world/entity_picker.h"
+#include "ad/world/frustum.h"
+#include "ad/world/power_network.h"
+#include "ad/world/random.h"
 #include "ad/world/resources.h"
+#include "ad/world/spatial_grid.h"
+#include "ad/world/system_scheduler.h"
+#include "ad/world/timing_wheel.h"
 
 namespace ca {
 class Renderer;
@@ -36,10 +47,110 @@ public:
     return entities_;
   }
 
-  bool initialize(le::ResourceManager* resource_manager);
+  // All randomness in the simulation comes from here, so the same seed gives the same world.
+  NU_NO_DISCARD const Random& random() const {
+    return random_;
+  }
+
+  void set_seed(U64 seed) {
+    random_.set_seed(seed);
+  }
+
+  NU_NO_DISCARD U64 tick_count() const {
+    return tick_count_;
+  }
+
+  // Systems split their work over `job_system`. Without one, everything runs on the calling thread.
+  // The results are the same either way.
+  void set_job_system(JobSystem* job_system) {
+    job_system_ = job_system;
+  }
+
+  // The systems that run every tick. Add more to extend the simulation; they are scheduled by what
+  // they read and write.
+  SystemScheduler& systems() {
+    return systems_;
+  }
+
+  // Queues the link, laser and selection ring models on `loader`.
+  void request_models(AssetLoader* loader);
+  // Takes the models queued by `request_models` once `loader` has uploaded them, and the link mesh
+  // that the batch of static links is built from.
+  bool initialize(const AssetLoader& loader);
+
+  // Makes a model from a mesh built by the world, or releases one made earlier. Both are only
+  // called from `build_draw_list`.
+  using MeshUploadFunc = nu::Function<le::RenderModel*(const MeshData& mesh)>;
+  using ModelReleaseFunc = nu::Function<void(le::RenderModel* model)>;
+
+  // Static links are merged into a single mesh, made into a model with `upload` whenever the links
+  // change, so that all of them take one draw. `release` is handed the model that is replaced.
+  // Without these, or without a link mesh, every link is drawn on its own.
+  void set_link_batch_uploader(MeshUploadFunc&& upload, ModelReleaseFunc&& release) {
+    clear_link_batch_uploader();
+    upload_link_batch_ = std::move(upload);
+    release_link_batch_ = std::move(release);
+    has_link_batch_uploader_ = true;
+  }
+
+  // Releases the batch model and drops the uploader. Call it before whatever the uploader refers
+  // to goes away, the world can outlive it.
+  void clear_link_batch_uploader();
+
+  // The geometry of the link model, one unit long along y.
+  void set_link_mesh(MeshData&& link_mesh) {
+    link_mesh_ = std::move(link_mesh);
+    link_batch_dirty_ = true;
+  }
+
+  // Models stretched between linked buildings and from miners to their targets.
+  void set_segment_models(le::RenderModel* link_model, le::RenderModel* miner_laser_model) {
+    link_model_ = link_model;
+    miner_laser_model_ = miner_laser_model;
+  }
+
+  // Unit rings drawn, scaled, for the selection circles that need no color of their own, one per
+  // level of detail in `kCircleLodSegments`. Those circles are skipped while a template is not
+  // set.
+  void set_circle_template(U32 lod, le::RenderModel* ring_model) {
+    DCHECK(lod < kCircleLodCount);
+    circle_templates_[lod] = ring_model;
+  }
+
+  // Height of the viewport in pixels, used to pick the detail of selection circles.
+  void set_viewport_height(F32 viewport_height) {
+    viewport_height_ = viewport_height;
+  }
+
+  // How often the batch of static links was rebuilt. Only changes to the links cause a rebuild.
+  NU_NO_DISCARD U64 link_batch_rebuilds() const {
+    return link_batch_rebuilds_;
+  }
 
   void clear();
   EntityId add_entity_from_prefab(Entity* prefab, const fl::Vec2& position);
+  bool destroy_entity(EntityId entity_id);
+
+  NU_NO_DISCARD bool is_alive(EntityId entity_id) const {
+    return entities_.is_alive(entity_id);
+  }
+
+  // How many entities are drawn with `model`. A model must stay loaded while this is not zero.
+  NU_NO_DISCARD U32 model_use_count(const le::RenderModel* model) const;
+
+  // Buildings that produce or use electricity, or take part in links, grouped by what they are
+  // linked to.
+  PowerNetwork& power_network() {
+    return power_network_;
+  }
+
+  NU_NO_DISCARD bool is_powered(EntityId entity_id) {
+    return power_network_.is_powered(entity_id);
+  }
+
+  // Changes how much electricity an entity produces or uses. Go through here instead of writing
+  // the component, so that the electricity resource stays correct.
+  void set_electricity_delta(EntityId entity_id, I32 electricity_delta);
 
   void set_cursor_position(const fl::Vec2& position);
   NU_NO_DISCARD EntityId get_entity_under_cursor() const;
@@ -48,16 +159,67 @@ public:
     return selected_entity_id_;
   }
 
+  // Replaces `visible` with the entities whose bounds are in view of `projection_and_view`. Only
+  // the grid cells that overlap the view are visited.
+  void find_visible_entities(const fl::Mat4& projection_and_view,
+                             nu::DynamicArray<EntityId>* visible);
+
   void tick(F32 delta);
+  // `alpha` is how far the frame is between the previous tick and the last one; moving entities
+  // are drawn between their states of those two ticks.
   void render(ca::Renderer* renderer, le::Camera* camera,
-              ConstructionController* construction_controller);
+              ConstructionController* construction_controller, F32 alpha = 1.0f);
+
+  // The first half of `render`: collects what is in view of `projection_and_view` into
+  // `draw_list` without touching the renderer. `construction_controller` may be null.
+  void build_draw_list(const fl::Mat4& projection_and_view,
+                       ConstructionController* construction_controller, F32 alpha,
+                       DrawList* draw_list);
 
 private:
+  enum TimerKind : U32 {
+    TIMER_MINING_CYCLE,
+    TIMER_REHEADING,
+  };
+
+  // Sets the electricity resource to the surplus of the command center's network.
+  void update_electricity();
+
+  // Timers count ticks, so when the tick delta changes every scheduled timer is moved to the
+  // tick that matches the time it has left.
+  void reschedule_timers(F32 delta);
+  // Schedules the timers of the entities added since the last tick.
+  void schedule_pending_timers(F32 delta);
+  // Collects the timers that are due this tick into the `due_*` lists and schedules their next
+  // firing.
+  void dispatch_timers(F32 delta);
+
+  // Schedules the end of the miner's current cycle, counting ticks from `from_tick`.
+  TimingWheel::Handle schedule_mining_cycle(const EntityRef& entity, U64 from_tick, F32 delta);
+  // Schedules the tick on which the entity has travelled past the reheading distance, having
+  // travelled `distance_travelled` at `from_tick`.
+  TimingWheel::Handle schedule_reheading(const EntityRef& entity, U64 from_tick,
+                                         F32 distance_travelled, F32 delta);
+
+  void find_visible_entities(const Frustum& frustum, nu::DynamicArray<EntityId>* visible);
+
+  // Numbers every model the world draws in `draw_list` in a fixed order: circles, links, lasers,
+  // ring templates, then entity models in the order they were first spawned.
+  void add_known_models(DrawList* draw_list) const;
+
+  void add_model_use(le::RenderModel* model, I32 delta);
+
+  // Collects the links between buildings that can't move into `static_links_`, and the buildings
+  // whose link has a moving end into `moving_links_`, then merges the static ones into
+  // `link_batch_model_` if there is an uploader.
+  void rebuild_link_batch();
+  void upload_link_batch();
+
   void update_selected_entity();
 
-  void render_stretched_obj(ca::Renderer* renderer, const fl::Mat4& projection_and_view,
-                            const fl::Vec2& from, const fl::Vec2& to,
-                            le::RenderModel* render_model) const;
+  // The second half of `render`: sorts the commands and submits them batch by batch.
+  void submit_draw_list(ca::Renderer* renderer, const fl::Mat4& projection_and_view,
+                        DrawList* draw_list);
 
   EntityId find_closest_to(EntityId entity_id, U32 mask);
   EntityId find_closest_to(const fl::Vec2& position, U32 mask);
@@ -70,14 +232,82 @@ private:
   EntityList entities_;
   EntityId selected_entity_id_;
 
+  // Index over entity positions used by the `find_*` queries.
+  SpatialGrid spatial_grid_;
+  // Index over selectable entities used to find the entity under the cursor.
+  EntityPicker entity_picker_;
+
+  PowerNetwork power_network_;
+
   Resources resources_;
 
-  MovementSystem movement_system_;
-  ResourceSystem resource_system_{&resources_};
+  Random random_;
+  U64 tick_count_ = 0;
+  F32 last_delta_ = 0.0f;
+
+  // Periodic behaviours (mining cycles, reheadings) are timers here, so a tick only visits the
+  // entities that are due instead of counting down on every entity. Timer periods are worked out
+  // from the tick delta, which is expected to stay fixed.
+  TimingWheel timing_wheel_;
+  nu::DynamicArray<EntityId> pending_timers_;
+  nu::DynamicArray<TimingWheel::Timer> expired_timers_;
+  nu::DynamicArray<EntityId> due_mining_cycles_;
+  nu::DynamicArray<EntityId> due_reheadings_;
+
+  JobSystem* job_system_ = nullptr;
+
+  SystemScheduler systems_;
 
   le::RenderModel* link_model_ = nullptr;
   le::RenderModel* miner_laser_model_ = nullptr;
+  le::RenderModel* circle_templates_[kCircleLodCount] = {};
+  ModelHandle link_model_handle_;
+  ModelHandle miner_laser_model_handle_;
+  ModelHandle circle_template_handles_[kCircleLodCount];
+  F32 viewport_height_ = 1080.0f;
   EntityId command_center_id_;
+
+  // The largest culling radius of any entity added so far, used to grow grid cells by enough to
+  // hold every entity overlapping them.
+  F32 max_cull_radius_ = 0.0f;
+  // Entities per model. There are only a few models, so they are searched linearly.
+  struct ModelUse {
+    le::RenderModel* model;
+    U32 count;
+  };
+  nu::DynamicArray<ModelUse> model_uses_;
+  nu::DynamicArray<EntityId> visible_entities_;
+  DrawList draw_list_;
+  // Filled by one thread each while the draw list is built, then appended to it.
+  nu::DynamicArray<DrawList> thread_draw_lists_;
+
+  struct StaticLink {
+    fl::Vec2 from;
+    fl::Vec2 to;
+    fl::Mat4 transform;
+  };
+
+  // Links are placed with their buildings and never move, so all of them are kept as one batch
+  // that is only rebuilt when buildings are added or destroyed.
+  nu::DynamicArray<StaticLink> static_links_;
+  nu::DynamicArray<EntityId> moving_links_;
+  bool link_batch_dirty_ = true;
+  U64 link_batch_rebuilds_ = 0;
+
+  // The static links as one mesh in world space, and the bounds it is culled by.
+  MeshUploadFunc upload_link_batch_;
+  ModelReleaseFunc release_link_batch_;
+  bool has_link_batch_uploader_ = false;
+  MeshData link_mesh_;
+  MeshData link_batch_mesh_;
+  le::RenderModel* link_batch_model_ = nullptr;
+  fl::Vec2 link_batch_min_;
+  fl::Vec2 link_batch_max_;
+  // `kVisible` and `kInConstructionRange` bits, indexed by `EntityId::index`. Only set while a
+  // draw list is built.
+  static constexpr U8 kVisible = NU_BIT(0);
+  static constexpr U8 kInConstructionRange = NU_BIT(1);
+  nu::DynamicArray<U8> render_flags_;
 };
 
 }  // namespace ad
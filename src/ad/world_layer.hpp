@@ -8,13 +8,25 @@
 #include <nucleus/win/includes.h>
 
 #include <legion/engine/engine.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <nucleus/optional.hpp>
+#include <sstream>
 #include <utility>
 
 #include "ad/app/user_interface.h"
+#include "ad/assets/asset_loader.h"
+#include "ad/assets/mesh_cache.h"
+#include "ad/assets/model_residency.h"
+#include "ad/assets/model_uploader.h"
 #include "ad/context.hpp"
+#include "ad/profiling/metrics.h"
+#include "ad/profiling/profiler.h"
+#include "ad/profiling/startup_timer.h"
 #include "ad/world/construction_controller.h"
 #include "ad/world/entity.h"
+#include "ad/world/fixed_timestep.h"
 #include "ad/world/generator.hpp"
 #include "ad/world/prefabs.h"
 #include "ad/world/world.h"
@@ -280,32 +292,67 @@ class WorldLayer : public le::EngineLayer {
 public:
   explicit WorldLayer(nu::ScopedRefPtr<Context> context) : context_{std::move(context)} {}
 
+  // The context can outlive the layer, so it must not keep anything that points into it.
+  ~WorldLayer() override {
+    context_->world().clear_link_batch_uploader();
+    context_->prefabs().set_model_residency(nullptr);
+  }
+
 protected:
   bool on_initialize() override {
+    model_uploader_.set_renderer(&renderer());
+    model_uploader_.set_resource_manager(&resource_manager());
+
     // Set up resource manager.
     auto assets_path = nu::getCurrentWorkingDirectory() / "assets";
     LOG(Info) << "Assets path: " << assets_path.getPath();
     resource_manager().set_locator(nu::make_scoped_ref_ptr<hi::PhysicalFileLocator>(assets_path));
 
-    // Set up the prefabs.
+    // Set up the prefabs. Their models are only loaded once an entity of their type is spawned or
+    // previewed. Ask for the other models needed before the first frame, so that they can all be
+    // read and decoded at once.
 
+    model_residency_.set_job_system(&context_->job_system());
+    context_->prefabs().set_model_residency(&model_residency_);
     setup_prefabs(&context_->prefabs());
+    for (const auto& prefab_model : kPrefabModels) {
+      context_->prefabs().set_model(prefab_model.type, prefab_model.name);
+    }
+    context_->world().request_models(&asset_loader_);
+    auto cursor_model = asset_loader_.request("cursor.obj");
+    startup_timer_.end_phase("set up prefabs");
 
-    // Load needed assets.
+    // Load needed assets. Only the upload has to happen on this thread.
 
-    context_->world().initialize(&resource_manager());
+    if (!asset_loader_.decode_pending(&context_->job_system())) {
+      LOG(Error) << "Could not decode models.";
+      return false;
+    }
+    startup_timer_.end_phase("decode models");
 
-    cursor_model_ = resource_manager().get_render_model("cursor.obj");
-    if (!cursor_model_) {
-      LOG(Error) << "Could not load cursor model.";
+    if (!asset_loader_.upload_pending()) {
+      LOG(Error) << "Could not upload models.";
       return false;
     }
+    startup_timer_.end_phase("upload models");
+
+    context_->world().set_link_batch_uploader(
+        [this](const MeshData& mesh) { return model_uploader_.upload(mesh); },
+        [this](le::RenderModel* model) { model_uploader_.release(model); });
+    if (!context_->world().initialize(asset_loader_)) {
+      LOG(Error) << "Could not initialize world.";
+      return false;
+    }
+
+    cursor_model_ = asset_loader_.model(cursor_model);
+    startup_timer_.end_phase("initialize world");
 
     // Populate the world.
 
     if (!populate_world(&context_->world(), &context_->prefabs())) {
       return false;
     }
+    startup_timer_.end_phase("populate world");
 
     // Set state of entities.
 
@@ -323,6 +370,8 @@ protected:
 
     auto aspect_ratio = le::Camera::aspectRatioFromScreenSize(size);
     world_camera_.setAspectRatio(aspect_ratio);
+
+    context_->world().set_viewport_height(static_cast<F32>(size.height));
   }
 
   void on_mouse_moved(const ca::MouseEvent& evt) override {
@@ -353,6 +402,24 @@ protected:
   }
 
   void on_key_pressed(const ca::KeyEvent& evt) override {
+    // Building starts when the key is released, so load the model in the meantime.
+    switch (evt.key) {
+      case ca::Key::M:
+        context_->construction_controller().prefetch(EntityType::Miner);
+        break;
+
+      case ca::Key::T:
+        context_->construction_controller().prefetch(EntityType::Turret);
+        break;
+
+      case ca::Key::H:
+        context_->construction_controller().prefetch(EntityType::Hub);
+        break;
+
+      default:
+        break;
+    }
+
     world_camera_controller_.on_key_pressed(evt);
   }
 
@@ -373,12 +440,28 @@ protected:
       case ca::Key::Escape:
         context_->construction_controller().cancel_building();
         return;
+
+      case ca::Key::P:
+        export_profile();
+        return;
+
+      case ca::Key::C:
+        Metrics::get().set_enabled(!Metrics::get().is_enabled());
+        return;
     }
 
     world_camera_controller_.on_key_released(evt);
   }
 
   void update(F32 delta) override {
+    // A frame runs from one update to the next.
+    auto frame_start = std::chrono::steady_clock::now();
+    std::chrono::duration<F64, std::milli> frame_time = frame_start - last_frame_start_;
+    last_frame_start_ = frame_start;
+    Metrics::get().end_frame(frame_time.count());
+
+    Profiler::get().begin_frame();
+
     world_camera_controller_.tick(delta);
 
     {
@@ -396,11 +479,24 @@ protected:
       context_->construction_controller().set_cursor_position(mouse_position_in_world_.xy());
     }
 
-    context_->world().tick(delta);
+    // The world always ticks by the same amount, no matter the frame rate.
+    context_->world().systems().begin_frame();
+    for (auto ticks = timestep_.advance(delta); ticks > 0; --ticks) {
+      context_->world().tick(timestep_.tick_delta());
+    }
   }
 
   void on_render() override {
-    context_->world().render(&renderer(), &world_camera_, &context_->construction_controller());
+    auto render_start = std::chrono::steady_clock::now();
+
+    model_residency_.upload_prefetched();
+
+    context_->world().render(&renderer(), &world_camera_, &context_->construction_controller(),
+                             timestep_.alpha());
+
+    std::chrono::duration<F64, std::nano> render_time =
+        std::chrono::steady_clock::now() - render_start;
+    render_counter_.add(static_cast<U64>(render_time.count()));
 
     auto projection = fl::Mat4::identity;
     auto view = fl::Mat4::identity;
@@ -412,31 +508,47 @@ protected:
     auto mvp = projection * view * model;
 
     le::renderModel(&renderer(), *cursor_model_, mvp);
+
+    if (is_first_frame_) {
+      is_first_frame_ = false;
+      startup_timer_.end_phase("first frame");
+
+      std::ostringstream breakdown;
+      startup_timer_.write(breakdown);
+      LOG(Info) << "Startup:\n" << breakdown.str();
+    }
   }
 
 private:
+  static constexpr U64 kProfileExportFrames = 120;
+
+  // Writes the last few frames of profiling zones to a trace that Perfetto can open.
+  static void export_profile() {
+    auto& profiler = Profiler::get();
+
+    profiler.set_recording(false);
+    std::ofstream out{"trace.json"};
+    profiler.export_chrome_trace(out, kProfileExportFrames);
+    profiler.set_recording(true);
+
+    LOG(Info) << "Wrote the last " << kProfileExportFrames << " frames to trace.json";
+  }
+
   static bool setup_prefabs(Prefabs* prefabs) {
     if (!prefabs->set(EntityType::CommandCenter,
-                      [](le::ResourceManager* resource_manager, Entity* storage) -> bool {
+                      [](le::ResourceManager*, Entity* storage) -> bool {
                         storage->flags = ENTITY_FLAG_LINKABLE;
 
                         storage->electricity.electricity_delta = 100;
                         storage->building.selection_radius = 2.5f;
 
-                        auto* model = resource_manager->get_render_model("command_center.obj");
-
-                        storage->render.model = model;
-                        if (!storage->render.model) {
-                          return false;
-                        }
-
                         return true;
                       })) {
       return false;
     }
 
     if (!prefabs->set(EntityType::Miner,
-                      [](le::ResourceManager* resource_manager, Entity* storage) -> bool {
+                      [](le::ResourceManager*, Entity* storage) -> bool {
                         storage->flags = ENTITY_FLAG_NEEDS_LINK;
 
                         storage->electricity.electricity_delta = -5;
@@ -446,61 +558,41 @@ private:
                         storage->mining.cycle_duration = 100.0f;
                         storage->mining.mineral_amount_per_cycle = 10;
 
-                        storage->render.model = resource_manager->get_render_model("miner.obj");
-                        if (!storage->render.model) {
-                          return false;
-                        }
-
                         return true;
                       })) {
       return false;
     }
 
     if (!prefabs->set(EntityType::Turret,
-                      [](le::ResourceManager* resource_manager, Entity* storage) -> bool {
+                      [](le::ResourceManager*, Entity* storage) -> bool {
                         storage->flags = ENTITY_FLAG_NEEDS_LINK;
 
                         storage->electricity.electricity_delta = -5;
 
                         storage->building.selection_radius = 1.5f;
 
-                        storage->render.model = resource_manager->get_render_model("turret.obj");
-                        if (!storage->render.model) {
-                          return false;
-                        }
-
                         return true;
                       })) {
       return false;
     }
 
     if (!prefabs->set(EntityType::Hub,
-                      [](le::ResourceManager* resource_manager, Entity* storage) -> bool {
+                      [](le::ResourceManager*, Entity* storage) -> bool {
                         storage->flags = ENTITY_FLAG_NEEDS_LINK | ENTITY_FLAG_LINKABLE;
 
                         storage->electricity.electricity_delta = -1;
 
                         storage->building.selection_radius = 1.5f;
 
-                        storage->render.model = resource_manager->get_render_model("hub.obj");
-                        if (!storage->render.model) {
-                          return false;
-                        }
-
                         return true;
                       })) {
       return false;
     }
 
     if (!prefabs->set(EntityType::Asteroid,
-                      [](le::ResourceManager* resource_manager, Entity* storage) -> bool {
+                      [](le::ResourceManager*, Entity* storage) -> bool {
                         storage->flags = ENTITY_FLAG_MINABLE;
 
-                        storage->render.model = resource_manager->get_render_model("asteroid.obj");
-                        if (!storage->render.model) {
-                          return false;
-                        }
-
                         storage->building.selection_radius = 1.7f;
 
                         return true;
@@ -509,22 +601,66 @@ private:
     }
 
     if (!prefabs->set(EntityType::EnemyFighter,
-                      [](le::ResourceManager* resource_manager, Entity* storage) -> bool {
-                        storage->render.model = resource_manager->get_render_model("enemy.obj");
-                        if (!storage->render.model) {
-                          return false;
-                        }
-
-                        return true;
-                      })) {
+                      [](le::ResourceManager*, Entity*) -> bool { return true; })) {
       return false;
     }
 
     return true;
   }
 
+  // 60 ticks per second. Frame deltas from the engine are in milliseconds.
+  static constexpr F32 kTickDelta = 1000.0f / 60.0f;
+
+  // Prefab models may take this much memory before unused ones are unloaded.
+  static constexpr MemSize kModelBudget = 64 * 1024 * 1024;
+
+  struct PrefabModel {
+    EntityType type;
+    const char* name;
+  };
+
+  static constexpr PrefabModel kPrefabModels[] = {
+      {EntityType::CommandCenter, "command_center.obj"}, {EntityType::Miner, "miner.obj"},
+      {EntityType::Turret, "turret.obj"},                {EntityType::Hub, "hub.obj"},
+      {EntityType::Asteroid, "asteroid.obj"},            {EntityType::EnemyFighter, "enemy.obj"},
+  };
+
+  // Runs from the layer's creation up to the end of the first frame.
+  StartupTimer startup_timer_;
+  bool is_first_frame_ = true;
+
   nu::ScopedRefPtr<Context> context_;
 
+  ModelUploader model_uploader_;
+  // The cache is derived data, so it is kept out of the working directory.
+  MeshCache mesh_cache_{std::filesystem::current_path() / "assets",
+                        std::filesystem::temp_directory_path() / "ad_mesh_cache"};
+  // Models are made from the meshes decoded by the jobs, so nothing is parsed on this thread.
+  AssetLoader asset_loader_{&mesh_cache_, [this](std::string_view, const MappedMesh& mesh) {
+                              return model_uploader_.upload(mesh);
+                            }};
+  // Prefab models are drawn straight from their cached meshes, and sized by their GPU buffers.
+  ModelResidency model_residency_{
+      kModelBudget, &mesh_cache_,
+      [this](std::string_view, const MappedMesh& mesh, MemSize* bytes) {
+        return model_uploader_.upload(mesh, bytes);
+      },
+      [this](std::string_view, le::RenderModel* model) {
+        context_->prefabs().forget_model(model);
+        model_uploader_.release(model);
+      },
+      [this](le::RenderModel* model) {
+        auto& construction_controller = context_->construction_controller();
+        return context_->world().model_use_count(model) > 0 ||
+               (construction_controller.is_building() &&
+                construction_controller.prefab()->render.model == model);
+      }};
+
+  FixedTimestep timestep_{kTickDelta};
+
+  std::chrono::steady_clock::time_point last_frame_start_ = std::chrono::steady_clock::now();
+  Metrics::Counter& render_counter_ = Metrics::get().counter("render ns");
+
   le::Camera world_camera_{fl::degrees(70.0f), {0.0f, 0.0f, 1.0f}};
   le::TopDownCameraController world_camera_controller_{
       &world_camera_, {fl::Vec3::forward, 0.0f}, 45.0f};
@@ -0,0 +1,94 @@
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#include "ad/assets/asset_loader.h"
+#include "ad/jobs/job_system.h"
+#include "legion/resources/render_model.h"
+
+namespace ad {
+
+TEST_CASE("AssetLoader") {
+  auto directory = std::filesystem::temp_directory_path() / "ad_asset_loader_tests";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  constexpr const char* kNames[] = {"a.obj", "b.obj", "c.obj", "d.obj", "e.obj"};
+  for (auto name : kNames) {
+    std::ofstream out{directory / name};
+    out << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+  }
+
+  MeshCache mesh_cache{directory, directory / "cache"};
+
+  // Stands in for the GPU upload, which has to stay on the thread that owns the renderer.
+  le::RenderModel models[std::size(kNames)];
+  U32 uploads = 0;
+  auto upload_thread = std::this_thread::get_id();
+  bool uploaded_elsewhere = false;
+  AssetLoader loader{&mesh_cache, [&](std::string_view name, const MappedMesh& mesh) {
+                       uploaded_elsewhere |= std::this_thread::get_id() != upload_thread;
+                       CHECK(mesh.index_count() == 3);
+                       ++uploads;
+                       return name == "missing.obj" ? nullptr : &models[name[0] - 'a'];
+                     }};
+
+  SECTION("decodes on the job system and uploads on the calling thread") {
+    ModelHandle handles[std::size(kNames)];
+    for (U32 i = 0; i < std::size(kNames); ++i) {
+      handles[i] = loader.request(kNames[i]);
+    }
+    CHECK(loader.request("c.obj").index == handles[2].index);
+    CHECK(loader.model(handles[0]) == nullptr);
+
+    JobSystem job_system{3};
+    REQUIRE(loader.decode_pending(&job_system));
+    CHECK(mesh_cache.conversions() == std::size(kNames));
+    CHECK(uploads == 0);
+
+    REQUIRE(loader.upload_pending());
+    CHECK(uploads == std::size(kNames));
+    CHECK_FALSE(uploaded_elsewhere);
+    for (U32 i = 0; i < std::size(kNames); ++i) {
+      CHECK(loader.model(handles[i]) == &models[i]);
+    }
+
+    // Only new requests are loaded the next time around.
+    auto late = loader.request("e.obj");
+    REQUIRE(loader.decode_pending(nullptr));
+    REQUIRE(loader.upload_pending());
+    CHECK(uploads == std::size(kNames));
+    CHECK(loader.model(late) == &models[4]);
+  }
+
+  SECTION("keeps the meshes it is asked to") {
+    auto kept = loader.request("a.obj", true);
+    auto dropped = loader.request("b.obj");
+
+    REQUIRE(loader.decode_pending(nullptr));
+    REQUIRE(loader.upload_pending());
+    REQUIRE(loader.mesh(kept) != nullptr);
+    CHECK(loader.mesh(kept)->index_count() == 3);
+    CHECK(loader.mesh(dropped) == nullptr);
+  }
+
+  SECTION("reports models that fail to load") {
+    auto good = loader.request("a.obj");
+    auto missing = loader.request("missing.obj");
+
+    CHECK_FALSE(loader.decode_pending(nullptr));
+    CHECK_FALSE(loader.upload_pending());
+    CHECK(uploads == 1);
+    CHECK(loader.model(good) == &models[0]);
+    CHECK(loader.model(missing) == nullptr);
+    CHECK(loader.model(ModelHandle{}) == nullptr);
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+}  // namespace ad
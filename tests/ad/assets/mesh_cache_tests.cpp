@@ -0,0 +1,297 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "ad/assets/mesh_cache.h"
+
+namespace ad {
+
+namespace {
+
+// A grid of `size` by `size` quads, with the quads listed column by column so that a FIFO cache
+// gets little reuse out of them.
+std::string grid_obj(U32 size) {
+  std::string result;
+  for (U32 y = 0; y <= size; ++y) {
+    for (U32 x = 0; x <= size; ++x) {
+      result += "v " + std::to_string(x) + " " + std::to_string(y) + " 0\n";
+    }
+  }
+  for (U32 x = 0; x < size; ++x) {
+    for (U32 y = 0; y < size; ++y) {
+      auto corner = y * (size + 1) + x + 1;
+      result += "f " + std::to_string(corner) + " " + std::to_string(corner + 1) + " " +
+                std::to_string(corner + size + 2) + " " + std::to_string(corner + size + 1) + "\n";
+    }
+  }
+  return result;
+}
+
+// The triangles of `mesh` by their corner positions, rotated to start at the smallest corner, so
+// meshes can be compared regardless of triangle and vertex order.
+nu::DynamicArray<std::tuple<F32, F32, F32, F32, F32, F32>> triangles_of(const MeshData& mesh) {
+  nu::DynamicArray<std::tuple<F32, F32, F32, F32, F32, F32>> result;
+  for (MemSize i = 0; i < mesh.indices.size(); i += 3) {
+    std::pair<F32, F32> corners[3];
+    for (U32 corner = 0; corner < 3; ++corner) {
+      const auto& position = mesh.vertices[mesh.indices[i + corner]].position;
+      corners[corner] = {position.x, position.y};
+    }
+    std::rotate(corners, std::min_element(corners, corners + 3), corners + 3);
+    result.emplaceBack(corners[0].first, corners[0].second, corners[1].first, corners[1].second,
+                       corners[2].first, corners[2].second);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+void write_file(const std::filesystem::path& path, const std::string& content) {
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  out << content;
+}
+
+}  // namespace
+
+TEST_CASE("parse_obj") {
+  SECTION("shares vertices with the same attributes") {
+    constexpr const char* kQuad =
+        "# comment\n"
+        "mtllib quad.mtl\n"
+        "o quad\n"
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "v 1 1 0\n"
+        "v 0 1 0\n"
+        "vt 0 0\n"
+        "vt 1 1\n"
+        "vn 0 0 1\r\n"
+        "usemtl palette\n"
+        "s off\n"
+        "f 1/1/1 2/1/1 3/2/1\n"
+        "f 1/1/1 3/2/1 -1/2/-1\n";
+
+    MeshData mesh;
+    REQUIRE(parse_obj(kQuad, &mesh));
+    CHECK(mesh.vertices.size() == 4);
+    REQUIRE(mesh.indices.size() == 6);
+    CHECK(mesh.indices[3] == mesh.indices[0]);
+    CHECK(mesh.indices[4] == mesh.indices[2]);
+    CHECK(mesh.vertices[mesh.indices[5]].position.y == 1.0f);
+    CHECK(mesh.vertices[mesh.indices[2]].tex_coord.x == 1.0f);
+    CHECK(mesh.vertices[mesh.indices[2]].normal.z == 1.0f);
+
+    CHECK(mesh.material_library == "quad.mtl");
+    REQUIRE(mesh.materials.size() == 1);
+    CHECK(mesh.materials[0].name_view() == "palette");
+    CHECK(mesh.materials[0].first_index == 0);
+    CHECK(mesh.materials[0].index_count == 6);
+  }
+
+  SECTION("splits the indices by material") {
+    MeshData mesh;
+    REQUIRE(parse_obj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n"
+                      "usemtl a\nf 1 2 3\nf 1 3 2\nusemtl b \nf 3 2 1\nusemtl c\n",
+                      &mesh));
+    CHECK(mesh.material_library.empty());
+    REQUIRE(mesh.materials.size() == 3);
+    CHECK(mesh.materials[0].name_view().empty());
+    CHECK(mesh.materials[0].index_count == 3);
+    CHECK(mesh.materials[1].name_view() == "a");
+    CHECK(mesh.materials[1].first_index == 3);
+    CHECK(mesh.materials[1].index_count == 6);
+    CHECK(mesh.materials[2].name_view() == "b");
+    CHECK(mesh.materials[2].first_index == 9);
+    CHECK(mesh.materials[2].index_count == 3);
+
+    // Without any `usemtl`, there are no materials at all.
+    REQUIRE(parse_obj(grid_obj(1), &mesh));
+    CHECK(mesh.materials.size() == 0);
+
+    CHECK_FALSE(parse_obj("usemtl " + std::string(kMaxMaterialNameLength + 1, 'x'), &mesh));
+  }
+
+  SECTION("keeps vertices apart when one attribute differs") {
+    MeshData mesh;
+    REQUIRE(parse_obj("v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nvn 0 0 -1\n"
+                      "f 1//1 2//1 3//1\nf 1//2 3//2 2//2\n",
+                      &mesh));
+    CHECK(mesh.vertices.size() == 6);
+    CHECK(mesh.indices.size() == 6);
+  }
+
+  SECTION("splits polygons into fans") {
+    MeshData mesh;
+    REQUIRE(parse_obj(grid_obj(1), &mesh));
+    CHECK(mesh.vertices.size() == 4);
+    CHECK(mesh.indices.size() == 6);
+  }
+
+  SECTION("rejects faces that point past the vertices") {
+    MeshData mesh;
+    CHECK_FALSE(parse_obj("v 0 0 0\nv 1 0 0\nf 1 2 3\n", &mesh));
+    CHECK_FALSE(parse_obj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1/1 2/1 3/1\n", &mesh));
+    CHECK_FALSE(parse_obj("v 0 0 0\nv 1 0 0\nf 1 2\n", &mesh));
+  }
+}
+
+TEST_CASE("optimize_vertex_cache") {
+  MeshData mesh;
+  REQUIRE(parse_obj(grid_obj(32), &mesh));
+  auto before = triangles_of(mesh);
+  auto miss_ratio_before = average_cache_miss_ratio(
+      mesh.indices.data(), mesh.indices.size(), static_cast<U32>(mesh.vertices.size()));
+
+  optimize_vertex_cache(&mesh);
+
+  // The same triangles, in an order that reuses more vertices.
+  auto after = triangles_of(mesh);
+  REQUIRE(after.size() == before.size());
+  CHECK(std::equal(after.begin(), after.end(), before.begin()));
+  auto miss_ratio_after = average_cache_miss_ratio(
+      mesh.indices.data(), mesh.indices.size(), static_cast<U32>(mesh.vertices.size()));
+  CHECK(miss_ratio_after < miss_ratio_before * 0.8f);
+  CHECK(miss_ratio_after < 0.8f);
+
+  // Vertices are numbered in the order they are first used.
+  U32 next = 0;
+  for (auto index : mesh.indices) {
+    CHECK(index <= next);
+    next = std::max(next, index + 1);
+  }
+  CHECK(next == mesh.vertices.size());
+
+  SECTION("triangles stay with their material") {
+    // The left half of the grid uses one material and the right half another.
+    MeshData split;
+    auto obj = grid_obj(8);
+    auto middle = obj.find("f ");
+    for (U32 column = 0; column < 4; ++column) {
+      for (U32 row = 0; row < 8; ++row) {
+        middle = obj.find("f ", middle + 1);
+      }
+    }
+    obj.insert(middle, "usemtl right\n");
+    obj.insert(obj.find("f "), "usemtl left\n");
+    REQUIRE(parse_obj(obj, &split));
+    REQUIRE(split.materials.size() == 2);
+
+    optimize_vertex_cache(&split);
+    REQUIRE(split.materials.size() == 2);
+    for (const auto& material : split.materials) {
+      for (U32 i = material.first_index; i < material.first_index + material.index_count; ++i) {
+        auto x = split.vertices[split.indices[i]].position.x;
+        CHECK((material.name_view() == "left" ? x <= 4.0f : x >= 4.0f));
+      }
+    }
+  }
+}
+
+TEST_CASE("MeshCache") {
+  auto directory = std::filesystem::temp_directory_path() / "ad_mesh_cache_tests";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  auto cache_directory = directory / "cache";
+
+  write_file(directory / "grid.obj", grid_obj(4));
+
+  SECTION("converts once and maps the copy after that") {
+    MeshCache cache{directory, cache_directory};
+
+    MappedMesh mesh;
+    REQUIRE(cache.load("grid.obj", &mesh));
+    CHECK(cache.conversions() == 1);
+    CHECK(mesh.vertex_count() == 25);
+    CHECK(mesh.index_count() == 96);
+
+    MappedMesh again;
+    REQUIRE(cache.load("grid.obj", &again));
+    CHECK(cache.conversions() == 1);
+    REQUIRE(again.vertex_count() == mesh.vertex_count());
+    CHECK(std::equal(mesh.indices(), mesh.indices() + mesh.index_count(), again.indices()));
+
+    // Moving keeps the mapping alive.
+    MappedMesh moved{std::move(again)};
+    CHECK(moved.is_open());
+    CHECK_FALSE(again.is_open());
+    CHECK(moved.vertices()[moved.indices()[0]].position.z == 0.0f);
+  }
+
+  SECTION("converts again when the source changes") {
+    MeshCache cache{directory, cache_directory};
+    MappedMesh mesh;
+    REQUIRE(cache.load("grid.obj", &mesh));
+
+    write_file(directory / "grid.obj", grid_obj(2));
+    REQUIRE(cache.load("grid.obj", &mesh));
+    CHECK(cache.conversions() == 2);
+    CHECK(mesh.vertex_count() == 9);
+  }
+
+  SECTION("converts again when the cache file is cut off") {
+    MeshCache cache{directory, cache_directory};
+    MappedMesh mesh;
+    REQUIRE(cache.load("grid.obj", &mesh));
+    mesh.close();
+
+    auto cache_path = cache_directory / "grid.obj.mesh";
+    REQUIRE(mesh.open(cache_path));
+    CHECK(mesh.source().size == std::filesystem::file_size(directory / "grid.obj"));
+    mesh.close();
+
+    std::filesystem::resize_file(cache_path, std::filesystem::file_size(cache_path) - 4);
+    CHECK_FALSE(mesh.open(cache_path));
+    REQUIRE(cache.load("grid.obj", &mesh));
+    CHECK(cache.conversions() == 2);
+  }
+
+  SECTION("keeps the copy when the source is only touched") {
+    MeshCache cache{directory, cache_directory};
+    MappedMesh mesh;
+    REQUIRE(cache.load("grid.obj", &mesh));
+    auto hash = mesh.source().hash;
+
+    auto source_path = directory / "grid.obj";
+    std::filesystem::last_write_time(
+        source_path, std::filesystem::last_write_time(source_path) + std::chrono::seconds{10});
+    REQUIRE(cache.load("grid.obj", &mesh));
+    CHECK(cache.conversions() == 1);
+    CHECK(mesh.source().hash == hash);
+  }
+
+  SECTION("keeps the material ranges") {
+    write_file(directory / "quad.obj",
+               "mtllib quad.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl a\nf 1 2 3\n"
+               "usemtl b\nf 1 3 2\n");
+
+    MeshCache cache{directory, cache_directory};
+    MappedMesh mesh;
+    REQUIRE(cache.load("quad.obj", &mesh));
+    CHECK(mesh.material_library() == "quad.mtl");
+    REQUIRE(mesh.material_count() == 2);
+    CHECK(mesh.materials()[1].name_view() == "b");
+    CHECK(mesh.materials()[1].first_index == 3);
+
+    MeshData copy;
+    mesh.copy_to(&copy);
+    CHECK(copy.material_library == "quad.mtl");
+    CHECK(copy.materials.size() == 2);
+    CHECK(copy.indices.size() == 6);
+  }
+
+  SECTION("fails for missing sources") {
+    MeshCache cache{directory, cache_directory};
+    MappedMesh mesh;
+    CHECK_FALSE(cache.load("missing.obj", &mesh));
+    CHECK_FALSE(mesh.is_open());
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+}  // namespace ad
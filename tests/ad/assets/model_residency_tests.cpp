@@ -0,0 +1,147 @@
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "ad/assets/model_residency.h"
+#include "ad/jobs/job_system.h"
+#include "legion/resources/render_model.h"
+
+namespace ad {
+
+TEST_CASE("ModelResidency") {
+  auto directory = std::filesystem::temp_directory_path() / "ad_model_residency_tests";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  for (auto name : {"a", "b", "c"}) {
+    std::ofstream out{directory / name};
+    out << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+  }
+
+  MeshCache mesh_cache{directory, directory / "cache"};
+
+  // Every model takes 100 bytes, so the budget holds two of them.
+  le::RenderModel models[4];
+  std::string loads;
+  std::string unloads;
+  le::RenderModel* in_use = nullptr;
+  bool everything_in_use = false;
+  ModelResidency residency{
+      200, &mesh_cache,
+      [&](std::string_view name, const MappedMesh& mesh, MemSize* bytes) -> le::RenderModel* {
+        CHECK(mesh.index_count() == 3);
+        loads += name;
+        *bytes = 100;
+        return &models[name[0] - 'a'];
+      },
+      [&](std::string_view name, le::RenderModel*) { unloads += name; },
+      [&](le::RenderModel* model) { return everything_in_use || model == in_use; }};
+
+  auto a = residency.add("a");
+  auto b = residency.add("b");
+  auto c = residency.add("c");
+  CHECK(residency.add("b").index == b.index);
+
+  SECTION("loads models when they are first acquired") {
+    CHECK(residency.resident_count() == 0);
+    CHECK(loads.empty());
+
+    CHECK(residency.acquire(b) == &models[1]);
+    CHECK(residency.acquire(b) == &models[1]);
+    CHECK(loads == "b");
+    CHECK(residency.resident_bytes() == 100);
+  }
+
+  SECTION("unloads the least recently used model over the budget") {
+    residency.acquire(a);
+    residency.acquire(b);
+    residency.acquire(a);
+    CHECK(unloads.empty());
+
+    residency.acquire(c);
+    CHECK(unloads == "b");
+    CHECK(residency.resident_count() == 2);
+    CHECK(residency.resident_bytes() == 200);
+
+    // Acquiring it again loads it again.
+    CHECK(residency.acquire(b) == &models[1]);
+    CHECK(loads == "abcb");
+    CHECK(unloads == "ba");
+    CHECK(residency.load_count() == 4);
+  }
+
+  SECTION("keeps models that are in use") {
+    residency.acquire(a);
+    residency.acquire(b);
+    in_use = &models[0];
+
+    residency.acquire(c);
+    CHECK(unloads == "b");
+
+    // Once `a` is no longer in use, it is the one to go.
+    in_use = &models[2];
+    residency.acquire(b);
+    CHECK(unloads == "ba");
+    CHECK(residency.resident_count() == 2);
+  }
+
+  SECTION("stays over the budget while everything is in use") {
+    everything_in_use = true;
+    residency.acquire(a);
+    residency.acquire(b);
+    residency.acquire(c);
+    CHECK(unloads.empty());
+    CHECK(residency.resident_bytes() == 300);
+
+    // Trimming catches up once models are no longer used.
+    everything_in_use = false;
+    residency.trim();
+    CHECK(unloads == "a");
+    CHECK(residency.resident_bytes() == 200);
+  }
+
+  SECTION("prefetching maps the mesh without uploading it") {
+    residency.prefetch(c);
+    CHECK(loads.empty());
+    CHECK(residency.resident_count() == 0);
+
+    residency.upload_prefetched();
+    CHECK(loads == "c");
+    CHECK(residency.acquire(c) == &models[2]);
+    CHECK(loads == "c");
+  }
+
+  SECTION("prefetching on the job system does not wait for the mesh") {
+    JobSystem job_system{2};
+    residency.set_job_system(&job_system);
+
+    residency.prefetch(a);
+    residency.prefetch(b);
+    residency.prefetch(b);
+
+    // Whatever has not been mapped yet is waited for on acquire.
+    residency.upload_prefetched();
+    CHECK(residency.acquire(a) == &models[0]);
+    CHECK(residency.acquire(b) == &models[1]);
+    CHECK(residency.load_count() == 2);
+    CHECK(mesh_cache.conversions() == 2);
+  }
+
+  SECTION("does not retry models that failed to load") {
+    auto x = residency.add("x");
+    CHECK(residency.acquire(x) == nullptr);
+    CHECK(residency.acquire(x) == nullptr);
+    residency.prefetch(x);
+    residency.upload_prefetched();
+    CHECK(loads.empty());
+    CHECK(mesh_cache.conversions() == 0);
+    CHECK(residency.resident_bytes() == 0);
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+}  // namespace ad
@@ -0,0 +1,151 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "ad/jobs/job_system.h"
+#include "ad/world/world.h"
+
+namespace ad {
+
+namespace {
+
+// Runs a world with miners and fighters and returns the state that the systems write.
+struct Snapshot {
+  nu::DynamicArray<fl::Vec2> positions;
+  I32 electricity;
+  I32 minerals;
+};
+
+Snapshot simulate(JobSystem* job_system) {
+  World world;
+  world.set_job_system(job_system);
+
+  Entity miner;
+  miner.type = EntityType::Miner;
+  miner.electricity.electricity_delta = -5;
+  miner.mining.cycle_duration = 10.0f;
+  miner.mining.mineral_amount_per_cycle = 3;
+
+  Entity fighter;
+  fighter.type = EntityType::EnemyFighter;
+  fighter.movement.speed = 40.0f;
+
+  auto random = world.random().stream(9);
+  for (U32 i = 0; i < 20'000; ++i) {
+    fl::Vec2 position{random.next_float() * 1000.0f, random.next_float() * 1000.0f};
+    world.add_entity_from_prefab(i % 4 ? &fighter : &miner, position);
+  }
+
+  for (U32 tick = 0; tick < 50; ++tick) {
+    world.tick(16.0f);
+  }
+
+  Snapshot snapshot;
+  for (auto entity : world.entities()) {
+    snapshot.positions.emplaceBack(entity.position());
+  }
+  snapshot.electricity = world.resources()->electricity();
+  snapshot.minerals = world.resources()->minerals();
+  return snapshot;
+}
+
+}  // namespace
+
+TEST_CASE("JobSystem") {
+  SECTION("parallel_for visits every index once") {
+    JobSystem job_system{3};
+    CHECK(job_system.thread_count() == 4);
+
+    for (MemSize count : {1, 7, 100, 10'000, 100'003}) {
+      for (MemSize grain : {1, 16, 1000}) {
+        auto visits = std::make_unique<std::atomic<U32>[]>(count);
+        std::atomic<MemSize> largest_piece = 0;
+
+        job_system.parallel_for(count, grain, [&](MemSize begin, MemSize end, U32 thread_index) {
+          REQUIRE(thread_index < job_system.thread_count());
+          for (MemSize i = begin; i < end; ++i) {
+            visits[i].fetch_add(1);
+          }
+          auto size = end - begin;
+          auto largest = largest_piece.load();
+          while (size > largest && !largest_piece.compare_exchange_weak(largest, size)) {
+          }
+        });
+
+        MemSize wrong_visits = 0;
+        for (MemSize i = 0; i < count; ++i) {
+          wrong_visits += visits[i].load() != 1;
+        }
+        CHECK(wrong_visits == 0);
+        CHECK(largest_piece.load() <= grain);
+      }
+    }
+  }
+
+  SECTION("nested parallel_for") {
+    JobSystem job_system{2};
+
+    std::atomic<U32> total = 0;
+    job_system.parallel_for(8, 1, [&](MemSize begin, MemSize end, U32) {
+      for (MemSize i = begin; i < end; ++i) {
+        job_system.parallel_for(1000, 10, [&](MemSize b, MemSize e, U32) {
+          total.fetch_add(static_cast<U32>(e - b));
+        });
+      }
+    });
+
+    CHECK(total.load() == 8000);
+  }
+
+  SECTION("submitted jobs run without the caller waiting") {
+    std::atomic<U32> done = 0;
+    std::atomic<U32> on_workers = 0;
+    {
+      JobSystem job_system{2};
+      for (U32 i = 0; i < 100; ++i) {
+        job_system.submit([&](U32 thread_index) {
+          on_workers.fetch_add(thread_index > 0 ? 1 : 0);
+          done.fetch_add(1);
+        });
+      }
+      while (done.load() < 50) {
+        std::this_thread::yield();
+      }
+    }
+
+    // The rest run before the job system goes away.
+    CHECK(done.load() == 100);
+    CHECK(on_workers.load() > 0);
+
+    JobSystem no_workers{0};
+    no_workers.submit([&](U32) { done.fetch_add(1); });
+    CHECK(done.load() == 101);
+  }
+
+  SECTION("without a job system the work runs inline") {
+    MemSize visited = 0;
+    parallel_for(nullptr, 100, 10, [&](MemSize begin, MemSize end, U32 thread_index) {
+      CHECK(thread_index == 0);
+      visited += end - begin;
+    });
+    CHECK(visited == 100);
+  }
+
+  SECTION("parallel ticks match single threaded ticks") {
+    auto serial = simulate(nullptr);
+
+    JobSystem job_system{3};
+    auto parallel = simulate(&job_system);
+
+    CHECK(serial.electricity == parallel.electricity);
+    CHECK(serial.minerals == parallel.minerals);
+    REQUIRE(serial.positions.size() == parallel.positions.size());
+    CHECK(std::memcmp(serial.positions.data(), parallel.positions.data(),
+                      serial.positions.size() * sizeof(fl::Vec2)) == 0);
+  }
+}
+
+}  // namespace ad
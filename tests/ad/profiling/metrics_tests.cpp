@@ -0,0 +1,77 @@
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+#include "ad/profiling/metrics.h"
+
+namespace ad {
+
+TEST_CASE("Metrics") {
+  SECTION("counters only count while enabled") {
+    Metrics metrics;
+    auto& counter = metrics.counter("test");
+
+    counter.add(5);
+    metrics.end_frame(1.0);
+    CHECK(counter.last_frame() == 0);
+
+    metrics.set_enabled(true);
+    counter.add(5);
+    counter.add();
+    metrics.end_frame(1.0);
+    CHECK(counter.last_frame() == 6);
+
+    // Every frame starts from zero.
+    metrics.end_frame(1.0);
+    CHECK(counter.last_frame() == 0);
+  }
+
+  SECTION("counters are looked up by name") {
+    Metrics metrics;
+    CHECK(&metrics.counter("a") == &metrics.counter("a"));
+    CHECK(&metrics.counter("a") != &metrics.counter("b"));
+  }
+
+  SECTION("increments from many threads are not lost") {
+    Metrics metrics;
+    metrics.set_enabled(true);
+    auto& counter = metrics.counter("test");
+
+    std::thread threads[4];
+    for (auto& thread : threads) {
+      thread = std::thread{[&counter] {
+        for (U32 i = 0; i < 10'000; ++i) {
+          counter.add();
+        }
+      }};
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    metrics.end_frame(1.0);
+    CHECK(counter.last_frame() == 40'000);
+  }
+
+  SECTION("frame time percentiles") {
+    Metrics metrics;
+    CHECK(metrics.frame_time_percentile(0.5) == 0.0);
+
+    metrics.set_enabled(true);
+    for (U32 i = 1; i <= 100; ++i) {
+      metrics.end_frame(static_cast<F64>(i));
+    }
+
+    CHECK(metrics.frame_time_percentile(0.5) == Approx(51.0).margin(1.0));
+    CHECK(metrics.frame_time_percentile(0.99) == Approx(99.0).margin(1.0));
+    CHECK(metrics.frame_time_percentile(1.0) == 100.0);
+
+    // Only the most recent frames are kept.
+    for (U32 i = 0; i < Metrics::kFrameTimeHistory; ++i) {
+      metrics.end_frame(1.0);
+    }
+    CHECK(metrics.frame_time_percentile(1.0) == 1.0);
+  }
+}
+
+}  // namespace ad
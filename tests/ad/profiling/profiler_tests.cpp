@@ -0,0 +1,103 @@
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <thread>
+
+#include "ad/profiling/profiler.h"
+
+namespace ad {
+
+namespace {
+
+MemSize count_occurrences(const std::string& text, const std::string& pattern) {
+  MemSize count = 0;
+  for (auto pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + pattern.size())) {
+    ++count;
+  }
+  return count;
+}
+
+std::string export_trace(const Profiler& profiler, U64 frame_count) {
+  std::ostringstream out;
+  profiler.export_chrome_trace(out, frame_count);
+  return out.str();
+}
+
+}  // namespace
+
+TEST_CASE("Profiler") {
+  SECTION("zones are exported as complete events") {
+    Profiler profiler;
+    {
+      ProfileZone outer{"outer", profiler};
+      ProfileZone inner{"inner \"quoted\"", profiler};
+    }
+
+    auto trace = export_trace(profiler, 0);
+    CHECK(trace.find("\"traceEvents\"") != std::string::npos);
+    CHECK(count_occurrences(trace, "\"ph\":\"X\"") == 2);
+    CHECK(trace.find("\"name\":\"outer\"") != std::string::npos);
+    CHECK(trace.find("\"name\":\"inner \\\"quoted\\\"\"") != std::string::npos);
+  }
+
+  SECTION("nothing is recorded while not recording") {
+    Profiler profiler;
+    profiler.set_recording(false);
+    {
+      ProfileZone zone{"ignored", profiler};
+    }
+
+    CHECK(count_occurrences(export_trace(profiler, 0), "\"ph\":\"X\"") == 0);
+  }
+
+  SECTION("each thread gets its own track") {
+    Profiler profiler;
+    { ProfileZone zone{"main", profiler}; }
+    std::thread{[&profiler] { ProfileZone zone{"worker", profiler}; }}.join();
+
+    auto trace = export_trace(profiler, 0);
+    CHECK(trace.find("\"tid\":0") != std::string::npos);
+    CHECK(trace.find("\"tid\":1") != std::string::npos);
+  }
+
+  SECTION("only the requested complete frames are exported") {
+    Profiler profiler;
+    for (U32 frame = 0; frame < 5; ++frame) {
+      profiler.begin_frame();
+      ProfileZone zone{"frame work", profiler};
+    }
+    // Frame 4 is still running.
+    profiler.begin_frame();
+    { ProfileZone zone{"in progress", profiler}; }
+
+    auto trace = export_trace(profiler, 2);
+    CHECK(count_occurrences(trace, "\"name\":\"frame work\"") == 2);
+    CHECK(count_occurrences(trace, "\"ph\":\"i\"") == 2);
+    CHECK(trace.find("in progress") == std::string::npos);
+  }
+
+  SECTION("full buffers keep the newest zones") {
+    Profiler profiler;
+    for (U32 i = 0; i < Profiler::kEventsPerThread; ++i) {
+      profiler.record("old", 1, 2);
+    }
+    profiler.record("new", 3, 4);
+
+    auto trace = export_trace(profiler, 0);
+    CHECK(count_occurrences(trace, "\"ph\":\"X\"") == Profiler::kEventsPerThread);
+    CHECK(count_occurrences(trace, "\"name\":\"new\"") == 1);
+  }
+
+  SECTION("clear drops everything") {
+    Profiler profiler;
+    profiler.begin_frame();
+    profiler.record("zone", 1, 2);
+    profiler.clear();
+
+    CHECK(profiler.frame_count() == 0);
+    CHECK(count_occurrences(export_trace(profiler, 0), "\"ph\":\"X\"") == 0);
+  }
+}
+
+}  // namespace ad
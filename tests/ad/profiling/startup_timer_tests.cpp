@@ -0,0 +1,29 @@
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <thread>
+
+#include "ad/profiling/startup_timer.h"
+
+namespace ad {
+
+TEST_CASE("StartupTimer") {
+  StartupTimer timer;
+  std::this_thread::sleep_for(std::chrono::milliseconds{2});
+  timer.end_phase("load");
+  timer.end_phase("populate");
+
+  REQUIRE(timer.phases().size() == 2);
+  CHECK(std::string{timer.phases()[0].name} == "load");
+  CHECK(timer.phases()[0].ms >= 2.0);
+  CHECK(timer.phases()[1].ms >= 0.0);
+  CHECK(timer.total_ms() == Approx(timer.phases()[0].ms + timer.phases()[1].ms));
+
+  std::ostringstream out;
+  timer.write(out);
+  auto text = out.str();
+  CHECK(text.find("load") < text.find("populate"));
+  CHECK(text.find("populate") < text.find("total"));
+}
+
+}  // namespace ad
@@ -0,0 +1,538 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <utility>
+
+#include "ad/world/draw_list.h"
+#include "ad/world/world.h"
+
+namespace ad {
+
+TEST_CASE("DrawList") {
+  le::RenderModel asteroid_model;
+  le::RenderModel miner_model;
+
+  SECTION("keys order by kind, then model, then material, then depth") {
+    auto near_asteroid = DrawList::make_key(DrawKind::Entity, 0, 0, 0.1f);
+    auto far_asteroid = DrawList::make_key(DrawKind::Entity, 0, 0, 0.9f);
+    auto near_miner = DrawList::make_key(DrawKind::Entity, 1, 0, 0.0f);
+    auto link = DrawList::make_key(DrawKind::Link, 0, 0, 0.0f);
+    auto circle = DrawList::make_key(DrawKind::SelectionCircle, 0, 0, 1.0f);
+    auto highlighted_circle = DrawList::make_key(DrawKind::SelectionCircle, 0, 1, 0.0f);
+
+    CHECK(near_asteroid < far_asteroid);
+    CHECK(far_asteroid < near_miner);
+    CHECK(near_miner < link);
+    CHECK(link < circle);
+    CHECK(circle < highlighted_circle);
+
+    // Depth outside the view is clamped instead of spilling into the other fields.
+    CHECK(DrawList::make_key(DrawKind::Entity, 0, 0, 2.0f) ==
+          DrawList::make_key(DrawKind::Entity, 0, 0, 1.0f));
+    CHECK(DrawList::make_key(DrawKind::Entity, 0, 0, -1.0f) ==
+          DrawList::make_key(DrawKind::Entity, 0, 0, 0.0f));
+  }
+
+  SECTION("sorting merges commands with the same model into batches") {
+    DrawList draw_list;
+    draw_list.add_model(DrawKind::Entity, &asteroid_model, fl::Mat4::identity, 0.5f);
+    draw_list.add_circle(fl::Mat4::identity, 1.0f, 16, false, 0.5f);
+    draw_list.add_model(DrawKind::Entity, &miner_model, fl::Mat4::identity, 0.2f);
+    draw_list.add_model(DrawKind::Entity, &asteroid_model, fl::Mat4::identity, 0.1f);
+    draw_list.add_circle(fl::Mat4::identity, 2.0f, 16, true, 0.1f);
+    draw_list.add_model(DrawKind::Entity, &miner_model, fl::Mat4::identity, 0.3f);
+    draw_list.sort();
+
+    // The build order is kept.
+    REQUIRE(draw_list.size() == 6);
+    CHECK(draw_list.commands()[1].kind == DrawKind::SelectionCircle);
+
+    struct Batch {
+      DrawKind kind;
+      le::RenderModel* model;
+      MemSize count;
+      F32 first_radius;
+    };
+    nu::DynamicArray<Batch> batches;
+    draw_list.for_each_batch([&](const DrawCommand* commands, const fl::Mat4*, MemSize count) {
+      batches.emplaceBack(Batch{commands[0].kind, commands[0].model, count, commands[0].radius});
+    });
+
+    REQUIRE(batches.size() == 3);
+    CHECK(batches[0].model == &asteroid_model);
+    CHECK(batches[0].count == 2);
+    CHECK(batches[1].model == &miner_model);
+    CHECK(batches[1].count == 2);
+    CHECK(batches[2].kind == DrawKind::SelectionCircle);
+    CHECK(batches[2].count == 2);
+    // The plain circle sorts before the highlighted one.
+    CHECK(batches[2].first_radius == 1.0f);
+  }
+
+  SECTION("appending keeps the batches of lists that saw models in another order") {
+    DrawList first;
+    first.add_model(DrawKind::Entity, &asteroid_model, fl::Mat4::identity, 0.5f);
+    DrawList second;
+    second.add_model(DrawKind::Entity, &miner_model, fl::Mat4::identity, 0.1f);
+    second.add_model(DrawKind::Entity, &asteroid_model, fl::Mat4::identity, 0.2f);
+
+    DrawList merged;
+    merged.append(first);
+    merged.append(second);
+    merged.sort();
+
+    nu::DynamicArray<MemSize> counts;
+    merged.for_each_batch([&](const DrawCommand* commands, const fl::Mat4*, MemSize count) {
+      CHECK(commands[0].model == (counts.isEmpty() ? &asteroid_model : &miner_model));
+      counts.emplaceBack(count);
+    });
+    REQUIRE(counts.size() == 2);
+    CHECK(counts[0] == 2);
+    CHECK(counts[1] == 1);
+  }
+
+  SECTION("building on the job system gives the same commands") {
+    World world;
+
+    Entity asteroid;
+    asteroid.type = EntityType::Asteroid;
+    asteroid.flags = ENTITY_FLAG_MINABLE;
+    asteroid.render.model = &asteroid_model;
+
+    Entity hub;
+    hub.type = EntityType::Hub;
+    hub.building.selection_radius = 1.5f;
+    hub.render.model = &miner_model;
+
+    for (I32 y = -50; y < 50; ++y) {
+      for (I32 x = -50; x < 50; ++x) {
+        auto* prefab = (x + y) % 7 == 0 ? &hub : &asteroid;
+        world.add_entity_from_prefab(prefab, {static_cast<F32>(x), static_cast<F32>(y)});
+      }
+    }
+
+    auto projection_and_view = fl::Mat4::identity;
+    projection_and_view.col[0] = {0.02f, 0.0f, 0.0f, 0.0f};
+    projection_and_view.col[1] = {0.0f, 0.02f, 0.0f, 0.0f};
+    projection_and_view.col[2] = {0.0f, 0.0f, -0.1f, 0.0f};
+
+    world.set_cursor_position({-7.0f, 7.0f});
+
+    // Commands are added in a different order, but with the same keys.
+    auto sorted_keys = [&](const DrawList& draw_list) {
+      nu::DynamicArray<std::pair<U64, le::RenderModel*>> keys;
+      for (const auto& command : draw_list.commands()) {
+        keys.emplaceBack(command.key, command.model);
+      }
+      std::sort(keys.begin(), keys.end());
+      return keys;
+    };
+
+    DrawList serial;
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &serial);
+
+    JobSystem job_system{3};
+    world.set_job_system(&job_system);
+    DrawList parallel;
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &parallel);
+
+    REQUIRE(serial.size() > 10'000);
+    REQUIRE(parallel.size() == serial.size());
+    auto serial_keys = sorted_keys(serial);
+    auto parallel_keys = sorted_keys(parallel);
+    for (MemSize i = 0; i < serial_keys.size(); ++i) {
+      REQUIRE(parallel_keys[i] == serial_keys[i]);
+    }
+  }
+
+  SECTION("World builds commands for what is in view") {
+    World world;
+
+    Entity asteroid;
+    asteroid.type = EntityType::Asteroid;
+    asteroid.flags = ENTITY_FLAG_MINABLE;
+    asteroid.render.model = &asteroid_model;
+
+    Entity hub;
+    hub.type = EntityType::Hub;
+    hub.building.selection_radius = 1.5f;
+    hub.render.model = &miner_model;
+
+    world.add_entity_from_prefab(&asteroid, {0.0f, 0.0f});
+    world.add_entity_from_prefab(&asteroid, {5.0f, 0.0f});
+    world.add_entity_from_prefab(&hub, {-5.0f, 0.0f});
+    // Far outside the view.
+    world.add_entity_from_prefab(&asteroid, {500.0f, 0.0f});
+    world.add_entity_from_prefab(&hub, {0.0f, 500.0f});
+
+    // Orthographic view of 20 by 20 units around the origin.
+    auto projection_and_view = fl::Mat4::identity;
+    projection_and_view.col[0] = {0.1f, 0.0f, 0.0f, 0.0f};
+    projection_and_view.col[1] = {0.0f, 0.1f, 0.0f, 0.0f};
+    projection_and_view.col[2] = {0.0f, 0.0f, -0.1f, 0.0f};
+
+    // Only the hovered hub's circle is generated, and without templates the other one is skipped.
+    world.set_cursor_position({-5.0f, 0.0f});
+
+    DrawList draw_list;
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+
+    MemSize asteroids = 0;
+    MemSize hubs = 0;
+    MemSize circles = 0;
+    for (const auto& command : draw_list.commands()) {
+      if (command.kind == DrawKind::SelectionCircle) {
+        ++circles;
+        CHECK(command.radius == 1.5f);
+        CHECK(command.highlighted);
+        CHECK(command.model == nullptr);
+      } else if (command.model == &asteroid_model) {
+        ++asteroids;
+      } else if (command.model == &miner_model) {
+        ++hubs;
+      }
+    }
+    CHECK(asteroids == 2);
+    CHECK(hubs == 1);
+    CHECK(circles == 1);
+
+    // An entity whose model failed to load is not drawn.
+    asteroid.render.model = nullptr;
+    world.add_entity_from_prefab(&asteroid, {2.0f, 2.0f});
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+    for (const auto& command : draw_list.commands()) {
+      CHECK((command.kind == DrawKind::SelectionCircle || command.model != nullptr));
+    }
+    CHECK(draw_list.size() == 4);
+  }
+
+  SECTION("selection circles come from templates picked by screen size") {
+    CHECK(circle_lod(4.0f) == 0);
+    CHECK(circle_lod(20.0f) == 1);
+    CHECK(circle_lod(200.0f) == 2);
+
+    World world;
+
+    le::RenderModel rings[kCircleLodCount];
+    for (U32 lod = 0; lod < kCircleLodCount; ++lod) {
+      world.set_circle_template(lod, &rings[lod]);
+    }
+    world.set_viewport_height(1000.0f);
+
+    Entity hub;
+    hub.type = EntityType::Hub;
+    hub.building.selection_radius = 2.0f;
+    hub.render.model = &miner_model;
+    world.add_entity_from_prefab(&hub, {0.0f, 0.0f});
+    world.add_entity_from_prefab(&hub, {5.0f, 0.0f});
+    world.set_cursor_position({5.0f, 0.0f});
+
+    auto circles_for_view = [&](F32 half_size) {
+      auto projection_and_view = fl::Mat4::identity;
+      projection_and_view.col[0] = {1.0f / half_size, 0.0f, 0.0f, 0.0f};
+      projection_and_view.col[1] = {0.0f, 1.0f / half_size, 0.0f, 0.0f};
+      projection_and_view.col[2] = {0.0f, 0.0f, -0.1f, 0.0f};
+
+      DrawList draw_list;
+      world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+
+      nu::DynamicArray<DrawCommand> circles;
+      for (const auto& command : draw_list.commands()) {
+        if (command.kind == DrawKind::SelectionCircle) {
+          circles.emplaceBack(command);
+        }
+      }
+      return circles;
+    };
+
+    // A 2 unit radius is 10 pixels when 100 units fill the 1000 pixels.
+    auto circles = circles_for_view(100.0f);
+    REQUIRE(circles.size() == 2);
+    for (const auto& circle : circles) {
+      if (circle.model) {
+        CHECK(circle.model == &rings[0]);
+        // The unit ring is scaled up to the selection radius.
+        CHECK(circle.transform.col[0].x == Approx(2.0f));
+      } else {
+        // The hovered hub.
+        CHECK(circle.highlighted);
+        CHECK(circle.segments == 16);
+      }
+    }
+
+    // And 200 pixels when 10 units fill them.
+    circles = circles_for_view(10.0f);
+    REQUIRE(circles.size() == 2);
+    for (const auto& circle : circles) {
+      if (circle.model) {
+        CHECK(circle.model == &rings[2]);
+      } else {
+        CHECK(circle.segments == 64);
+      }
+    }
+  }
+
+  SECTION("model matrices are cached until the entity moves") {
+    World world;
+
+    Entity fighter;
+    fighter.type = EntityType::EnemyFighter;
+    fighter.movement.speed = 100.0f;
+    fighter.render.model = &miner_model;
+    auto fighter_id = world.add_entity_from_prefab(&fighter, {0.0f, 0.0f});
+
+    auto projection_and_view = fl::Mat4::identity;
+    projection_and_view.col[0] = {0.1f, 0.0f, 0.0f, 0.0f};
+    projection_and_view.col[1] = {0.0f, 0.1f, 0.0f, 0.0f};
+    projection_and_view.col[2] = {0.0f, 0.0f, -0.1f, 0.0f};
+
+    DrawList draw_list;
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+    REQUIRE(draw_list.size() == 1);
+    CHECK(draw_list.commands()[0].transform.col[3].x == 0.0f);
+
+    world.tick(1.0f);
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+    REQUIRE(draw_list.size() == 1);
+    auto position = world.entities().get(fighter_id).position();
+    CHECK(draw_list.commands()[0].transform.col[3].x == Approx(position.x));
+    CHECK(draw_list.commands()[0].transform.col[3].y == Approx(position.y));
+
+    // The submitted matrices are the projection-view times the model matrix.
+    draw_list.sort();
+    draw_list.compute_mvps(projection_and_view);
+    draw_list.for_each_batch([&](const DrawCommand* commands, const fl::Mat4* mvps, MemSize) {
+      CHECK(commands[0].transform.col[3].x == Approx(position.x));
+      CHECK(mvps[0].col[3].x == Approx(0.1f * position.x));
+    });
+  }
+
+  SECTION("links are batched and only rebuilt when buildings change") {
+    World world;
+
+    le::RenderModel link_model;
+    le::RenderModel laser_model;
+    world.set_segment_models(&link_model, &laser_model);
+
+    // A triangle one unit long along y.
+    MeshData link_mesh;
+    link_mesh.vertices.emplaceBack(MeshVertex{{-0.5f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {}});
+    link_mesh.vertices.emplaceBack(MeshVertex{{0.5f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {}});
+    link_mesh.vertices.emplaceBack(MeshVertex{{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {}});
+    for (U32 index = 0; index < 3; ++index) {
+      link_mesh.indices.emplaceBack(index);
+    }
+    link_mesh.material_library = "link.mtl";
+    MeshMaterial palette;
+    std::copy_n("palette", 8, palette.name);
+    palette.index_count = 3;
+    link_mesh.materials.emplaceBack(palette);
+    world.set_link_mesh(std::move(link_mesh));
+
+    le::RenderModel batch_model;
+    MeshData uploaded;
+    U32 releases = 0;
+    world.set_link_batch_uploader(
+        [&](const MeshData& mesh) {
+          uploaded = mesh;
+          return &batch_model;
+        },
+        [&](le::RenderModel* model) {
+          CHECK(model == &batch_model);
+          ++releases;
+        });
+
+    Entity hub;
+    hub.type = EntityType::Hub;
+    hub.flags = ENTITY_FLAG_LINKABLE;
+    hub.building.selection_radius = 1.0f;
+    hub.render.model = &miner_model;
+
+    Entity turret = hub;
+    turret.type = EntityType::Turret;
+    turret.flags = ENTITY_FLAG_NEEDS_LINK;
+
+    Entity asteroid;
+    asteroid.type = EntityType::Asteroid;
+    asteroid.flags = ENTITY_FLAG_MINABLE;
+    asteroid.render.model = &asteroid_model;
+
+    Entity miner;
+    miner.type = EntityType::Miner;
+    miner.mining.cycle_duration = 100.0f;
+    miner.render.model = &miner_model;
+
+    auto hub_id = world.add_entity_from_prefab(&hub, {0.0f, 0.0f});
+    world.add_entity_from_prefab(&turret, {5.0f, 0.0f});
+    world.add_entity_from_prefab(&turret, {-5.0f, 0.0f});
+    world.add_entity_from_prefab(&asteroid, {0.0f, 6.0f});
+    world.add_entity_from_prefab(&miner, {0.0f, 4.0f});
+
+    auto projection_and_view = fl::Mat4::identity;
+    projection_and_view.col[0] = {0.1f, 0.0f, 0.0f, 0.0f};
+    projection_and_view.col[1] = {0.0f, 0.1f, 0.0f, 0.0f};
+    projection_and_view.col[2] = {0.0f, 0.0f, -0.1f, 0.0f};
+
+    auto count = [](const DrawList& draw_list, DrawKind kind) {
+      MemSize result = 0;
+      for (const auto& command : draw_list.commands()) {
+        result += command.kind == kind ? 1 : 0;
+      }
+      return result;
+    };
+
+    DrawList draw_list;
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+    CHECK(count(draw_list, DrawKind::Link) == 1);
+    CHECK(count(draw_list, DrawKind::Laser) == 1);
+    CHECK(world.link_batch_rebuilds() == 1);
+    CHECK(uploaded.vertices.size() == 2 * 3);
+    CHECK(uploaded.indices.size() == 2 * 3);
+
+    // Every link keeps the link's material, drawn as one range.
+    CHECK(uploaded.material_library == "link.mtl");
+    REQUIRE(uploaded.materials.size() == 1);
+    CHECK(uploaded.materials[0].name_view() == "palette");
+    CHECK(uploaded.materials[0].index_count == 2 * 3);
+
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+    CHECK(count(draw_list, DrawKind::Link) == 1);
+    CHECK(world.link_batch_rebuilds() == 1);
+    CHECK(releases == 0);
+
+    for (const auto& command : draw_list.commands()) {
+      if (command.kind == DrawKind::Link) {
+        CHECK(command.model == &batch_model);
+      }
+    }
+
+    // Every copy of the triangle starts at its turret and is stretched to the hub, 5 units away.
+    for (MemSize first = 0; first < uploaded.vertices.size(); first += 3) {
+      auto base = (uploaded.vertices[first].position.xy() +
+                   uploaded.vertices[first + 1].position.xy()) *
+                  0.5f;
+      auto tip = uploaded.vertices[first + 2].position.xy();
+      CHECK(std::abs(base.x) == Approx(5.0f));
+      CHECK(base.y == Approx(0.0f).margin(0.0001f));
+      CHECK(fl::distance(base, tip) == Approx(5.0f));
+      CHECK(uploaded.vertices[first].normal.z == Approx(1.0f));
+      CHECK(uploaded.indices[first] == first);
+    }
+
+    world.add_entity_from_prefab(&turret, {0.0f, -5.0f});
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+    CHECK(count(draw_list, DrawKind::Link) == 1);
+    CHECK(world.link_batch_rebuilds() == 2);
+    CHECK(releases == 1);
+    CHECK(uploaded.vertices.size() == 3 * 3);
+
+    // The batch goes back to the uploader it came from, after that links are drawn one by one.
+    world.clear_link_batch_uploader();
+    CHECK(releases == 2);
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+    CHECK(count(draw_list, DrawKind::Link) == 3);
+
+    world.destroy_entity(hub_id);
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+    CHECK(count(draw_list, DrawKind::Link) == 0);
+    CHECK(releases == 2);
+  }
+
+  SECTION("without an uploader every link is drawn on its own") {
+    World world;
+
+    le::RenderModel link_model;
+    le::RenderModel laser_model;
+    world.set_segment_models(&link_model, &laser_model);
+
+    Entity hub;
+    hub.type = EntityType::Hub;
+    hub.flags = ENTITY_FLAG_LINKABLE;
+    hub.building.selection_radius = 1.0f;
+    hub.render.model = &miner_model;
+
+    Entity turret = hub;
+    turret.type = EntityType::Turret;
+    turret.flags = ENTITY_FLAG_NEEDS_LINK;
+
+    world.add_entity_from_prefab(&hub, {0.0f, 0.0f});
+    world.add_entity_from_prefab(&turret, {5.0f, 0.0f});
+    world.add_entity_from_prefab(&turret, {-5.0f, 0.0f});
+
+    auto projection_and_view = fl::Mat4::identity;
+    projection_and_view.col[0] = {0.1f, 0.0f, 0.0f, 0.0f};
+    projection_and_view.col[1] = {0.0f, 0.1f, 0.0f, 0.0f};
+    projection_and_view.col[2] = {0.0f, 0.0f, -0.1f, 0.0f};
+
+    DrawList draw_list;
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+
+    // Stretched from the turret at (5, 0) to the hub at the origin, which is 5 units long.
+    MemSize links = 0;
+    for (const auto& command : draw_list.commands()) {
+      if (command.kind != DrawKind::Link) {
+        continue;
+      }
+      ++links;
+      CHECK(command.model == &link_model);
+      if (command.transform.col[3].x == 5.0f) {
+        CHECK(command.transform.col[3].y == 0.0f);
+      }
+    }
+    CHECK(links == 2);
+  }
+}
+
+TEST_CASE("Draw list build benchmark", "[.benchmark]") {
+  constexpr I32 kSide = 450;
+  constexpr U32 kFrames = 10;
+
+  le::RenderModel asteroid_model;
+  Entity asteroid;
+  asteroid.type = EntityType::Asteroid;
+  asteroid.flags = ENTITY_FLAG_MINABLE;
+  asteroid.render.model = &asteroid_model;
+
+  World world;
+  for (I32 y = 0; y < kSide; ++y) {
+    for (I32 x = 0; x < kSide; ++x) {
+      world.add_entity_from_prefab(&asteroid, {static_cast<F32>(x), static_cast<F32>(y)});
+    }
+  }
+
+  // Everything is in view.
+  auto projection_and_view = fl::Mat4::identity;
+  projection_and_view.col[0] = {2.0f / kSide, 0.0f, 0.0f, 0.0f};
+  projection_and_view.col[1] = {0.0f, 2.0f / kSide, 0.0f, 0.0f};
+  projection_and_view.col[2] = {0.0f, 0.0f, -0.1f, 0.0f};
+  projection_and_view.col[3] = {-1.0f, -1.0f, 0.0f, 1.0f};
+
+  auto time = [&](JobSystem* job_system) {
+    world.set_job_system(job_system);
+    DrawList draw_list;
+    world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+
+    auto start = std::chrono::steady_clock::now();
+    for (U32 frame = 0; frame < kFrames; ++frame) {
+      world.build_draw_list(projection_and_view, nullptr, 1.0f, &draw_list);
+      draw_list.sort();
+      draw_list.compute_mvps(projection_and_view);
+    }
+    std::chrono::duration<F64, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    LOG(Info) << draw_list.size() << " commands on "
+              << (job_system ? job_system->thread_count() : 1) << " threads: "
+              << elapsed.count() / kFrames << " ms per frame";
+  };
+
+  time(nullptr);
+  for (U32 workers = 1; workers < std::thread::hardware_concurrency(); workers *= 2) {
+    JobSystem job_system{workers};
+    time(&job_system);
+  }
+}
+
+}  // namespace ad
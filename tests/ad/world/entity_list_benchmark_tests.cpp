@@ -0,0 +1,239 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+
+#include "ad/world/entity_list.hpp"
+#include "ad/world/random.h"
+
+// Times the query adaptors from `entity_list.hpp` against hand-written loops over the archetype
+// columns, and compares every result to a baseline file:
+//
+//   AD_BENCHMARK_BASELINE   path of the baseline file (entity_list_benchmark_baseline.txt)
+//   AD_BENCHMARK_THRESHOLD  allowed slowdown against the baseline, in percent (20)
+//   AD_BENCHMARK_UPDATE     if set, the results are written as the new baseline
+//
+// Baselines depend on the machine, so none is committed. Without a baseline file the benchmark
+// warns and skips. To seed one, run it once on the machine that compares against it:
+//
+//   AD_BENCHMARK_UPDATE=1 ad_tests "[.benchmark]"
+
+namespace ad {
+
+namespace {
+
+const char* env_or(const char* name, const char* fallback) {
+  auto* value = std::getenv(name);
+  return value ? value : fallback;
+}
+
+// Baseline file with one "<name> <ns>" line per measurement.
+class Baseline {
+public:
+  explicit Baseline(std::string path) : path_{std::move(path)} {
+    auto* file = std::fopen(path_.c_str(), "r");
+    if (!file) {
+      return;
+    }
+
+    char name[128];
+    F64 ns;
+    while (std::fscanf(file, "%127s %lf", name, &ns) == 2) {
+      expected_[name] = ns;
+    }
+    std::fclose(file);
+  }
+
+  NU_NO_DISCARD bool is_empty() const {
+    return expected_.empty();
+  }
+
+  // Returns the baseline for `name`, or 0 if there is none.
+  NU_NO_DISCARD F64 expected(const std::string& name) const {
+    auto it = expected_.find(name);
+    return it != expected_.end() ? it->second : 0.0;
+  }
+
+  void record(const std::string& name, F64 ns) {
+    actual_[name] = ns;
+  }
+
+  void save() const {
+    auto* file = std::fopen(path_.c_str(), "w");
+    if (!file) {
+      LOG(Warning) << "Could not write benchmark baseline to " << path_;
+      return;
+    }
+
+    for (const auto& [name, ns] : actual_) {
+      std::fprintf(file, "%s %.3f\n", name.c_str(), ns);
+    }
+    std::fclose(file);
+  }
+
+private:
+  std::string path_;
+  std::map<std::string, F64> expected_;
+  std::map<std::string, F64> actual_;
+};
+
+// Fastest of a few runs, which filters out most of the noise from other processes.
+template <typename Func>
+F64 measure_ns(Func&& func) {
+  constexpr U32 kRuns = 7;
+  constexpr U32 kIterations = 20;
+
+  F64 best = std::numeric_limits<F64>::max();
+  for (U32 run = 0; run < kRuns; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    for (U32 i = 0; i < kIterations; ++i) {
+      func();
+    }
+    std::chrono::duration<F64, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / kIterations);
+  }
+  return best;
+}
+
+// Entities spread over a square, with `ENTITY_FLAG_MINABLE` on `selectivity` of them. Half of
+// them move, so queries have to cross more than one archetype.
+void populate(EntityList* entities, MemSize count, F32 selectivity) {
+  Random random{static_cast<U64>(count)};
+  auto stream = random.stream(0);
+  auto extent = std::sqrt(static_cast<F32>(count)) * 5.0f;
+
+  for (MemSize i = 0; i < count; ++i) {
+    Entity prefab;
+    prefab.flags = stream.next_float() < selectivity ? ENTITY_FLAG_MINABLE : 0;
+    prefab.position = {stream.next_float() * extent, stream.next_float() * extent};
+    prefab.movement.speed = (i % 2) ? 10.0f : 0.0f;
+    entities->add(prefab);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("EntityList query benchmark", "[.benchmark]") {
+  std::string path = env_or("AD_BENCHMARK_BASELINE", "entity_list_benchmark_baseline.txt");
+  Baseline baseline{path};
+  auto threshold = std::strtod(env_or("AD_BENCHMARK_THRESHOLD", "20"), nullptr) / 100.0;
+  auto update = std::getenv("AD_BENCHMARK_UPDATE") != nullptr;
+
+  if (baseline.is_empty() && !update) {
+    WARN("No benchmark baseline at " << path
+                                     << ", skipping. Run with AD_BENCHMARK_UPDATE=1 to write one.");
+    return;
+  }
+
+  // Keeps the compiler from dropping the queries.
+  U64 sink = 0;
+
+  auto report = [&](const std::string& name, F64 ns) {
+    baseline.record(name, ns);
+
+    auto expected = baseline.expected(name);
+    LOG(Info) << name << ": " << ns << " ns (baseline " << expected << " ns)";
+
+    if (!update && expected > 0.0) {
+      INFO(name << " took " << ns << " ns, baseline is " << expected << " ns");
+      CHECK(ns <= expected * (1.0 + threshold));
+    }
+  };
+
+  for (MemSize count : {1'000, 10'000, 100'000}) {
+    for (F32 selectivity : {0.01f, 0.1f, 0.5f}) {
+      EntityList entities;
+      populate(&entities, count, selectivity);
+
+      auto center = fl::Vec2{std::sqrt(static_cast<F32>(count)) * 2.5f,
+                             std::sqrt(static_cast<F32>(count)) * 2.5f};
+      auto excluded = entities.get(EntityId{0}).id();
+      constexpr F32 kRadius = 20.0f;
+
+      auto prefix = std::to_string(count) + "/" +
+                    std::to_string(static_cast<U32>(selectivity * 100.0f)) + "%/";
+
+      // matching_mask
+
+      report(prefix + "matching_mask/pipeline", measure_ns([&] {
+               for (auto&& entity : entities | matching_mask(ENTITY_FLAG_MINABLE)) {
+                 sink += entity.id().index;
+               }
+             }));
+
+      report(prefix + "matching_mask/loop", measure_ns([&] {
+               for (auto& archetype : entities.archetypes()) {
+                 for (MemSize i = 0; i < archetype.size(); ++i) {
+                   if (NU_BIT_IS_SET(archetype.flags[i], ENTITY_FLAG_MINABLE)) {
+                     sink += archetype.ids[i].index;
+                   }
+                 }
+               }
+             }));
+
+      // closest(matching_mask)
+
+      report(prefix + "closest/pipeline", measure_ns([&] {
+               sink += closest(entities | matching_mask(ENTITY_FLAG_MINABLE), center).index;
+             }));
+
+      report(prefix + "closest/loop", measure_ns([&] {
+               F32 closest_distance = std::numeric_limits<F32>::max();
+               EntityId closest_id;
+               for (auto& archetype : entities.archetypes()) {
+                 for (MemSize i = 0; i < archetype.size(); ++i) {
+                   if (!NU_BIT_IS_SET(archetype.flags[i], ENTITY_FLAG_MINABLE)) {
+                     continue;
+                   }
+                   auto distance = fl::distance(center, archetype.positions[i]);
+                   if (distance <= closest_distance) {
+                     closest_distance = distance;
+                     closest_id = archetype.ids[i];
+                   }
+                 }
+               }
+               sink += closest_id.index;
+             }));
+
+      // closest(matching_mask | excluding_id | within_radius)
+
+      report(prefix + "closest_within_radius/pipeline", measure_ns([&] {
+               sink += closest(entities | matching_mask(ENTITY_FLAG_MINABLE) |
+                                   excluding_id(excluded) | within_radius(center, kRadius),
+                               center)
+                           .index;
+             }));
+
+      report(prefix + "closest_within_radius/loop", measure_ns([&] {
+               F32 closest_distance = std::numeric_limits<F32>::max();
+               EntityId closest_id;
+               for (auto& archetype : entities.archetypes()) {
+                 for (MemSize i = 0; i < archetype.size(); ++i) {
+                   if (!NU_BIT_IS_SET(archetype.flags[i], ENTITY_FLAG_MINABLE) ||
+                       archetype.ids[i] == excluded) {
+                     continue;
+                   }
+                   auto distance = fl::distance(center, archetype.positions[i]);
+                   if (distance <= kRadius && distance <= closest_distance) {
+                     closest_distance = distance;
+                     closest_id = archetype.ids[i];
+                   }
+                 }
+               }
+               sink += closest_id.index;
+             }));
+    }
+  }
+
+  CHECK(sink != 0);
+
+  if (update) {
+    baseline.save();
+  }
+}
+
+}  // namespace ad
@@ -0,0 +1,149 @@
+#include <catch2/catch.hpp>
+
+#include "ad/world/entity_list.hpp"
+
+namespace ad {
+
+TEST_CASE("EntityList") {
+  SECTION("entities are grouped by components") {
+    Entity asteroid;
+    asteroid.type = EntityType::Asteroid;
+    asteroid.flags = ENTITY_FLAG_MINABLE;
+    asteroid.building.selection_radius = 1.7f;
+
+    Entity miner;
+    miner.type = EntityType::Miner;
+    miner.flags = ENTITY_FLAG_NEEDS_LINK;
+    miner.electricity.electricity_delta = -5;
+    miner.mining.cycle_duration = 100.0f;
+
+    Entity fighter;
+    fighter.type = EntityType::EnemyFighter;
+    fighter.movement.speed = 10.0f;
+
+    EntityList entities;
+    auto asteroid_1 = entities.add(asteroid);
+    auto miner_1 = entities.add(miner);
+    auto asteroid_2 = entities.add(asteroid);
+    auto fighter_1 = entities.add(fighter);
+
+    CHECK(entities.size() == 4);
+    CHECK(entities.archetypes().size() == 3);
+
+    CHECK(entities.get(asteroid_1).has(COMPONENT_BUILDING));
+    CHECK(!entities.get(asteroid_1).has(COMPONENT_MINING));
+    CHECK(entities.get(miner_1).has(COMPONENT_BUILDING | COMPONENT_ELECTRICITY | COMPONENT_MINING));
+    CHECK(entities.get(fighter_1).has(COMPONENT_MOVEMENT));
+    CHECK(!entities.get(fighter_1).has(COMPONENT_BUILDING));
+
+    CHECK(entities.get(asteroid_2).id() == asteroid_2);
+    CHECK(entities.get(asteroid_2).type() == EntityType::Asteroid);
+    CHECK(entities.get(miner_1).mining().cycle_duration == 100.0f);
+
+    MemSize movement_count = 0;
+    entities.for_each_archetype(COMPONENT_MOVEMENT, [&](Archetype& archetype) {
+      movement_count += archetype.size();
+      CHECK(archetype.speeds.size() == archetype.size());
+      CHECK(archetype.mining.isEmpty());
+    });
+    CHECK(movement_count == 1);
+
+    CHECK(entities.count(EntityType::Asteroid) == 2);
+    CHECK(entities.count(EntityType::Miner) == 1);
+    CHECK(entities.count(EntityType::Hub) == 0);
+
+    entities.destroy(asteroid_1);
+    CHECK(entities.count(EntityType::Asteroid) == 1);
+
+    entities.clear();
+    CHECK(entities.count(EntityType::Asteroid) == 0);
+  }
+
+  SECTION("iterates every entity") {
+    EntityList entities;
+
+    Entity prefab;
+    for (U32 i = 0; i < 10; ++i) {
+      prefab.flags = (i % 2) ? ENTITY_FLAG_MINABLE : 0;
+      prefab.building.selection_radius = (i % 3) ? 1.0f : 0.0f;
+      entities.add(prefab);
+    }
+
+    MemSize count = 0;
+    for (auto entity : entities) {
+      CHECK(entity.id().is_valid());
+      ++count;
+    }
+    CHECK(count == 10);
+
+    MemSize minable = 0;
+    for (auto&& entity : entities | matching_mask(ENTITY_FLAG_MINABLE)) {
+      CHECK(entity.has_flags(ENTITY_FLAG_MINABLE));
+      ++minable;
+    }
+    CHECK(minable == 5);
+  }
+
+  SECTION("destroy") {
+    EntityList entities;
+
+    Entity prefab;
+    prefab.building.selection_radius = 1.0f;
+
+    auto first = entities.add(prefab);
+    auto second = entities.add(prefab);
+    auto third = entities.add(prefab);
+    entities.get(third).position() = {3.0f, 3.0f};
+
+    CHECK(entities.destroy(first));
+    CHECK(!entities.destroy(first));
+
+    CHECK(entities.size() == 2);
+    CHECK(!entities.is_alive(first));
+    CHECK(entities.is_alive(second));
+    CHECK(entities.is_alive(third));
+
+    // The last row was moved into the hole, the handle still finds it.
+    CHECK(entities.get(third).id() == third);
+    CHECK(entities.get(third).position() == fl::Vec2{3.0f, 3.0f});
+
+    // The slot is reused, but the old handle stays stale.
+    auto fourth = entities.add(prefab);
+    CHECK(fourth.index == first.index);
+    CHECK(fourth.generation != first.generation);
+    CHECK(!entities.is_alive(first));
+    CHECK(entities.is_alive(fourth));
+
+    entities.clear();
+    CHECK(entities.size() == 0);
+    CHECK(!entities.is_alive(second));
+    CHECK(!entities.is_alive(fourth));
+  }
+
+  SECTION("spawning and destroying reuses slots") {
+    EntityList entities;
+
+    Entity prefab;
+    prefab.movement.speed = 1.0f;
+
+    nu::DynamicArray<EntityId> alive;
+    for (U32 i = 0; i < 100; ++i) {
+      alive.emplaceBack(entities.add(prefab));
+    }
+
+    for (U32 round = 0; round < 50; ++round) {
+      for (auto& entity_id : alive) {
+        CHECK(entities.destroy(entity_id));
+        entity_id = entities.add(prefab);
+      }
+    }
+
+    CHECK(entities.size() == 100);
+    for (auto& entity_id : alive) {
+      CHECK(entity_id.index < 100);
+      CHECK(entities.get(entity_id).id() == entity_id);
+    }
+  }
+}
+
+}  // namespace ad
@@ -0,0 +1,109 @@
+#include <catch2/catch.hpp>
+
+#include <random>
+
+#include "ad/profiling/metrics.h"
+#include "ad/world/entity_picker.h"
+
+namespace ad {
+
+TEST_CASE("EntityPicker") {
+  SECTION("basic") {
+    EntityPicker picker;
+
+    picker.insert(EntityId{0}, {0.0f, 0.0f}, 2.5f);
+    picker.insert(EntityId{1}, {10.0f, 0.0f}, 1.5f);
+
+    CHECK(picker.pick({1.0f, 1.0f}) == EntityId{0});
+    CHECK(picker.pick({10.5f, 0.0f}) == EntityId{1});
+    CHECK(!picker.pick({5.0f, 0.0f}).is_valid());
+
+    // Moving inside the same cell still picks correctly from the cached candidates.
+    CHECK(picker.pick({11.0f, 0.1f}) == EntityId{1});
+    CHECK(!picker.pick({11.9f, 1.9f}).is_valid());
+
+    picker.remove(EntityId{1});
+    CHECK(!picker.pick({10.5f, 0.0f}).is_valid());
+
+    picker.update(EntityId{0}, {20.0f, 20.0f});
+    CHECK(!picker.pick({1.0f, 1.0f}).is_valid());
+    CHECK(picker.pick({20.0f, 21.0f}) == EntityId{0});
+  }
+
+  SECTION("matches brute force") {
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<F32> coordinate{-100.0f, 100.0f};
+    std::uniform_real_distribution<F32> radius{0.5f, 3.0f};
+
+    struct Selectable {
+      fl::Vec2 position;
+      F32 radius;
+    };
+    nu::DynamicArray<Selectable> selectables;
+
+    EntityPicker picker;
+    for (U32 i = 0; i < 2000; ++i) {
+      fl::Vec2 position{coordinate(rng), coordinate(rng)};
+      auto result = selectables.emplaceBack(Selectable{position, radius(rng)});
+      picker.insert(EntityId{static_cast<U32>(result.index())}, result.element().position,
+                    result.element().radius);
+    }
+
+    // Walk the cursor in small steps, so that most picks stay inside the same cell.
+    fl::Vec2 cursor{-100.0f, -100.0f};
+    for (U32 step = 0; step < 5000; ++step) {
+      cursor += fl::Vec2{0.37f, 0.29f};
+      if (cursor.x > 100.0f) {
+        cursor.x -= 200.0f;
+      }
+      if (cursor.y > 100.0f) {
+        cursor.y -= 200.0f;
+      }
+
+      EntityId expected;
+      F32 closest_distance = std::numeric_limits<F32>::max();
+      for (U32 i = 0; i < selectables.size(); ++i) {
+        auto distance = fl::distance(selectables[i].position, cursor);
+        if (distance < selectables[i].radius && distance < closest_distance) {
+          closest_distance = distance;
+          expected = EntityId{i};
+        }
+      }
+
+      CHECK(picker.pick(cursor) == expected);
+    }
+  }
+
+  SECTION("moving entities keep the cached candidates") {
+    auto& metrics = Metrics::get();
+    metrics.set_enabled(true);
+    auto& queries = metrics.counter("spatial queries");
+
+    EntityPicker picker;
+    picker.insert(EntityId{0}, {0.5f, 0.5f}, 1.0f);
+    picker.insert(EntityId{1}, {20.0f, 0.5f}, 1.0f);
+    CHECK(picker.pick({0.5f, 0.5f}) == EntityId{0});
+
+    metrics.end_frame(0.0);
+    // Moving away, within the cell, into the cell, and updating entities that aren't in the picker.
+    picker.update(EntityId{0}, {10.0f, 0.5f});
+    CHECK(!picker.pick({0.5f, 0.5f}).is_valid());
+    picker.update(EntityId{1}, {1.0f, 1.0f});
+    CHECK(picker.pick({1.2f, 1.2f}) == EntityId{1});
+    picker.update(EntityId{1}, {3.5f, 3.5f});
+    CHECK(picker.pick({3.0f, 3.0f}) == EntityId{1});
+    picker.update(EntityId{7}, {0.5f, 0.5f});
+    CHECK(!picker.contains(EntityId{7}));
+    metrics.end_frame(0.0);
+    CHECK(queries.last_frame() == 0);
+
+    picker.remove(EntityId{1});
+    CHECK(!picker.contains(EntityId{1}));
+    picker.update(EntityId{1}, {0.5f, 0.5f});
+    CHECK(!picker.pick({0.5f, 0.5f}).is_valid());
+
+    metrics.set_enabled(false);
+  }
+}
+
+}  // namespace ad
@@ -0,0 +1,81 @@
+#include <catch2/catch.hpp>
+
+#include "ad/world/fixed_timestep.h"
+
+namespace ad {
+
+TEST_CASE("FixedTimestep") {
+  SECTION("runs a tick for every full tick delta") {
+    FixedTimestep timestep{10.0f};
+
+    CHECK(timestep.advance(5.0f) == 0);
+    CHECK(timestep.alpha() == Approx(0.5f));
+
+    CHECK(timestep.advance(10.0f) == 1);
+    CHECK(timestep.alpha() == Approx(0.5f));
+
+    CHECK(timestep.advance(25.0f) == 3);
+    CHECK(timestep.alpha() == Approx(0.0f));
+  }
+
+  SECTION("tick count does not depend on the frame rate") {
+    FixedTimestep fast{10.0f};
+    FixedTimestep slow{10.0f};
+
+    U32 fast_ticks = 0;
+    for (int i = 0; i < 240; ++i) {
+      fast_ticks += fast.advance(1000.0f / 240.0f);
+    }
+
+    U32 slow_ticks = 0;
+    for (int i = 0; i < 30; ++i) {
+      slow_ticks += slow.advance(1000.0f / 30.0f);
+    }
+
+    CHECK(fast_ticks == Approx(100).margin(1));
+    CHECK(slow_ticks == Approx(100).margin(1));
+  }
+
+  SECTION("caps the ticks after a stall") {
+    FixedTimestep timestep{10.0f, 4};
+
+    CHECK(timestep.advance(1000.0f) == 4);
+    CHECK(timestep.dropped_time() == Approx(960.0f));
+    CHECK(timestep.alpha() < 1.0f);
+
+    // Caught up again.
+    CHECK(timestep.advance(10.0f) == 1);
+  }
+
+  SECTION("a new tick delta keeps the carried time") {
+    FixedTimestep timestep{10.0f};
+    CHECK(timestep.advance(9.0f) == 0);
+
+    // The 9 carried units are two ticks of 4.5.
+    timestep.set_tick_delta(4.5f);
+    CHECK(timestep.alpha() == 1.0f);
+    CHECK(timestep.advance(0.0f) == 2);
+    CHECK(timestep.alpha() == Approx(0.0f));
+
+    timestep.set_tick_delta(4.0f);
+    CHECK(timestep.advance(3.0f) == 0);
+    timestep.set_tick_delta(2.0f);
+    CHECK(timestep.advance(2.0f) == 2);
+    CHECK(timestep.alpha() == Approx(0.5f));
+
+    // Longer ticks take the carried time as part of the next one.
+    timestep.set_tick_delta(8.0f);
+    CHECK(timestep.alpha() == Approx(0.125f));
+    CHECK(timestep.advance(7.0f) == 1);
+    CHECK(timestep.alpha() == Approx(0.0f));
+    CHECK(timestep.dropped_time() == 0.0f);
+  }
+
+  SECTION("ignores negative frame times") {
+    FixedTimestep timestep{10.0f};
+    CHECK(timestep.advance(-5.0f) == 0);
+    CHECK(timestep.alpha() == 0.0f);
+  }
+}
+
+}  // namespace ad
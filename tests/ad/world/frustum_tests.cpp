@@ -0,0 +1,168 @@
+#include <catch2/catch.hpp>
+
+#include <cmath>
+
+#include "ad/world/frustum.h"
+#include "ad/world/world.h"
+
+namespace ad {
+
+namespace {
+
+// Camera at `eye`, looking down the negative z axis.
+fl::Mat4 view_from(const fl::Vec3& eye) {
+  return fl::translation_matrix({-eye.x, -eye.y, -eye.z});
+}
+
+fl::Mat4 perspective(F32 field_of_view_radians, F32 aspect_ratio, F32 near, F32 far) {
+  auto f = 1.0f / std::tan(field_of_view_radians * 0.5f);
+  auto result = fl::Mat4::identity;
+  result.col[0] = {f / aspect_ratio, 0.0f, 0.0f, 0.0f};
+  result.col[1] = {0.0f, f, 0.0f, 0.0f};
+  result.col[2] = {0.0f, 0.0f, (far + near) / (near - far), -1.0f};
+  result.col[3] = {0.0f, 0.0f, 2.0f * far * near / (near - far), 0.0f};
+  return result;
+}
+
+fl::Mat4 orthographic(F32 half_width, F32 half_height, F32 near, F32 far) {
+  auto result = fl::Mat4::identity;
+  result.col[0] = {1.0f / half_width, 0.0f, 0.0f, 0.0f};
+  result.col[1] = {0.0f, 1.0f / half_height, 0.0f, 0.0f};
+  result.col[2] = {0.0f, 0.0f, -2.0f / (far - near), 0.0f};
+  result.col[3] = {0.0f, 0.0f, -(far + near) / (far - near), 1.0f};
+  return result;
+}
+
+constexpr F32 kRightAngle = 1.5707963f;
+
+}  // namespace
+
+TEST_CASE("Frustum") {
+  SECTION("perspective camera looking down at the ground") {
+    // 90 degrees from 10 units up sees 10 units either way on the ground.
+    Frustum frustum{perspective(kRightAngle, 1.0f, 0.1f, 100.0f) * view_from({0.0f, 0.0f, 10.0f})};
+
+    CHECK(frustum.intersects_sphere({0.0f, 0.0f, 0.0f}, 0.0f));
+    CHECK(frustum.intersects_sphere({9.5f, -9.5f, 0.0f}, 0.0f));
+    CHECK_FALSE(frustum.intersects_sphere({10.5f, 0.0f, 0.0f}, 0.0f));
+    CHECK(frustum.intersects_sphere({10.5f, 0.0f, 0.0f}, 1.0f));
+    // Behind the camera and past the far plane.
+    CHECK_FALSE(frustum.intersects_sphere({0.0f, 0.0f, 20.0f}, 1.0f));
+    CHECK_FALSE(frustum.intersects_sphere({0.0f, 0.0f, -200.0f}, 1.0f));
+
+    CHECK(frustum.intersects_box({5.0f, 5.0f, -1.0f}, {50.0f, 50.0f, 1.0f}));
+    CHECK_FALSE(frustum.intersects_box({11.0f, -50.0f, -1.0f}, {50.0f, 50.0f, 1.0f}));
+
+    fl::Vec2 min;
+    fl::Vec2 max;
+    REQUIRE(frustum.ground_bounds(0.0f, &min, &max));
+    CHECK(min.x == Approx(-10.0f));
+    CHECK(min.y == Approx(-10.0f));
+    CHECK(max.x == Approx(10.0f));
+    CHECK(max.y == Approx(10.0f));
+
+    // A thicker slab reaches further out, down to 9 units below the camera.
+    REQUIRE(frustum.ground_bounds(1.0f, &min, &max));
+    CHECK(max.x == Approx(11.0f));
+  }
+
+  SECTION("orthographic camera") {
+    Frustum frustum{orthographic(20.0f, 10.0f, 0.1f, 100.0f) * view_from({100.0f, 0.0f, 10.0f})};
+
+    CHECK(frustum.intersects_sphere({119.0f, 9.0f, 0.0f}, 0.0f));
+    CHECK_FALSE(frustum.intersects_sphere({121.0f, 0.0f, 0.0f}, 0.5f));
+    CHECK_FALSE(frustum.intersects_sphere({0.0f, 0.0f, 0.0f}, 5.0f));
+
+    fl::Vec2 min;
+    fl::Vec2 max;
+    REQUIRE(frustum.ground_bounds(1.0f, &min, &max));
+    CHECK(min.x == Approx(80.0f));
+    CHECK(max.x == Approx(120.0f));
+    CHECK(min.y == Approx(-10.0f));
+    CHECK(max.y == Approx(10.0f));
+  }
+
+  SECTION("a camera that can't see the ground") {
+    // The far plane is 100 units away, and the ground 200.
+    Frustum frustum{perspective(kRightAngle, 1.0f, 0.1f, 100.0f) * view_from({0.0f, 0.0f, 200.0f})};
+
+    fl::Vec2 min;
+    fl::Vec2 max;
+    CHECK_FALSE(frustum.ground_bounds(1.0f, &min, &max));
+  }
+}
+
+TEST_CASE("World culling") {
+  World world;
+
+  // One building every 10 units from -100 to 100 both ways.
+  Entity building;
+  building.building.selection_radius = 1.0f;
+  for (I32 y = -100; y <= 100; y += 10) {
+    for (I32 x = -100; x <= 100; x += 10) {
+      world.add_entity_from_prefab(&building, {static_cast<F32>(x), static_cast<F32>(y)});
+    }
+  }
+
+  auto visible_positions = [&](const fl::Mat4& projection_and_view) {
+    nu::DynamicArray<EntityId> visible;
+    world.find_visible_entities(projection_and_view, &visible);
+
+    // Every entity in view is found, even though only some of the grid is visited.
+    Frustum frustum{projection_and_view};
+    MemSize expected = 0;
+    for (auto entity : world.entities()) {
+      if (frustum.intersects_sphere({entity.position(), 0.0f}, 1.0f)) {
+        ++expected;
+      }
+    }
+    CHECK(visible.size() == expected);
+
+    nu::DynamicArray<fl::Vec2> positions;
+    for (auto entity_id : visible) {
+      positions.emplaceBack(world.entities().get(entity_id).position());
+    }
+    return positions;
+  };
+
+  auto perspective_from = [](const fl::Vec3& eye) {
+    return perspective(kRightAngle, 1.0f, 0.1f, 100.0f) * view_from(eye);
+  };
+
+  SECTION("camera over the middle") {
+    // Sees from -10 to 10, and the buildings on the edges reach into view.
+    auto positions = visible_positions(perspective_from({0.0f, 0.0f, 10.0f}));
+    CHECK(positions.size() == 9);
+    for (const auto& position : positions) {
+      CHECK(std::abs(position.x) <= 10.0f);
+      CHECK(std::abs(position.y) <= 10.0f);
+    }
+  }
+
+  SECTION("camera over a corner") {
+    auto positions = visible_positions(perspective_from({90.0f, 90.0f, 10.0f}));
+    CHECK(positions.size() == 9);
+    for (const auto& position : positions) {
+      CHECK(position.x >= 80.0f);
+      CHECK(position.y >= 80.0f);
+    }
+  }
+
+  SECTION("camera further up") {
+    auto positions = visible_positions(perspective_from({0.0f, 0.0f, 30.0f}));
+    CHECK(positions.size() == 49);
+  }
+
+  SECTION("orthographic camera") {
+    auto positions = visible_positions(orthographic(25.0f, 5.0f, 0.1f, 100.0f) *
+                                       view_from({0.0f, 0.0f, 10.0f}));
+    CHECK(positions.size() == 5);
+  }
+
+  SECTION("camera away from the field") {
+    CHECK(visible_positions(perspective_from({500.0f, 0.0f, 10.0f})).isEmpty());
+    CHECK(visible_positions(perspective_from({0.0f, 0.0f, 500.0f})).isEmpty());
+  }
+}
+
+}  // namespace ad
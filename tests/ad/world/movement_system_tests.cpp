@@ -0,0 +1,179 @@
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <random>
+
+#include "ad/world/Systems/movement_kernel.h"
+#include "ad/world/Systems/movement_system.h"
+
+namespace ad {
+
+namespace {
+
+struct MovementLanes {
+  nu::DynamicArray<fl::Vec2> positions;
+  nu::DynamicArray<fl::Vec2> unit_directions;
+  nu::DynamicArray<F32> speeds;
+  nu::DynamicArray<F32> distances_travelled;
+  nu::DynamicArray<fl::Angle> directions;
+
+  MovementLanes(MemSize count, U32 seed) {
+    std::mt19937 rng{seed};
+    std::uniform_real_distribution<F32> coordinate{-100.0f, 100.0f};
+    std::uniform_real_distribution<F32> speed{0.0f, 50.0f};
+
+    for (MemSize i = 0; i < count; ++i) {
+      auto direction = fl::degrees(static_cast<F32>(rng() % 360));
+      positions.emplaceBack(fl::Vec2{coordinate(rng), coordinate(rng)});
+      directions.emplaceBack(direction);
+      unit_directions.emplaceBack(fl::Vec2{fl::cosine(direction), fl::sine(direction)});
+      speeds.emplaceBack(speed(rng));
+      distances_travelled.emplaceBack(0.0f);
+    }
+  }
+};
+
+// The per-entity loop `MovementSystem` used before the kernel, for comparison.
+void integrate_movement_reference(Entity* entities, MemSize count, F32 delta) {
+  for (MemSize i = 0; i < count; ++i) {
+    auto& entity = entities[i];
+    if (entity.movement.speed > 0.0f) {
+      fl::Vec2 d{fl::cosine(entity.movement.direction), fl::sine(entity.movement.direction)};
+      F32 distance = entity.movement.speed * 0.01f * delta;
+      entity.position += d * distance;
+
+      entity.movement.distance_travelled += distance;
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("MovementSystem") {
+  SECTION("kernel matches scalar") {
+    for (MemSize count : {0, 1, 3, 4, 7, 8, 9, 31, 1000}) {
+      MovementLanes simd{count, 7};
+      MovementLanes scalar{count, 7};
+
+      for (U32 tick = 0; tick < 10; ++tick) {
+        integrate_movement(simd.positions.data(), simd.unit_directions.data(),
+                           simd.speeds.data(), simd.distances_travelled.data(), count, 16.0f);
+        integrate_movement_scalar(scalar.positions.data(), scalar.unit_directions.data(),
+                                  scalar.speeds.data(), scalar.distances_travelled.data(), count,
+                                  16.0f);
+      }
+
+      for (MemSize i = 0; i < count; ++i) {
+        CHECK(simd.positions[i].x == Approx(scalar.positions[i].x));
+        CHECK(simd.positions[i].y == Approx(scalar.positions[i].y));
+        CHECK(simd.distances_travelled[i] == Approx(scalar.distances_travelled[i]));
+      }
+    }
+  }
+
+  SECTION("kernel matches per-entity loop") {
+    MovementLanes lanes{100, 3};
+
+    nu::DynamicArray<Entity> entities;
+    for (MemSize i = 0; i < lanes.positions.size(); ++i) {
+      auto& entity = entities.emplaceBack().element();
+      entity.position = lanes.positions[i];
+      entity.movement.direction = lanes.directions[i];
+      entity.movement.speed = lanes.speeds[i];
+    }
+
+    integrate_movement(lanes.positions.data(), lanes.unit_directions.data(), lanes.speeds.data(),
+                       lanes.distances_travelled.data(), lanes.positions.size(), 16.0f);
+    integrate_movement_reference(entities.data(), entities.size(), 16.0f);
+
+    for (MemSize i = 0; i < entities.size(); ++i) {
+      CHECK(lanes.positions[i].x == Approx(entities[i].position.x));
+      CHECK(lanes.positions[i].y == Approx(entities[i].position.y));
+      CHECK(lanes.distances_travelled[i] == Approx(entities[i].movement.distance_travelled));
+    }
+  }
+
+  SECTION("reheading updates the cached direction") {
+    EntityList entities;
+    SpatialGrid spatial_grid;
+    EntityPicker entity_picker;
+
+    Entity fighter;
+    fighter.movement.speed = 100.0f;
+    auto fighter_id = entities.add(fighter);
+    spatial_grid.insert(fighter_id, fl::Vec2::zero, 0);
+
+    Random random;
+    SystemContext context;
+    context.entities = &entities;
+    context.spatial_grid = &spatial_grid;
+    context.entity_picker = &entity_picker;
+    context.random = &random;
+    // 6 units in one tick, which is past the 5 unit reheading distance.
+    context.delta = 6.0f;
+    nu::DynamicArray<EntityId> due_reheadings;
+    due_reheadings.emplaceBack(fighter_id);
+    context.due_reheadings = &due_reheadings;
+
+    MovementSystem movement_system;
+    movement_system.tick(context);
+
+    entities.for_each_archetype(COMPONENT_MOVEMENT, [](Archetype& archetype) {
+      CHECK(archetype.distances_travelled[0] == 0.0f);
+      CHECK(archetype.unit_directions[0].x == fl::cosine(archetype.directions[0]));
+      CHECK(archetype.unit_directions[0].y == fl::sine(archetype.directions[0]));
+    });
+
+    CHECK(entities.get(fighter_id).position().x == Approx(6.0f));
+    CHECK(spatial_grid.closest({6.0f, 0.0f}, 0) == fighter_id);
+
+    // The state from before the tick is kept for interpolation.
+    entities.for_each_archetype(COMPONENT_MOVEMENT, [](Archetype& archetype) {
+      CHECK(archetype.previous_positions[0].x == 0.0f);
+      CHECK(archetype.previous_directions[0] == fl::Angle::zero);
+    });
+  }
+}
+
+TEST_CASE("MovementSystem benchmark", "[.benchmark]") {
+  for (MemSize count : {10'000, 100'000, 1'000'000}) {
+    constexpr U32 kTicks = 100;
+
+    MovementLanes lanes{count, 11};
+
+    nu::DynamicArray<Entity> entities;
+    entities.reserve(count);
+    for (MemSize i = 0; i < count; ++i) {
+      auto& entity = entities.emplaceBack().element();
+      entity.position = lanes.positions[i];
+      entity.movement.direction = lanes.directions[i];
+      entity.movement.speed = lanes.speeds[i];
+    }
+
+    auto time = [](auto&& func) {
+      auto start = std::chrono::steady_clock::now();
+      for (U32 tick = 0; tick < kTicks; ++tick) {
+        func();
+      }
+      std::chrono::duration<F64, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      return elapsed.count() / kTicks;
+    };
+
+    auto reference_ns = time([&] { integrate_movement_reference(entities.data(), count, 16.0f); });
+    auto scalar_ns = time([&] {
+      integrate_movement_scalar(lanes.positions.data(), lanes.unit_directions.data(),
+                                lanes.speeds.data(), lanes.distances_travelled.data(), count,
+                                16.0f);
+    });
+    auto kernel_ns = time([&] {
+      integrate_movement(lanes.positions.data(), lanes.unit_directions.data(), lanes.speeds.data(),
+                         lanes.distances_travelled.data(), count, 16.0f);
+    });
+
+    LOG(Info) << count << " fighters: per-entity loop " << reference_ns / count
+              << " ns/entity, scalar lanes " << scalar_ns / count << " ns/entity, kernel "
+              << kernel_ns / count << " ns/entity";
+  }
+}
+
+}  // namespace ad
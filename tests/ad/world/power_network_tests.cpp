@@ -0,0 +1,102 @@
+#include <catch2/catch.hpp>
+
+#include "ad/world/power_network.h"
+
+namespace ad {
+
+TEST_CASE("PowerNetwork") {
+  EntityId command_center{0};
+  EntityId hub{1};
+  EntityId miner_1{2};
+  EntityId miner_2{3};
+
+  PowerNetwork network;
+  network.add(command_center, 100);
+  network.add(hub, -1);
+  network.add(miner_1, -5);
+  network.add(miner_2, -5);
+
+  SECTION("unlinked buildings are their own networks") {
+    CHECK(network.is_powered(command_center));
+    CHECK_FALSE(network.is_powered(hub));
+    CHECK_FALSE(network.is_powered(miner_1));
+    CHECK(network.network_id(hub) != network.network_id(miner_1));
+    CHECK(network.total_electricity() == 89);
+  }
+
+  SECTION("links merge networks") {
+    network.link(hub, command_center);
+    network.link(miner_1, hub);
+
+    CHECK(network.network_id(miner_1) == network.network_id(command_center));
+    CHECK(network.is_powered(miner_1));
+    CHECK_FALSE(network.is_powered(miner_2));
+
+    auto stats = network.stats(miner_1);
+    CHECK(stats.supply == 100);
+    CHECK(stats.demand == 6);
+    CHECK(stats.building_count == 3);
+  }
+
+  SECTION("demand above supply is not powered") {
+    network.link(hub, command_center);
+    network.link(miner_1, hub);
+    network.set_electricity_delta(miner_1, -200);
+
+    CHECK_FALSE(network.is_powered(hub));
+    CHECK(network.stats(hub).demand == 201);
+    CHECK(network.total_electricity() == -106);
+
+    network.set_electricity_delta(miner_1, -5);
+    CHECK(network.is_powered(hub));
+  }
+
+  SECTION("removing a building splits its network") {
+    network.link(hub, command_center);
+    network.link(miner_1, hub);
+    network.link(miner_2, hub);
+
+    network.remove(hub);
+
+    CHECK_FALSE(network.contains(hub));
+    CHECK_FALSE(network.is_powered(miner_1));
+    CHECK_FALSE(network.is_powered(miner_2));
+    CHECK(network.network_id(miner_1) != network.network_id(miner_2));
+    CHECK(network.stats(command_center).building_count == 1);
+    CHECK(network.total_electricity() == 90);
+  }
+
+  SECTION("removing a leaf keeps the rest connected") {
+    network.link(hub, command_center);
+    network.link(miner_1, hub);
+    network.link(miner_2, hub);
+
+    network.remove(miner_1);
+
+    CHECK(network.is_powered(miner_2));
+    CHECK(network.stats(command_center).building_count == 3);
+    CHECK(network.stats(command_center).demand == 6);
+  }
+
+  SECTION("relinking moves a building to another network") {
+    EntityId other_center{4};
+    network.add(other_center, 50);
+
+    network.link(miner_1, command_center);
+    network.link(miner_1, other_center);
+
+    CHECK(network.network_id(miner_1) == network.network_id(other_center));
+    CHECK(network.network_id(miner_1) != network.network_id(command_center));
+    CHECK(network.stats(command_center).building_count == 1);
+  }
+
+  SECTION("stale handles are not in the network") {
+    network.remove(miner_1);
+    network.add(EntityId{2, 1}, -5);
+
+    CHECK_FALSE(network.contains(miner_1));
+    CHECK(network.contains(EntityId{2, 1}));
+  }
+}
+
+}  // namespace ad
@@ -1,6 +1,12 @@
 #include <catch2/catch.hpp>
 
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "ad/world/construction_controller.h"
 #include "ad/world/prefabs.h"
+#include "ad/world/world.h"
 
 TEST_CASE("Prefabs") {
   SECTION("basic") {
@@ -18,4 +24,96 @@ TEST_CASE("Prefabs") {
     CHECK(new_prefab->building.selection_radius == 10.0f);
     CHECK(new_prefab->render.model->root_node().children().size() == 1);
   }
+
+  SECTION("models are loaded when the prefab is first used") {
+    auto directory = std::filesystem::temp_directory_path() / "ad_prefabs_tests";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    for (auto name : {"miner.obj", "turret.obj"}) {
+      std::ofstream out{directory / name};
+      out << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+    }
+    ad::MeshCache mesh_cache{directory, directory / "cache"};
+
+    le::RenderModel models[2];
+    std::string loads;
+    ad::World world;
+    Prefabs prefabs{nullptr};
+    ad::ModelResidency residency{
+        0, &mesh_cache,
+        [&](std::string_view name, const ad::MappedMesh&, MemSize* bytes) -> le::RenderModel* {
+          loads += name;
+          *bytes = 100;
+          return &models[name == "turret.obj" ? 1 : 0];
+        },
+        [&](std::string_view, le::RenderModel* model) { prefabs.forget_model(model); },
+        [&](le::RenderModel* model) { return world.model_use_count(model) > 0; }};
+
+    prefabs.set_model_residency(&residency);
+    prefabs.set(EntityType::Miner, [](le::ResourceManager*, Entity*) { return true; });
+    prefabs.set(EntityType::Turret, [](le::ResourceManager*, Entity*) { return true; });
+    prefabs.set_model(EntityType::Miner, "miner.obj");
+    prefabs.set_model(EntityType::Turret, "turret.obj");
+    CHECK(prefabs.contains(EntityType::Turret));
+    CHECK(loads.empty());
+
+    ad::ConstructionController construction_controller{&world, &prefabs};
+    construction_controller.prefetch(EntityType::Miner);
+    CHECK(loads.empty());
+    residency.upload_prefetched();
+    CHECK(loads == "miner.obj");
+    construction_controller.start_building(EntityType::Miner);
+    REQUIRE(construction_controller.prefab() != nullptr);
+    CHECK(construction_controller.prefab()->render.model == &models[0]);
+    construction_controller.build();
+    CHECK(loads == "miner.obj");
+
+    // With no budget at all, the miner's model is still kept while a miner exists.
+    auto* turret = prefabs.get(EntityType::Turret);
+    CHECK(turret->render.model == &models[1]);
+    CHECK(residency.resident_count() == 2);
+    world.clear();
+    residency.trim();
+    CHECK(residency.resident_count() == 0);
+
+    // Unloaded models are not left behind in the prefabs.
+    CHECK(turret->render.model == nullptr);
+    CHECK(prefabs.get(EntityType::Miner)->render.model == &models[0]);
+    CHECK(loads == "miner.objturret.objminer.obj");
+
+    // Once the residency is gone, its models are too.
+    auto* miner = prefabs.get(EntityType::Miner);
+    prefabs.set_model_residency(nullptr);
+    CHECK(miner->render.model == nullptr);
+    CHECK(prefabs.get(EntityType::Miner) == nullptr);
+
+    std::filesystem::remove_all(directory);
+  }
+
+  SECTION("prefabs whose model fails to load are not handed out") {
+    auto directory = std::filesystem::temp_directory_path() / "ad_prefabs_tests";
+    std::filesystem::remove_all(directory);
+    ad::MeshCache mesh_cache{directory, directory / "cache"};
+
+    ad::World world;
+    ad::ModelResidency residency{
+        0, &mesh_cache,
+        [](std::string_view, const ad::MappedMesh&, MemSize*) -> le::RenderModel* {
+          return nullptr;
+        },
+        [](std::string_view, le::RenderModel*) {}, [](le::RenderModel*) { return false; }};
+
+    Prefabs prefabs{nullptr};
+    prefabs.set_model_residency(&residency);
+    prefabs.set(EntityType::Miner, [](le::ResourceManager*, Entity*) { return true; });
+    prefabs.set_model(EntityType::Miner, "missing.obj");
+    CHECK(prefabs.contains(EntityType::Miner));
+    CHECK(prefabs.get(EntityType::Miner) == nullptr);
+
+    ad::ConstructionController construction_controller{&world, &prefabs};
+    construction_controller.start_building(EntityType::Miner);
+    CHECK_FALSE(construction_controller.is_building());
+    construction_controller.build();
+    CHECK(world.entities().size() == 0);
+  }
 }
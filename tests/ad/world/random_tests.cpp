@@ -0,0 +1,136 @@
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "ad/world/generator.hpp"
+#include "ad/world/random.h"
+
+namespace ad {
+
+namespace {
+
+void setup_prefabs(Prefabs* prefabs) {
+  prefabs->set(EntityType::CommandCenter, [](le::ResourceManager*, Entity* storage) {
+    storage->flags = ENTITY_FLAG_LINKABLE;
+    storage->electricity.electricity_delta = 100;
+    return true;
+  });
+  prefabs->set(EntityType::Miner, [](le::ResourceManager*, Entity* storage) {
+    storage->flags = ENTITY_FLAG_NEEDS_LINK;
+    storage->mining.cycle_duration = 100.0f;
+    return true;
+  });
+  prefabs->set(EntityType::Asteroid, [](le::ResourceManager*, Entity* storage) {
+    storage->flags = ENTITY_FLAG_MINABLE;
+    return true;
+  });
+  prefabs->set(EntityType::EnemyFighter, [](le::ResourceManager*, Entity* storage) {
+    storage->movement.speed = 50.0f;
+    return true;
+  });
+}
+
+// Populates a world, adds some fighters and runs it for a while.
+nu::DynamicArray<fl::Vec2> simulate(U64 seed) {
+  Prefabs prefabs{nullptr};
+  setup_prefabs(&prefabs);
+
+  World world;
+  world.set_seed(seed);
+  populate_world(&world, &prefabs);
+
+  auto random = world.random().stream(1);
+  for (U32 i = 0; i < 100; ++i) {
+    world.add_entity_from_prefab(prefabs.get(EntityType::EnemyFighter),
+                                 {random.next_float() * 100.0f, random.next_float() * 100.0f});
+  }
+
+  for (U32 tick = 0; tick < 500; ++tick) {
+    world.tick(16.0f);
+  }
+
+  nu::DynamicArray<fl::Vec2> positions;
+  for (auto entity : world.entities()) {
+    positions.emplaceBack(entity.position());
+  }
+  return positions;
+}
+
+}  // namespace
+
+TEST_CASE("Random") {
+  SECTION("values only depend on seed, stream and counter") {
+    Random a{123};
+    Random b{123};
+    Random c{124};
+
+    CHECK(a.value(5, 10) == b.value(5, 10));
+    CHECK(a.value(5, 10) != c.value(5, 10));
+    CHECK(a.value(5, 10) != a.value(6, 10));
+    CHECK(a.value(5, 10) != a.value(5, 11));
+
+    // Order of evaluation does not matter.
+    auto later = a.value(7, 1000);
+    auto earlier = a.value(7, 0);
+    CHECK(later == b.value(7, 1000));
+    CHECK(earlier == b.value(7, 0));
+  }
+
+  SECTION("ranges") {
+    Random random;
+    auto stream = random.stream(3);
+
+    U32 histogram[10] = {};
+    for (U32 i = 0; i < 100'000; ++i) {
+      auto value = stream.next_int(10);
+      REQUIRE(value < 10);
+      ++histogram[value];
+
+      auto f = stream.next_float();
+      REQUIRE(f >= 0.0f);
+      REQUIRE(f < 1.0f);
+    }
+
+    for (auto count : histogram) {
+      CHECK(count > 9'000);
+      CHECK(count < 11'000);
+    }
+  }
+
+  SECTION("same seed gives bit-identical worlds") {
+    auto first = simulate(42);
+    auto second = simulate(42);
+    auto other = simulate(43);
+
+    REQUIRE(first.size() == second.size());
+    CHECK(std::memcmp(first.data(), second.data(), first.size() * sizeof(fl::Vec2)) == 0);
+
+    REQUIRE(first.size() == other.size());
+    CHECK(std::memcmp(first.data(), other.data(), first.size() * sizeof(fl::Vec2)) != 0);
+  }
+}
+
+TEST_CASE("Random benchmark", "[.benchmark]") {
+  constexpr U32 kCount = 10'000'000;
+
+  auto time = [](auto&& func) {
+    auto start = std::chrono::steady_clock::now();
+    U64 sum = 0;
+    for (U32 i = 0; i < kCount; ++i) {
+      sum += func(i);
+    }
+    std::chrono::duration<F64, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(sum != 0);
+    return elapsed.count() / kCount;
+  };
+
+  Random random;
+  auto rand_ns = time([](U32) { return static_cast<U64>(std::rand() % 360); });
+  auto random_ns = time([&](U32 i) { return random.uniform_int(i & 1023, i, 360); });
+
+  LOG(Info) << "std::rand: " << rand_ns << " ns/value, Random: " << random_ns << " ns/value";
+}
+
+}  // namespace ad
@@ -0,0 +1,108 @@
+#include <catch2/catch.hpp>
+
+#include <random>
+
+#include "ad/world/entity_list.hpp"
+#include "ad/world/spatial_grid.h"
+
+namespace ad {
+
+namespace {
+
+constexpr EntityFlags kFlags[] = {
+    0,
+    ENTITY_FLAG_LINKABLE,
+    ENTITY_FLAG_MINABLE,
+    ENTITY_FLAG_NEEDS_LINK | ENTITY_FLAG_LINKABLE,
+    ENTITY_FLAG_ENEMY,
+};
+
+F32 distance_to(EntityList& entities, EntityId entity_id, const fl::Vec2& position) {
+  return entity_id.is_valid() ? fl::distance(position, entities.get(entity_id).position()) : -1.0f;
+}
+
+}  // namespace
+
+TEST_CASE("SpatialGrid") {
+  SECTION("empty") {
+    SpatialGrid grid;
+
+    CHECK(!grid.closest(fl::Vec2::zero, 0).is_valid());
+    CHECK(!grid.closest_within_radius(fl::Vec2::zero, 10.0f, ENTITY_FLAG_MINABLE).is_valid());
+  }
+
+  SECTION("matches brute force on randomized worlds") {
+    for (U32 seed = 1; seed <= 8; ++seed) {
+      std::mt19937 rng{seed};
+
+      auto entity_count = std::uniform_int_distribution<U32>{1, 2000}(rng);
+      auto extent = std::uniform_real_distribution<F32>{5.0f, 500.0f}(rng);
+      std::uniform_real_distribution<F32> coordinate{-extent, extent};
+      std::uniform_int_distribution<U32> flags_index{0, std::size(kFlags) - 1};
+
+      EntityList entities;
+      SpatialGrid grid{std::uniform_real_distribution<F32>{1.0f, 20.0f}(rng)};
+
+      for (U32 i = 0; i < entity_count; ++i) {
+        Entity prefab;
+        prefab.position = {coordinate(rng), coordinate(rng)};
+        prefab.flags = kFlags[flags_index(rng)];
+
+        auto entity_id = entities.add(prefab);
+        grid.insert(entity_id, prefab.position, prefab.flags);
+      }
+
+      // Move some of the entities around, like the movement system does.
+      for (U32 i = 0; i < entity_count / 4; ++i) {
+        auto entity = entities.get(EntityId{static_cast<U32>(rng() % entity_count)});
+        entity.position() = {coordinate(rng), coordinate(rng)};
+        grid.update(entity.id(), entity.position());
+      }
+
+      for (U32 query = 0; query < 200; ++query) {
+        fl::Vec2 position{coordinate(rng) * 1.5f, coordinate(rng) * 1.5f};
+        auto mask = kFlags[flags_index(rng)];
+        auto excluding = EntityId{static_cast<U32>(rng() % entity_count)};
+        auto radius = std::uniform_real_distribution<F32>{0.0f, extent}(rng);
+
+        auto expected = closest(entities | excluding_id(excluding) | matching_mask(mask), position);
+        auto actual = grid.closest(position, mask, excluding);
+        CHECK(distance_to(entities, actual, position) ==
+              distance_to(entities, expected, position));
+
+        auto expected_within = closest(entities | excluding_id(excluding) | matching_mask(mask) |
+                                           within_radius(position, radius),
+                                       position);
+        auto actual_within = grid.closest_within_radius(position, radius, mask, excluding);
+        CHECK(distance_to(entities, actual_within, position) ==
+              distance_to(entities, expected_within, position));
+
+        MemSize expected_count = 0;
+        for (auto&& entity : entities | matching_mask(mask) | within_radius(position, radius)) {
+          (void)entity;
+          ++expected_count;
+        }
+        MemSize actual_count = 0;
+        grid.for_each_within_radius(position, radius, mask,
+                                    [&](EntityId, const fl::Vec2&) { ++actual_count; });
+        CHECK(actual_count == expected_count);
+      }
+    }
+  }
+
+  SECTION("removed entities are not found") {
+    SpatialGrid grid;
+
+    grid.insert(EntityId{0}, {1.0f, 1.0f}, ENTITY_FLAG_MINABLE);
+    grid.insert(EntityId{1}, {50.0f, 50.0f}, ENTITY_FLAG_MINABLE);
+
+    CHECK(grid.closest(fl::Vec2::zero, ENTITY_FLAG_MINABLE) == EntityId{0});
+
+    grid.remove(EntityId{0});
+
+    CHECK(grid.closest(fl::Vec2::zero, ENTITY_FLAG_MINABLE) == EntityId{1});
+    CHECK(!grid.closest_within_radius(fl::Vec2::zero, 10.0f, ENTITY_FLAG_MINABLE).is_valid());
+  }
+}
+
+}  // namespace ad
@@ -0,0 +1,154 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "ad/jobs/job_system.h"
+#include "ad/world/system_scheduler.h"
+
+namespace ad {
+
+namespace {
+
+class TestSystem : public System {
+public:
+  using TickFunc = std::function<void()>;
+
+  TestSystem(const char* name, SystemAccess access, TickFunc tick_func)
+    : name_{name}, access_{access}, tick_func_{std::move(tick_func)} {}
+
+  const char* name() const override {
+    return name_;
+  }
+
+  SystemAccess access() const override {
+    return access_;
+  }
+
+  void tick(const SystemContext&) override {
+    tick_func_();
+  }
+
+private:
+  const char* name_;
+  SystemAccess access_;
+  TickFunc tick_func_;
+};
+
+}  // namespace
+
+TEST_CASE("SystemAccess") {
+  SystemAccess reads_positions{ACCESS_POSITIONS, 0};
+  SystemAccess writes_positions{0, ACCESS_POSITIONS};
+  SystemAccess writes_resources{ACCESS_ELECTRICITY, ACCESS_RESOURCES};
+
+  CHECK_FALSE(reads_positions.conflicts_with(reads_positions));
+  CHECK(reads_positions.conflicts_with(writes_positions));
+  CHECK(writes_positions.conflicts_with(reads_positions));
+  CHECK(writes_positions.conflicts_with(writes_positions));
+  CHECK_FALSE(writes_positions.conflicts_with(writes_resources));
+}
+
+TEST_CASE("SystemScheduler") {
+  SECTION("dependencies follow conflicts in registration order") {
+    SystemScheduler scheduler;
+    scheduler.add<TestSystem>("a", SystemAccess{0, ACCESS_POSITIONS}, [] {});
+    scheduler.add<TestSystem>("b", SystemAccess{ACCESS_ELECTRICITY, ACCESS_RESOURCES}, [] {});
+    scheduler.add<TestSystem>("c", SystemAccess{ACCESS_POSITIONS | ACCESS_RESOURCES, 0}, [] {});
+
+    REQUIRE(scheduler.system_count() == 3);
+    CHECK(scheduler.dependencies(0).isEmpty());
+    CHECK(scheduler.dependencies(1).isEmpty());
+    REQUIRE(scheduler.dependencies(2).size() == 2);
+    CHECK(scheduler.dependencies(2)[0] == 0);
+    CHECK(scheduler.dependencies(2)[1] == 1);
+  }
+
+  SECTION("conflicting systems run in registration order") {
+    JobSystem job_system{3};
+    SystemContext context;
+    context.job_system = &job_system;
+
+    nu::DynamicArray<int> order;
+    SystemScheduler scheduler;
+    for (int i = 0; i < 4; ++i) {
+      scheduler.add<TestSystem>("writer", SystemAccess{0, ACCESS_POSITIONS},
+                                [&order, i] { order.emplaceBack(i); });
+    }
+
+    scheduler.tick(context);
+
+    REQUIRE(order.size() == 4);
+    for (int i = 0; i < 4; ++i) {
+      CHECK(order[i] == i);
+    }
+  }
+
+  SECTION("independent systems run at the same time") {
+    JobSystem job_system{2};
+    SystemContext context;
+    context.job_system = &job_system;
+
+    // Each system waits until the other one started, which only finishes if they overlap.
+    std::atomic<int> started = 0;
+    auto wait_for_both = [&started] {
+      ++started;
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+      while (started.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+      }
+    };
+
+    SystemScheduler scheduler;
+    scheduler.add<TestSystem>("movement", SystemAccess{0, ACCESS_POSITIONS}, wait_for_both);
+    scheduler.add<TestSystem>("electricity", SystemAccess{ACCESS_ELECTRICITY, ACCESS_RESOURCES},
+                              wait_for_both);
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.tick(context);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds{5});
+    CHECK(started.load() == 2);
+  }
+
+  SECTION("critical path covers the longest chain") {
+    auto sleep = [] { std::this_thread::sleep_for(std::chrono::milliseconds{2}); };
+
+    SystemScheduler scheduler;
+    scheduler.add<TestSystem>("a", SystemAccess{0, ACCESS_POSITIONS}, sleep);
+    scheduler.add<TestSystem>("b", SystemAccess{ACCESS_POSITIONS, 0}, sleep);
+    scheduler.add<TestSystem>("c", SystemAccess{0, ACCESS_RESOURCES}, sleep);
+
+    scheduler.tick(SystemContext{});
+
+    // a -> b is the longest chain, c runs next to it.
+    auto chain_ms = scheduler.system_duration_ms(0) + scheduler.system_duration_ms(1);
+    CHECK(scheduler.critical_path_ms() ==
+          Approx(std::max(chain_ms, scheduler.system_duration_ms(2))));
+    CHECK(scheduler.total_work_ms() == Approx(chain_ms + scheduler.system_duration_ms(2)));
+    CHECK(scheduler.critical_path_ms() < scheduler.total_work_ms());
+  }
+
+  SECTION("frame timings add up the ticks of a frame") {
+    auto sleep = [] { std::this_thread::sleep_for(std::chrono::milliseconds{1}); };
+
+    SystemScheduler scheduler;
+    scheduler.add<TestSystem>("a", SystemAccess{0, ACCESS_POSITIONS}, sleep);
+
+    scheduler.begin_frame();
+    scheduler.tick(SystemContext{});
+    auto first_ms = scheduler.system_duration_ms(0);
+    scheduler.tick(SystemContext{});
+
+    auto frame_ms = first_ms + scheduler.system_duration_ms(0);
+    CHECK(scheduler.system_frame_duration_ms(0) == Approx(frame_ms));
+    CHECK(scheduler.frame_critical_path_ms() == Approx(frame_ms));
+
+    scheduler.begin_frame();
+    CHECK(scheduler.system_frame_duration_ms(0) == 0.0);
+    CHECK(scheduler.frame_critical_path_ms() == 0.0);
+  }
+}
+
+}  // namespace ad
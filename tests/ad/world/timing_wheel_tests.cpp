@@ -0,0 +1,128 @@
+#include <catch2/catch.hpp>
+
+#include "ad/world/timing_wheel.h"
+
+namespace ad {
+
+namespace {
+
+// Advances `wheel` one tick at a time and returns the tick every timer fired on.
+nu::DynamicArray<U64> fire_ticks(TimingWheel* wheel, U64 until) {
+  nu::DynamicArray<U64> result;
+  nu::DynamicArray<TimingWheel::Timer> expired;
+  for (auto tick = wheel->current_tick(); tick <= until; ++tick) {
+    expired.clear();
+    wheel->advance(tick, &expired);
+    for (const auto& timer : expired) {
+      CHECK(timer.due_tick == tick);
+      result.emplaceBack(tick);
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("TimingWheel") {
+  SECTION("timers fire on their due tick across every level") {
+    TimingWheel wheel;
+    for (U64 due : {U64{0}, U64{1}, U64{255}, U64{256}, U64{257}, U64{1000}, U64{65535},
+                    U64{65536}, U64{70000}}) {
+      wheel.schedule(due, EntityId{static_cast<U32>(due), 0}, 0);
+    }
+    CHECK(wheel.size() == 9);
+
+    auto fired = fire_ticks(&wheel, 70000);
+    REQUIRE(fired.size() == 9);
+    CHECK(fired[0] == 0);
+    CHECK(fired[3] == 256);
+    CHECK(fired[6] == 65535);
+    CHECK(fired[8] == 70000);
+    CHECK(wheel.size() == 0);
+  }
+
+  SECTION("advancing over many ticks at once") {
+    TimingWheel wheel;
+    wheel.schedule(300, EntityId{1, 0}, 7);
+    wheel.schedule(20, EntityId{2, 0}, 3);
+
+    nu::DynamicArray<TimingWheel::Timer> expired;
+    wheel.advance(1000, &expired);
+
+    REQUIRE(expired.size() == 2);
+    CHECK(expired[0].entity_id == EntityId{2, 0});
+    CHECK(expired[0].kind == 3);
+    CHECK(expired[1].entity_id == EntityId{1, 0});
+    CHECK(expired[1].due_tick == 300);
+    CHECK(wheel.current_tick() == 1001);
+  }
+
+  SECTION("timers scheduled from a later tick") {
+    TimingWheel wheel;
+    nu::DynamicArray<TimingWheel::Timer> expired;
+    wheel.advance(500, &expired);
+
+    wheel.schedule(501 + 256, EntityId{1, 0}, 0);
+    wheel.schedule(501 + 65536 * 2, EntityId{2, 0}, 0);
+
+    auto fired = fire_ticks(&wheel, 501 + 65536 * 2);
+    REQUIRE(fired.size() == 2);
+    CHECK(fired[0] == 501 + 256);
+    CHECK(fired[1] == 501 + 65536 * 2);
+  }
+
+  SECTION("late timers fire on the next advance") {
+    TimingWheel wheel;
+    nu::DynamicArray<TimingWheel::Timer> expired;
+    wheel.advance(10, &expired);
+
+    wheel.schedule(3, EntityId{1, 0}, 0);
+    wheel.advance(11, &expired);
+
+    REQUIRE(expired.size() == 1);
+    CHECK(expired[0].due_tick == 3);
+  }
+
+  SECTION("cancel") {
+    TimingWheel wheel;
+    auto kept = wheel.schedule(400, EntityId{1, 0}, 0);
+    auto cancelled = wheel.schedule(400, EntityId{2, 0}, 0);
+
+    CHECK(wheel.is_scheduled(cancelled));
+    CHECK(wheel.due_tick(cancelled) == 400);
+    CHECK(wheel.cancel(cancelled));
+    CHECK_FALSE(wheel.cancel(cancelled));
+    CHECK_FALSE(wheel.is_scheduled(cancelled));
+    CHECK(wheel.size() == 1);
+
+    nu::DynamicArray<TimingWheel::Timer> expired;
+    wheel.advance(400, &expired);
+    REQUIRE(expired.size() == 1);
+    CHECK(expired[0].entity_id == EntityId{1, 0});
+
+    // Fired timers can't be cancelled, and their handles stay stale when the node is reused.
+    CHECK_FALSE(wheel.is_scheduled(kept));
+    CHECK_FALSE(wheel.cancel(kept));
+    auto reused = wheel.schedule(500, EntityId{3, 0}, 0);
+    CHECK(reused.index == kept.index);
+    CHECK_FALSE(wheel.is_scheduled(kept));
+    CHECK(wheel.is_scheduled(reused));
+  }
+
+  SECTION("clear") {
+    TimingWheel wheel;
+    auto handle = wheel.schedule(5, EntityId{1, 0}, 0);
+    wheel.schedule(100000, EntityId{2, 0}, 0);
+
+    wheel.clear(50);
+    CHECK(wheel.size() == 0);
+    CHECK(wheel.current_tick() == 50);
+    CHECK_FALSE(wheel.is_scheduled(handle));
+
+    nu::DynamicArray<TimingWheel::Timer> expired;
+    wheel.advance(200000, &expired);
+    CHECK(expired.isEmpty());
+  }
+}
+
+}  // namespace ad
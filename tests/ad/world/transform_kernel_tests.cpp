@@ -0,0 +1,89 @@
+#include <catch2/catch.hpp>
+
+#include <nucleus/containers/dynamic_array.h>
+
+#include <chrono>
+#include <random>
+
+#include "ad/world/transform_kernel.h"
+
+namespace ad {
+
+namespace {
+
+nu::DynamicArray<fl::Mat4> random_transforms(MemSize count, U32 seed) {
+  std::mt19937 rng{seed};
+  std::uniform_real_distribution<F32> element{-10.0f, 10.0f};
+
+  nu::DynamicArray<fl::Mat4> result;
+  for (MemSize i = 0; i < count; ++i) {
+    auto& transform = result.emplaceBack().element();
+    for (auto& column : transform.col) {
+      column = {element(rng), element(rng), element(rng), element(rng)};
+    }
+  }
+  return result;
+}
+
+void check_equal(const fl::Mat4& left, const fl::Mat4& right) {
+  for (U32 column = 0; column < 4; ++column) {
+    CHECK(left.col[column].x == Approx(right.col[column].x).margin(1e-3));
+    CHECK(left.col[column].y == Approx(right.col[column].y).margin(1e-3));
+    CHECK(left.col[column].z == Approx(right.col[column].z).margin(1e-3));
+    CHECK(left.col[column].w == Approx(right.col[column].w).margin(1e-3));
+  }
+}
+
+}  // namespace
+
+TEST_CASE("multiply_transforms") {
+  auto lhs = random_transforms(1, 3)[0];
+
+  for (MemSize count : {0, 1, 2, 5, 64}) {
+    auto rhs = random_transforms(count, 5);
+    nu::DynamicArray<fl::Mat4> kernel;
+    nu::DynamicArray<fl::Mat4> scalar;
+    kernel.resize(count);
+    scalar.resize(count);
+
+    multiply_transforms(lhs, rhs.data(), kernel.data(), count);
+    multiply_transforms_scalar(lhs, rhs.data(), scalar.data(), count);
+
+    for (MemSize i = 0; i < count; ++i) {
+      check_equal(kernel[i], scalar[i]);
+      check_equal(kernel[i], lhs * rhs[i]);
+    }
+  }
+}
+
+TEST_CASE("multiply_transforms benchmark", "[.benchmark]") {
+  constexpr MemSize kCount = 100'000;
+  constexpr U32 kRepeats = 20;
+
+  auto lhs = random_transforms(1, 3)[0];
+  auto rhs = random_transforms(kCount, 5);
+  nu::DynamicArray<fl::Mat4> out;
+  out.resize(kCount);
+
+  auto time = [&](auto&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (U32 repeat = 0; repeat < kRepeats; ++repeat) {
+      func();
+    }
+    std::chrono::duration<F64, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / kRepeats / kCount;
+  };
+
+  auto operator_ns = time([&] {
+    for (MemSize i = 0; i < kCount; ++i) {
+      out[i] = lhs * rhs[i];
+    }
+  });
+  auto scalar_ns = time([&] { multiply_transforms_scalar(lhs, rhs.data(), out.data(), kCount); });
+  auto kernel_ns = time([&] { multiply_transforms(lhs, rhs.data(), out.data(), kCount); });
+
+  LOG(Info) << kCount << " transforms: Mat4 operator " << operator_ns << " ns each, scalar "
+            << scalar_ns << " ns each, kernel " << kernel_ns << " ns each";
+}
+
+}  // namespace ad
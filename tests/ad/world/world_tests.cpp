@@ -41,11 +41,251 @@ TEST_CASE("World") {
     }
 #endif  // 0
 
-    auto minable = matching_mask(world.all(), ENTITY_FLAG_MINABLE);
-    for (auto& e : minable) {
-      LOG(Info) << "minable: " << e.id.id;
+    auto minable = world.entities() | matching_mask(ENTITY_FLAG_MINABLE);
+    for (auto&& e : minable) {
+      LOG(Info) << "minable: " << e.id().index;
     }
   }
+
+  SECTION("destroy_entity") {
+    World world;
+
+    Entity asteroid;
+    asteroid.type = EntityType::Asteroid;
+    asteroid.flags = ENTITY_FLAG_MINABLE;
+
+    Entity miner;
+    miner.type = EntityType::Miner;
+    miner.mining.cycle_duration = 100.0f;
+
+    auto asteroid_id = world.add_entity_from_prefab(&asteroid, {1.0f, 0.0f});
+    auto miner_id = world.add_entity_from_prefab(&miner, fl::Vec2::zero);
+    CHECK(world.entities().get(miner_id).target() == asteroid_id);
+
+    CHECK(world.destroy_entity(asteroid_id));
+    CHECK(!world.is_alive(asteroid_id));
+    CHECK(!world.destroy_entity(asteroid_id));
+
+    // The miner still holds the stale handle, which can be detected.
+    CHECK(!world.is_alive(world.entities().get(miner_id).target()));
+
+    // A new miner does not find the destroyed asteroid.
+    auto other_miner_id = world.add_entity_from_prefab(&miner, fl::Vec2::zero);
+    CHECK(!world.entities().get(other_miner_id).target().is_valid());
+  }
+
+  SECTION("counts the entities drawn with each model") {
+    World world;
+
+    le::RenderModel asteroid_model;
+    le::RenderModel miner_model;
+
+    Entity asteroid;
+    asteroid.type = EntityType::Asteroid;
+    asteroid.render.model = &asteroid_model;
+
+    Entity miner;
+    miner.type = EntityType::Miner;
+    miner.render.model = &miner_model;
+
+    auto first_id = world.add_entity_from_prefab(&asteroid, {1.0f, 0.0f});
+    world.add_entity_from_prefab(&asteroid, {2.0f, 0.0f});
+    world.add_entity_from_prefab(&miner, fl::Vec2::zero);
+    CHECK(world.model_use_count(&asteroid_model) == 2);
+    CHECK(world.model_use_count(&miner_model) == 1);
+
+    world.destroy_entity(first_id);
+    CHECK(world.model_use_count(&asteroid_model) == 1);
+
+    world.clear();
+    CHECK(world.model_use_count(&asteroid_model) == 0);
+    CHECK(world.model_use_count(&miner_model) == 0);
+  }
+
+  SECTION("buildings are powered through their links") {
+    World world;
+
+    Entity command_center;
+    command_center.type = EntityType::CommandCenter;
+    command_center.flags = ENTITY_FLAG_LINKABLE;
+    command_center.electricity.electricity_delta = 100;
+
+    Entity hub;
+    hub.type = EntityType::Hub;
+    hub.flags = ENTITY_FLAG_NEEDS_LINK | ENTITY_FLAG_LINKABLE;
+    hub.electricity.electricity_delta = -1;
+
+    Entity miner;
+    miner.type = EntityType::Miner;
+    miner.flags = ENTITY_FLAG_NEEDS_LINK;
+    miner.electricity.electricity_delta = -5;
+
+    // Nothing to link to yet.
+    auto lonely_miner_id = world.add_entity_from_prefab(&miner, {50.0f, 0.0f});
+    CHECK(!world.is_powered(lonely_miner_id));
+
+    auto command_center_id = world.add_entity_from_prefab(&command_center, fl::Vec2::zero);
+    auto hub_id = world.add_entity_from_prefab(&hub, {10.0f, 0.0f});
+    auto miner_id = world.add_entity_from_prefab(&miner, {20.0f, 0.0f});
+
+    CHECK(world.is_powered(command_center_id));
+    CHECK(world.is_powered(hub_id));
+    CHECK(world.is_powered(miner_id));
+    CHECK(!world.is_powered(lonely_miner_id));
+
+    world.destroy_entity(hub_id);
+    CHECK(!world.is_powered(miner_id));
+    CHECK(world.is_powered(command_center_id));
+  }
+
+  SECTION("electricity follows the command center's network without ticking") {
+    World world;
+
+    Entity command_center;
+    command_center.type = EntityType::CommandCenter;
+    command_center.flags = ENTITY_FLAG_LINKABLE;
+    command_center.electricity.electricity_delta = 100;
+
+    Entity consumer;
+    consumer.flags = ENTITY_FLAG_NEEDS_LINK;
+    consumer.electricity.electricity_delta = -5;
+
+    // Not linked to the command center, so it is not counted.
+    world.add_entity_from_prefab(&consumer, fl::Vec2::zero);
+    CHECK(world.resources()->electricity() == 0);
+
+    auto command_center_id = world.add_entity_from_prefab(&command_center, fl::Vec2::zero);
+    CHECK(world.resources()->electricity() == 100);
+
+    auto consumer_id = world.add_entity_from_prefab(&consumer, fl::Vec2::zero);
+    CHECK(world.resources()->electricity() == 95);
+
+    world.set_electricity_delta(consumer_id, -20);
+    CHECK(world.resources()->electricity() == 80);
+
+    world.destroy_entity(consumer_id);
+    CHECK(world.resources()->electricity() == 100);
+
+    world.tick(16.0f);
+    CHECK(world.resources()->electricity() == 100);
+
+    world.destroy_entity(command_center_id);
+    CHECK(world.resources()->electricity() == 0);
+  }
+
+  SECTION("miners only mine while they are powered") {
+    World world;
+
+    Entity command_center;
+    command_center.type = EntityType::CommandCenter;
+    command_center.flags = ENTITY_FLAG_LINKABLE;
+    command_center.electricity.electricity_delta = 10;
+
+    Entity miner;
+    miner.type = EntityType::Miner;
+    miner.flags = ENTITY_FLAG_NEEDS_LINK;
+    miner.electricity.electricity_delta = -5;
+    miner.mining.cycle_duration = 100.0f;
+    miner.mining.mineral_amount_per_cycle = 3;
+
+    // Nothing to link to.
+    world.add_entity_from_prefab(&miner, fl::Vec2::zero);
+    auto minerals = world.resources()->minerals();
+    for (U32 i = 0; i < 30; ++i) {
+      world.tick(16.0f);
+    }
+    CHECK(world.resources()->minerals() == minerals);
+
+    world.add_entity_from_prefab(&command_center, {10.0f, 0.0f});
+    auto miner_id = world.add_entity_from_prefab(&miner, {20.0f, 0.0f});
+    CHECK(world.is_powered(miner_id));
+
+    // 480 ms is 4.8 cycles of 100 ms, for the linked miner only.
+    minerals = world.resources()->minerals();
+    for (U32 i = 0; i < 30; ++i) {
+      world.tick(16.0f);
+    }
+    CHECK(world.resources()->minerals() == minerals + 12);
+
+    // Using more than the command center produces stops the whole network.
+    world.set_electricity_delta(miner_id, -20);
+    CHECK(!world.is_powered(miner_id));
+    minerals = world.resources()->minerals();
+    for (U32 i = 0; i < 30; ++i) {
+      world.tick(16.0f);
+    }
+    CHECK(world.resources()->minerals() == minerals);
+  }
+
+  SECTION("mining cycles and reheadings fire from their timers") {
+    World world;
+
+    Entity miner;
+    miner.mining.cycle_duration = 100.0f;
+    miner.mining.mineral_amount_per_cycle = 3;
+
+    Entity fighter;
+    fighter.movement.speed = 10.0f;
+
+    auto miner_id = world.add_entity_from_prefab(&miner, fl::Vec2::zero);
+    auto fighter_id = world.add_entity_from_prefab(&fighter, fl::Vec2::zero);
+
+    // 480 ms is 4.8 cycles of 100 ms.
+    auto minerals = world.resources()->minerals();
+    for (U32 i = 0; i < 30; ++i) {
+      world.tick(16.0f);
+    }
+    CHECK(world.resources()->minerals() == minerals + 12);
+
+    // 1.6 units per tick, so the heading changes on every fourth tick, after 6.4 units.
+    auto fighter_entity = world.entities().get(fighter_id);
+    CHECK(fighter_entity.distance_travelled() == Approx(2.0f * 1.6f));
+    CHECK(fighter_entity.direction() != fl::Angle::zero);
+
+    // Destroying the miner cancels its timer.
+    world.destroy_entity(miner_id);
+    minerals = world.resources()->minerals();
+    for (U32 i = 0; i < 30; ++i) {
+      world.tick(16.0f);
+    }
+    CHECK(world.resources()->minerals() == minerals);
+  }
+
+  SECTION("timers follow a change of the tick delta") {
+    World world;
+
+    Entity miner;
+    miner.mining.cycle_duration = 100.0f;
+    miner.mining.mineral_amount_per_cycle = 3;
+
+    Entity fighter;
+    fighter.movement.speed = 10.0f;
+
+    world.add_entity_from_prefab(&miner, fl::Vec2::zero);
+    auto fighter_id = world.add_entity_from_prefab(&fighter, fl::Vec2::zero);
+
+    auto minerals = world.resources()->minerals();
+    for (U32 i = 0; i < 2; ++i) {
+      world.tick(16.0f);
+    }
+
+    // 32 ms and 3.2 units in, the rest of the cycle takes 9 ticks of 8 ms and the rest of the
+    // reheading distance 3 ticks of 0.8 units.
+    for (U32 i = 0; i < 2; ++i) {
+      world.tick(8.0f);
+    }
+    auto fighter_entity = world.entities().get(fighter_id);
+    CHECK(fighter_entity.distance_travelled() == Approx(4.8f));
+    world.tick(8.0f);
+    CHECK(fighter_entity.distance_travelled() == 0.0f);
+
+    for (U32 i = 0; i < 5; ++i) {
+      world.tick(8.0f);
+    }
+    CHECK(world.resources()->minerals() == minerals);
+    world.tick(8.0f);
+    CHECK(world.resources()->minerals() == minerals + 3);
+  }
 }
 
 }  // namespace ad